@@ -118,6 +118,8 @@ const char* oe_result_str(oe_result_t result)
             return "QE_QUOTE_ENCLAVE_IDENTITY_PRODUCTID_MISMATCH";
         case OE_VERIFY_FAILED_AES_CMAC_MISMATCH:
             return "OE_VERIFY_FAILED_AES_CMAC_MISMATCH";
+        case OE_TIMEDOUT:
+            return "OE_TIMEDOUT";
         case __OE_RESULT_MAX:
             break;
     }
@@ -180,6 +182,7 @@ bool oe_is_valid_result(uint32_t result)
         case OE_QUOTE_ENCLAVE_IDENTITY_UNIQUEID_MISMATCH:
         case QE_QUOTE_ENCLAVE_IDENTITY_PRODUCTID_MISMATCH:
         case OE_VERIFY_FAILED_AES_CMAC_MISMATCH:
+        case OE_TIMEDOUT:
         {
             return true;
         }
@@ -2,8 +2,8 @@
 // Licensed under the MIT License.
 
 #include "atexit.h"
+#include <openenclave/allocator.h>
 #include <openenclave/enclave.h>
-#include <openenclave/internal/syscall/unistd.h>
 #include <openenclave/internal/thread.h>
 
 /*
@@ -34,7 +34,9 @@ static oe_spinlock_t _spin = OE_SPINLOCK_INITIALIZER;
 **
 ** _new_atexit_entry()
 **
-**     Allocate an oe_atexit_entry_t structure from the heap using sbrk().
+**     Allocate an oe_atexit_entry_t structure from the allocator. The entry
+**     must not come from oe_sbrk(): a replacement allocator may manage the
+**     whole heap range itself.
 **
 **==============================================================================
 */
@@ -43,8 +45,8 @@ static oe_atexit_entry_t* _new_atexit_entry(void (*func)(void*), void* arg)
 {
     oe_atexit_entry_t* entry;
 
-    if ((entry = (oe_atexit_entry_t*)oe_sbrk(sizeof(oe_atexit_entry_t))) ==
-        (void*)-1)
+    if (!(entry = (oe_atexit_entry_t*)oe_allocator_malloc(
+              sizeof(oe_atexit_entry_t))))
         return NULL;
 
     entry->func = func;
@@ -113,7 +115,8 @@ int oe_atexit(void (*function)(void))
 **
 ** oe_call_atexit_functions()
 **
-**     This function invokes all at-exit functions.
+**     This function invokes all at-exit functions and releases their entries,
+**     before the allocator is cleaned up.
 **
 **==============================================================================
 */
@@ -122,10 +125,20 @@ void oe_call_atexit_functions(void)
 {
     oe_atexit_entry_t* p;
 
+    oe_spin_lock(&_spin);
+    p = _entries;
+    _entries = NULL;
+    oe_spin_unlock(&_spin);
+
     /* Call at-exit functions in reverse order */
-    for (p = _entries; p; p = p->next)
+    while (p)
     {
+        oe_atexit_entry_t* next = p->next;
+
         if (p->func)
             (*p->func)(p->arg);
+
+        oe_allocator_free(p);
+        p = next;
     }
 }
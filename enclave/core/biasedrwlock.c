@@ -0,0 +1,309 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/defs.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/time.h>
+#include <openenclave/internal/utils.h>
+
+/*
+**==============================================================================
+**
+** Reader-biased readers-writer lock:
+**
+**     While the lock is biased towards readers, a reader acquires it by
+**     storing the address of the lock in a free slot of its own reader row,
+**     and releases it by clearing that slot. Rows are claimed on first use
+**     by oe_thread_self(), which is stable for a TCS across ECALLs, and the
+**     slots of each row fill a cache line, so readers never write to shared
+**     memory. A thread that reads a lock again takes it through the same
+**     slot, which counts the depth, even if the bias has been revoked in the
+**     meantime: the writer is waiting for that slot, so sending the reader
+**     to the underlying lock, which the writer holds, would deadlock.
+**
+**     A writer acquires the underlying oe_rwlock_t for writing (which keeps
+**     new slow-path readers out), clears the bias (which keeps new slot
+**     readers out), and waits until no slot of any row holds the lock. The
+**     slot store and the bias check of a reader, and the bias store and slot
+**     scan of a writer, are each ordered by a full barrier, so either the
+**     reader sees that the bias is gone and backs off, or the writer sees
+**     the slot and waits for it. Readers may hold the lock across OCALLs,
+**     so a writer that keeps finding slot readers stops spinning and sleeps.
+**
+**     Without the bias, readers use the underlying oe_rwlock_t. The bias is
+**     restored after REBIAS_READS such reads, so that locks that are written
+**     often do not pay for the scan on every write.
+**
+**==============================================================================
+*/
+
+#define NUM_READER_ROWS 64 /* Power of two, above the maximum TCS count */
+#define SLOTS_PER_ROW 7
+#define REBIAS_READS 256
+#define WRITER_SPINS 1000
+
+typedef struct _reader_row
+{
+    /* Thread that owns this row (null if the row is unused) */
+    void* volatile owner;
+
+    /* Locks currently read-locked through this row */
+    void* volatile slots[SLOTS_PER_ROW];
+
+    /* Read locks held through each slot (only used by the owner) */
+    uint32_t depths[SLOTS_PER_ROW];
+    uint8_t padding[64 - SLOTS_PER_ROW * sizeof(uint32_t)];
+} reader_row_t;
+
+OE_STATIC_ASSERT(sizeof(reader_row_t) == 128);
+
+typedef struct _oe_biased_rwlock_impl
+{
+    /* Used by writers, and by readers while the lock is not biased */
+    oe_rwlock_t rwlock;
+
+    /* Non-zero while readers may use their reader rows */
+    volatile uint32_t bias;
+
+    /* Slow-path reads since the bias was revoked (approximate) */
+    volatile uint32_t slow_reads;
+} oe_biased_rwlock_impl_t;
+
+OE_STATIC_ASSERT(
+    sizeof(oe_biased_rwlock_impl_t) <= sizeof(oe_biased_rwlock_t));
+
+static reader_row_t _reader_rows[NUM_READER_ROWS] OE_ALIGNED(64);
+
+static reader_row_t* _get_reader_row(void)
+{
+    void* self = (void*)oe_thread_self();
+    uint64_t hash = ((uint64_t)self >> 12) * 0x9E3779B97F4A7C15ULL;
+
+    for (size_t i = 0; i < NUM_READER_ROWS; i++)
+    {
+        reader_row_t* row = &_reader_rows[(hash + i) & (NUM_READER_ROWS - 1)];
+        void* owner = oe_atomic_load_ptr(&row->owner);
+
+        if (owner == self)
+            return row;
+
+        if (!owner && oe_atomic_compare_and_swap_ptr(&row->owner, NULL, self))
+            return row;
+    }
+
+    return NULL;
+}
+
+/* Try to read-lock through a slot of the calling thread's row */
+static bool _slot_rdlock(oe_biased_rwlock_impl_t* lock)
+{
+    reader_row_t* row;
+    size_t free_slot = SLOTS_PER_ROW;
+
+    if (!(row = _get_reader_row()))
+        return false;
+
+    for (size_t i = 0; i < SLOTS_PER_ROW; i++)
+    {
+        /* Read again through the same slot, whatever the bias */
+        if (row->slots[i] == lock)
+        {
+            row->depths[i]++;
+            return true;
+        }
+
+        if (!row->slots[i] && free_slot == SLOTS_PER_ROW)
+            free_slot = i;
+    }
+
+    if (free_slot == SLOTS_PER_ROW || !oe_atomic_load_u32(&lock->bias))
+        return false;
+
+    /* Publish the slot before checking the bias (full barrier) */
+    oe_atomic_store_ptr(&row->slots[free_slot], lock);
+
+    if (oe_atomic_load_u32(&lock->bias))
+    {
+        row->depths[free_slot] = 1;
+        return true;
+    }
+
+    /* A writer revoked the bias: back off to the slow path */
+    oe_atomic_store_ptr(&row->slots[free_slot], NULL);
+    return false;
+}
+
+/* Release a read lock taken through a slot, if there is one */
+static bool _slot_unlock(oe_biased_rwlock_impl_t* lock)
+{
+    reader_row_t* row = _get_reader_row();
+
+    if (!row)
+        return false;
+
+    for (size_t i = 0; i < SLOTS_PER_ROW; i++)
+    {
+        if (row->slots[i] == lock)
+        {
+            if (--row->depths[i] == 0)
+                oe_atomic_store_ptr(&row->slots[i], NULL);
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool _has_slot_readers(oe_biased_rwlock_impl_t* lock)
+{
+    for (size_t i = 0; i < NUM_READER_ROWS; i++)
+    {
+        for (size_t j = 0; j < SLOTS_PER_ROW; j++)
+        {
+            if (oe_atomic_load_ptr(&_reader_rows[i].slots[j]) == lock)
+                return true;
+        }
+    }
+
+    return false;
+}
+
+/* Called after a slow-path read lock was acquired */
+static void _count_slow_read(oe_biased_rwlock_impl_t* lock)
+{
+    if (!lock->bias && ++lock->slow_reads >= REBIAS_READS)
+        oe_atomic_store_u32(&lock->bias, 1);
+}
+
+/* Caller holds the underlying lock for writing */
+static void _revoke_bias(oe_biased_rwlock_impl_t* lock)
+{
+    /* Clear the bias before scanning the slots (full barrier) */
+    oe_atomic_store_u32(&lock->bias, 0);
+    lock->slow_reads = 0;
+}
+
+oe_result_t oe_biased_rwlock_init(oe_biased_rwlock_t* read_write_lock)
+{
+    oe_biased_rwlock_impl_t* lock = (oe_biased_rwlock_impl_t*)read_write_lock;
+
+    if (!lock)
+        return OE_INVALID_PARAMETER;
+
+    lock->bias = 0;
+    lock->slow_reads = 0;
+
+    return oe_rwlock_init(&lock->rwlock);
+}
+
+oe_result_t oe_biased_rwlock_rdlock(oe_biased_rwlock_t* read_write_lock)
+{
+    oe_biased_rwlock_impl_t* lock = (oe_biased_rwlock_impl_t*)read_write_lock;
+    oe_result_t result;
+
+    if (!lock)
+        return OE_INVALID_PARAMETER;
+
+    if (_slot_rdlock(lock))
+        return OE_OK;
+
+    if ((result = oe_rwlock_rdlock(&lock->rwlock)) == OE_OK)
+        _count_slow_read(lock);
+
+    return result;
+}
+
+oe_result_t oe_biased_rwlock_tryrdlock(oe_biased_rwlock_t* read_write_lock)
+{
+    oe_biased_rwlock_impl_t* lock = (oe_biased_rwlock_impl_t*)read_write_lock;
+    oe_result_t result;
+
+    if (!lock)
+        return OE_INVALID_PARAMETER;
+
+    if (_slot_rdlock(lock))
+        return OE_OK;
+
+    if ((result = oe_rwlock_tryrdlock(&lock->rwlock)) == OE_OK)
+        _count_slow_read(lock);
+
+    return result;
+}
+
+oe_result_t oe_biased_rwlock_wrlock(oe_biased_rwlock_t* read_write_lock)
+{
+    oe_biased_rwlock_impl_t* lock = (oe_biased_rwlock_impl_t*)read_write_lock;
+    oe_result_t result;
+
+    if (!lock)
+        return OE_INVALID_PARAMETER;
+
+    if ((result = oe_rwlock_wrlock(&lock->rwlock)) != OE_OK)
+        return result;
+
+    _revoke_bias(lock);
+
+    /* Wait for the readers that got in while the lock was biased */
+    for (size_t spins = 0; _has_slot_readers(lock); spins++)
+    {
+        if (spins < WRITER_SPINS)
+            OE_CPU_RELAX();
+        else
+            oe_sleep_msec(1);
+    }
+
+    return OE_OK;
+}
+
+oe_result_t oe_biased_rwlock_trywrlock(oe_biased_rwlock_t* read_write_lock)
+{
+    oe_biased_rwlock_impl_t* lock = (oe_biased_rwlock_impl_t*)read_write_lock;
+    oe_result_t result;
+
+    if (!lock)
+        return OE_INVALID_PARAMETER;
+
+    if ((result = oe_rwlock_trywrlock(&lock->rwlock)) != OE_OK)
+        return result;
+
+    _revoke_bias(lock);
+
+    /* Leave the bias revoked, so a later attempt can succeed once the
+     * current slot readers are gone */
+    if (_has_slot_readers(lock))
+    {
+        oe_rwlock_unlock(&lock->rwlock);
+        return OE_BUSY;
+    }
+
+    return OE_OK;
+}
+
+oe_result_t oe_biased_rwlock_unlock(oe_biased_rwlock_t* read_write_lock)
+{
+    oe_biased_rwlock_impl_t* lock = (oe_biased_rwlock_impl_t*)read_write_lock;
+
+    if (!lock)
+        return OE_INVALID_PARAMETER;
+
+    if (_slot_unlock(lock))
+        return OE_OK;
+
+    return oe_rwlock_unlock(&lock->rwlock);
+}
+
+oe_result_t oe_biased_rwlock_destroy(oe_biased_rwlock_t* read_write_lock)
+{
+    oe_biased_rwlock_impl_t* lock = (oe_biased_rwlock_impl_t*)read_write_lock;
+
+    if (!lock)
+        return OE_INVALID_PARAMETER;
+
+    if (_has_slot_readers(lock))
+        return OE_BUSY;
+
+    return oe_rwlock_destroy(&lock->rwlock);
+}
@@ -1,8 +1,8 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
-#define USE_DL_PREFIX
 #include "debugmalloc.h"
+#include <openenclave/allocator.h>
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/corelibc/errno.h>
 #include <openenclave/enclave.h>
@@ -13,7 +13,6 @@
 #include <openenclave/internal/thread.h>
 #include <openenclave/internal/types.h>
 #include <openenclave/internal/utils.h>
-#include "../3rdparty/dlmalloc/dlmalloc/malloc.h"
 
 #if defined(OE_USE_DEBUG_MALLOC)
 
@@ -312,7 +311,7 @@ void* oe_debug_malloc(size_t size)
     void* block;
     const size_t block_size = _calculate_block_size(0, size);
 
-    if (!(block = dlmalloc(block_size)))
+    if (!(block = oe_allocator_malloc(block_size)))
         return NULL;
 
     /* Fill block with 0xAA (Allocated) bytes */
@@ -339,7 +338,7 @@ void oe_debug_free(void* ptr)
         size_t block_size = _get_block_size(ptr);
         oe_memset_s(block, block_size, 0xDD, block_size);
 
-        dlfree(block);
+        oe_allocator_free(block);
     }
 }
 
@@ -404,7 +403,7 @@ void* oe_debug_memalign(size_t alignment, size_t size)
     void* block;
     header_t* header;
 
-    if (!(block = dlmemalign(alignment, block_size)))
+    if (!(block = oe_allocator_memalign(alignment, block_size)))
         return NULL;
 
     header = (header_t*)((uint8_t*)block + padding_size);
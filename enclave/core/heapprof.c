@@ -0,0 +1,513 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "heapprof.h"
+#include <openenclave/corelibc/stdarg.h>
+#include <openenclave/corelibc/stdio.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/backtrace.h>
+#include <openenclave/internal/globals.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/types.h>
+
+#include "tee_t.h"
+
+#if defined(OE_USE_HEAP_PROFILER)
+
+/*
+**==============================================================================
+**
+** Heap profiler:
+**
+**     Samples roughly one in every N bytes allocated, where N is the
+**     interval passed to oe_start_heap_profiling(). Each thread counts down
+**     a random number of bytes, drawn uniformly from [N/2, 3N/2), and the
+**     allocation that crosses zero is sampled. A sample of S bytes thus
+**     stands for about max(1, N/S) allocations of that size; its call site is
+**     credited with that estimate, so the profile needs no further scaling.
+**
+**     The call site of a sample is its backtrace, obtained with
+**     oe_backtrace(). Sites are aggregated in a table keyed by a hash of the
+**     stack. Sampled blocks are recorded in a second table, so that their
+**     estimate can be subtracted from the in-use figures of their site when
+**     they are freed. Both tables are open-addressed and only updated with
+**     atomic operations. Samples that find no room within a few probes are
+**     dropped.
+**
+**     The profile is written in the text format of gperftools heap profiles,
+**     which pprof reads:
+**
+**         heap profile: <inuse objs>: <inuse bytes> [<objs>: <bytes>] @ heap
+**         <inuse objs>: <inuse bytes> [<objs>: <bytes>] @ 0x... 0x...
+**         ...
+**
+**         MAPPED_LIBRARIES:
+**         <enclave start>-<enclave end> r-xp 00000000 00:00 0 <enclave path>
+**
+**==============================================================================
+*/
+
+#define MAX_SITES 1024   /* Power of two */
+#define MAX_SAMPLES 8192 /* Power of two */
+#define MAX_PROBES 32
+#define MAX_FRAMES 24
+#define MAX_INTERVAL ((uint64_t)1 << 40)
+#define TOMBSTONE ((void*)1)
+
+typedef struct _site
+{
+    /* Hash of the stack (zero if the entry is unused) */
+    volatile uint64_t hash;
+
+    /* Set once the frames have been written */
+    volatile uint32_t ready;
+    uint32_t num_frames;
+    void* frames[MAX_FRAMES];
+
+    /* Estimated allocations and bytes: all of them, and those in use */
+    volatile uint64_t alloc_count;
+    volatile uint64_t alloc_bytes;
+    volatile uint64_t inuse_count;
+    volatile uint64_t inuse_bytes;
+} site_t;
+
+typedef struct _sample
+{
+    /* Sampled block (null if never used, TOMBSTONE once freed) */
+    void* volatile ptr;
+    site_t* site;
+    uint64_t count;
+    uint64_t bytes;
+} sample_t;
+
+volatile uint64_t __oe_heap_profile_interval;
+volatile uint64_t __oe_heap_profile_live_samples;
+
+static site_t* volatile _sites;
+static sample_t* volatile _samples;
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+static volatile uint64_t _num_seeds;
+
+/* Per-thread sampling state. Like all thread-locals it is reset on each
+ * ECALL, which is harmless since the intervals are random anyway. */
+static __thread uint64_t _random_state;
+static __thread int64_t _bytes_until_sample;
+
+static uint64_t _random(void)
+{
+    uint64_t x = _random_state;
+
+    /* xorshift64* */
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    _random_state = x;
+
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static int64_t _next_interval(uint64_t interval)
+{
+    return (int64_t)(interval / 2 + _random() % interval);
+}
+
+static uint64_t _hash(const void* data, size_t size)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t hash = 0xCBF29CE484222325ULL; /* FNV-1a */
+
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ p[i]) * 0x100000001B3ULL;
+
+    return hash ? hash : 1;
+}
+
+static site_t* _get_site(site_t* sites, void* const* frames, uint32_t n)
+{
+    const uint64_t hash = _hash(frames, n * sizeof(void*));
+
+    for (size_t i = 0; i < MAX_PROBES; i++)
+    {
+        site_t* site = &sites[(hash + i) & (MAX_SITES - 1)];
+        uint64_t site_hash = oe_atomic_load_u64(&site->hash);
+
+        if (!site_hash &&
+            oe_atomic_compare_and_swap_u64(&site->hash, 0, hash))
+        {
+            site->num_frames = n;
+            memcpy(site->frames, frames, n * sizeof(void*));
+            oe_atomic_store_u32(&site->ready, 1);
+            return site;
+        }
+
+        /* A site whose frames are still being written is skipped: at
+         * worst its stack appears twice in the profile, which pprof merges */
+        if (oe_atomic_load_u64(&site->hash) == hash &&
+            oe_atomic_load_u32(&site->ready) && site->num_frames == n &&
+            memcmp(site->frames, frames, n * sizeof(void*)) == 0)
+        {
+            return site;
+        }
+    }
+
+    return NULL;
+}
+
+static void _add_sample(
+    sample_t* samples,
+    void* ptr,
+    site_t* site,
+    uint64_t count,
+    uint64_t bytes)
+{
+    const uint64_t hash = _hash(&ptr, sizeof(ptr));
+
+    for (size_t i = 0; i < MAX_PROBES; i++)
+    {
+        sample_t* sample = &samples[(hash + i) & (MAX_SAMPLES - 1)];
+        void* p = oe_atomic_load_ptr(&sample->ptr);
+
+        if ((p == NULL || p == TOMBSTONE) &&
+            oe_atomic_compare_and_swap_ptr(&sample->ptr, p, ptr))
+        {
+            /* No other thread reads these until the block is freed */
+            sample->site = site;
+            sample->count = count;
+            sample->bytes = bytes;
+
+            oe_atomic_add_u64(&site->inuse_count, count);
+            oe_atomic_add_u64(&site->inuse_bytes, bytes);
+            oe_atomic_increment(&__oe_heap_profile_live_samples);
+            return;
+        }
+    }
+}
+
+void oe_heap_profile_malloc(void* ptr, size_t size)
+{
+    const uint64_t interval = __oe_heap_profile_interval;
+    site_t* sites = (site_t*)oe_atomic_load_ptr((void* volatile*)&_sites);
+    sample_t* samples =
+        (sample_t*)oe_atomic_load_ptr((void* volatile*)&_samples);
+    void* frames[MAX_FRAMES + 1];
+    int num_frames;
+    site_t* site;
+    uint64_t count;
+
+    if (!interval || !sites || !samples)
+        return;
+
+    if (!_random_state)
+    {
+        _random_state = ((uint64_t)oe_thread_self() ^
+                         oe_atomic_increment(&_num_seeds) *
+                             0x9E3779B97F4A7C15ULL) |
+                        1;
+        _bytes_until_sample = _next_interval(interval);
+    }
+
+    if ((_bytes_until_sample -= (int64_t)size) > 0)
+        return;
+
+    _bytes_until_sample = _next_interval(interval);
+
+    /* The first frame is in this function */
+    if ((num_frames = oe_backtrace(frames, MAX_FRAMES + 1)) < 1)
+        num_frames = 1;
+
+    if (!(site = _get_site(sites, frames + 1, (uint32_t)num_frames - 1)))
+        return;
+
+    count = (size && size < interval) ? interval / size : 1;
+
+    oe_atomic_add_u64(&site->alloc_count, count);
+    oe_atomic_add_u64(&site->alloc_bytes, count * size);
+    _add_sample(samples, ptr, site, count, count * size);
+}
+
+void oe_heap_profile_take(void* ptr, oe_heap_profile_sample_t* saved)
+{
+    sample_t* samples =
+        (sample_t*)oe_atomic_load_ptr((void* volatile*)&_samples);
+    const uint64_t hash = _hash(&ptr, sizeof(ptr));
+
+    if (!samples)
+        return;
+
+    for (size_t i = 0; i < MAX_PROBES; i++)
+    {
+        sample_t* sample = &samples[(hash + i) & (MAX_SAMPLES - 1)];
+        void* p = oe_atomic_load_ptr(&sample->ptr);
+
+        if (!p)
+            return;
+
+        if (p == ptr)
+        {
+            site_t* site = sample->site;
+            const uint64_t count = sample->count;
+            const uint64_t bytes = sample->bytes;
+
+            if (oe_atomic_compare_and_swap_ptr(&sample->ptr, ptr, TOMBSTONE))
+            {
+                oe_atomic_add_u64(&site->inuse_count, (uint64_t)0 - count);
+                oe_atomic_add_u64(&site->inuse_bytes, (uint64_t)0 - bytes);
+                oe_atomic_decrement(&__oe_heap_profile_live_samples);
+
+                if (saved)
+                {
+                    saved->site = site;
+                    saved->count = count;
+                    saved->bytes = bytes;
+                }
+            }
+
+            return;
+        }
+    }
+}
+
+void oe_heap_profile_free(void* ptr)
+{
+    oe_heap_profile_take(ptr, NULL);
+}
+
+void oe_heap_profile_restore(void* ptr, const oe_heap_profile_sample_t* saved)
+{
+    sample_t* samples =
+        (sample_t*)oe_atomic_load_ptr((void* volatile*)&_samples);
+
+    /* The sample belongs to a profile that has since been destroyed */
+    if (!samples)
+        return;
+
+    _add_sample(samples, ptr, (site_t*)saved->site, saved->count, saved->bytes);
+}
+
+oe_result_t oe_start_heap_profiling(size_t sample_interval)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    site_t* sites = NULL;
+    sample_t* samples = NULL;
+
+    if (!sample_interval || sample_interval > MAX_INTERVAL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    oe_spin_lock(&_lock);
+
+    /* The tables are kept when profiling stops, so it can be resumed */
+    if (!_sites)
+    {
+        sites = (site_t*)oe_calloc(MAX_SITES, sizeof(site_t));
+        samples = (sample_t*)oe_calloc(MAX_SAMPLES, sizeof(sample_t));
+
+        if (!sites || !samples)
+        {
+            oe_spin_unlock(&_lock);
+            OE_RAISE(OE_OUT_OF_MEMORY);
+        }
+
+        oe_atomic_store_ptr((void* volatile*)&_samples, samples);
+        oe_atomic_store_ptr((void* volatile*)&_sites, sites);
+        sites = NULL;
+        samples = NULL;
+    }
+
+    __oe_heap_profile_interval = sample_interval;
+
+    oe_spin_unlock(&_lock);
+
+    result = OE_OK;
+
+done:
+    oe_free(sites);
+    oe_free(samples);
+    return result;
+}
+
+oe_result_t oe_stop_heap_profiling(void)
+{
+    __oe_heap_profile_interval = 0;
+    return OE_OK;
+}
+
+void oe_heap_profile_destroy(void)
+{
+    site_t* sites;
+    sample_t* samples;
+
+    oe_spin_lock(&_lock);
+    {
+        __oe_heap_profile_interval = 0;
+        __oe_heap_profile_live_samples = 0;
+        sites = _sites;
+        samples = _samples;
+        oe_atomic_store_ptr((void* volatile*)&_sites, NULL);
+        oe_atomic_store_ptr((void* volatile*)&_samples, NULL);
+    }
+    oe_spin_unlock(&_lock);
+
+    oe_free(sites);
+    oe_free(samples);
+}
+
+typedef struct _writer
+{
+    char* buffer;
+    size_t size;
+    size_t length;
+} writer_t;
+
+/* Append to the buffer, and keep counting the length once it is full */
+static void _write(writer_t* writer, const char* format, ...)
+{
+    oe_va_list ap;
+    int n;
+
+    oe_va_start(ap, format);
+
+    if (writer->length < writer->size)
+    {
+        n = oe_vsnprintf(
+            writer->buffer + writer->length,
+            writer->size - writer->length,
+            format,
+            ap);
+    }
+    else
+    {
+        n = oe_vsnprintf(NULL, 0, format, ap);
+    }
+
+    oe_va_end(ap);
+
+    if (n > 0)
+        writer->length += (size_t)n;
+}
+
+/* Read the in-use and total counts of a site, if it is in use */
+static bool _get_site_counts(site_t* site, uint64_t counts[4])
+{
+    if (!oe_atomic_load_u32(&site->ready))
+        return false;
+
+    counts[0] = oe_atomic_load_u64(&site->inuse_count);
+    counts[1] = oe_atomic_load_u64(&site->inuse_bytes);
+    counts[2] = oe_atomic_load_u64(&site->alloc_count);
+    counts[3] = oe_atomic_load_u64(&site->alloc_bytes);
+    return true;
+}
+
+oe_result_t oe_get_heap_profile_ecall(
+    const char* image_path,
+    char* buffer,
+    size_t buffer_size,
+    size_t* buffer_size_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    site_t* sites = (site_t*)oe_atomic_load_ptr((void* volatile*)&_sites);
+    writer_t writer = {buffer, buffer_size, 0};
+    uint64_t totals[4] = {0, 0, 0, 0};
+    const uint8_t* base = (const uint8_t*)__oe_get_enclave_base();
+
+    if (!buffer_size_out || (!buffer && buffer_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Only enclaves that started profiling disclose their call sites */
+    if (!sites)
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    for (size_t i = 0; i < MAX_SITES; i++)
+    {
+        uint64_t counts[4];
+
+        if (_get_site_counts(&sites[i], counts))
+        {
+            for (size_t j = 0; j < OE_COUNTOF(totals); j++)
+                totals[j] += counts[j];
+        }
+    }
+
+    _write(
+        &writer,
+        "heap profile: %llu: %llu [%llu: %llu] @ heap\n",
+        OE_LLU(totals[0]),
+        OE_LLU(totals[1]),
+        OE_LLU(totals[2]),
+        OE_LLU(totals[3]));
+
+    for (size_t i = 0; i < MAX_SITES; i++)
+    {
+        site_t* site = &sites[i];
+        uint64_t counts[4];
+
+        if (!_get_site_counts(site, counts))
+            continue;
+
+        _write(
+            &writer,
+            "%llu: %llu [%llu: %llu] @",
+            OE_LLU(counts[0]),
+            OE_LLU(counts[1]),
+            OE_LLU(counts[2]),
+            OE_LLU(counts[3]));
+
+        for (uint32_t j = 0; j < site->num_frames; j++)
+            _write(&writer, " 0x%llx", OE_LLX((uint64_t)site->frames[j]));
+
+        _write(&writer, "\n");
+    }
+
+    _write(
+        &writer,
+        "\nMAPPED_LIBRARIES:\n%llx-%llx r-xp 00000000 00:00 0 %s\n",
+        OE_LLX((uint64_t)base),
+        OE_LLX((uint64_t)(base + __oe_get_enclave_size())),
+        image_path ? image_path : "enclave");
+
+    *buffer_size_out = writer.length + 1;
+
+    if (writer.length >= buffer_size)
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+#else /* defined(OE_USE_HEAP_PROFILER) */
+
+oe_result_t oe_start_heap_profiling(size_t sample_interval)
+{
+    OE_UNUSED(sample_interval);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_stop_heap_profiling(void)
+{
+    return OE_UNSUPPORTED;
+}
+
+void oe_heap_profile_destroy(void)
+{
+}
+
+oe_result_t oe_get_heap_profile_ecall(
+    const char* image_path,
+    char* buffer,
+    size_t buffer_size,
+    size_t* buffer_size_out)
+{
+    OE_UNUSED(image_path);
+    OE_UNUSED(buffer);
+    OE_UNUSED(buffer_size);
+    OE_UNUSED(buffer_size_out);
+    return OE_UNSUPPORTED;
+}
+
+#endif /* defined(OE_USE_HEAP_PROFILER) */
@@ -0,0 +1,104 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HEAPPROF_H
+#define _OE_HEAPPROF_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+/* A sample taken out of the profile while its block is being resized */
+typedef struct _oe_heap_profile_sample
+{
+    void* site;
+    uint64_t count;
+    uint64_t bytes;
+} oe_heap_profile_sample_t;
+
+#if defined(OE_USE_HEAP_PROFILER)
+
+/* Sampling interval in bytes (zero when profiling is stopped) */
+extern volatile uint64_t __oe_heap_profile_interval;
+
+/* Number of sampled blocks that have not been freed yet */
+extern volatile uint64_t __oe_heap_profile_live_samples;
+
+void oe_heap_profile_malloc(void* ptr, size_t size);
+
+void oe_heap_profile_free(void* ptr);
+
+void oe_heap_profile_take(void* ptr, oe_heap_profile_sample_t* sample);
+
+void oe_heap_profile_restore(void* ptr, const oe_heap_profile_sample_t* sample);
+
+/* Called by the allocation functions after a block was allocated */
+OE_INLINE void oe_heap_profile_record_malloc(void* ptr, size_t size)
+{
+    if (__oe_heap_profile_interval && ptr)
+        oe_heap_profile_malloc(ptr, size);
+}
+
+/* Called by the allocation functions before a block is released */
+OE_INLINE void oe_heap_profile_record_free(void* ptr)
+{
+    if (__oe_heap_profile_live_samples && ptr)
+        oe_heap_profile_free(ptr);
+}
+
+/* Called by realloc() before a block is resized. Any sample of the block is
+ * taken out of the profile and saved in *sample. */
+OE_INLINE void oe_heap_profile_record_resize(
+    void* ptr,
+    oe_heap_profile_sample_t* sample)
+{
+    sample->site = NULL;
+
+    if (__oe_heap_profile_live_samples && ptr)
+        oe_heap_profile_take(ptr, sample);
+}
+
+/* Called by realloc() when a resize failed and the block is still in use */
+OE_INLINE void oe_heap_profile_record_resize_failed(
+    void* ptr,
+    const oe_heap_profile_sample_t* sample)
+{
+    if (sample->site)
+        oe_heap_profile_restore(ptr, sample);
+}
+
+#else /* defined(OE_USE_HEAP_PROFILER) */
+
+OE_INLINE void oe_heap_profile_record_malloc(void* ptr, size_t size)
+{
+    OE_UNUSED(ptr);
+    OE_UNUSED(size);
+}
+
+OE_INLINE void oe_heap_profile_record_free(void* ptr)
+{
+    OE_UNUSED(ptr);
+}
+
+OE_INLINE void oe_heap_profile_record_resize(
+    void* ptr,
+    oe_heap_profile_sample_t* sample)
+{
+    OE_UNUSED(ptr);
+    OE_UNUSED(sample);
+}
+
+OE_INLINE void oe_heap_profile_record_resize_failed(
+    void* ptr,
+    const oe_heap_profile_sample_t* sample)
+{
+    OE_UNUSED(ptr);
+    OE_UNUSED(sample);
+}
+
+#endif /* defined(OE_USE_HEAP_PROFILER) */
+
+/* Stop profiling and release the profile. Called when the enclave is
+ * destroyed. */
+void oe_heap_profile_destroy(void);
+
+#endif /* _OE_HEAPPROF_H */
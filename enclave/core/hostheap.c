@@ -0,0 +1,330 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/hostheap.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
+
+/*
+**==============================================================================
+**
+** Host heap:
+**
+**     The runtime needs small, short-lived host buffers that it allocates and
+**     releases itself, such as OCALL parameter buffers that do not fit in the
+**     thread's OCALL arena. Rather than performing an OCALL for each of them,
+**     oe_host_small_malloc() serves small requests from large chunks of host
+**     memory that the enclave obtains (and validates) once:
+**
+**         - Chunks are carved into 64 KB aligned spans. Each span serves a
+**           single size class (16 bytes to 2 KB, powers of two).
+**         - Spans are recorded in a hash table keyed by span address, which
+**           tells oe_host_small_free() whether (and in which class) a block
+**           is ours. Memory from oe_host_malloc() is still freed by OCALL.
+**         - Free blocks are kept in small per-thread caches, backed by a
+**           central free list per size class.
+**
+**     All bookkeeping lives in enclave memory; nothing is ever read back
+**     from the host chunks. Larger requests, and requests made once the
+**     chunk limit is reached, go to oe_host_malloc().
+**
+**     The public oe_host_malloc() and oe_host_free() do not use this
+**     allocator: their blocks may be released by the host, and a chunk must
+**     only be returned to the host once the enclave is destroyed.
+**
+**==============================================================================
+*/
+
+#define NUM_CLASSES 8
+#define MIN_BLOCK_SIZE 16
+#define MAX_BLOCK_SIZE (MIN_BLOCK_SIZE << (NUM_CLASSES - 1))
+#define SPAN_SHIFT 16
+#define SPAN_SIZE ((size_t)1 << SPAN_SHIFT)
+#define SPANS_PER_CHUNK 16
+#define CHUNK_SIZE (SPANS_PER_CHUNK * SPAN_SIZE)
+#define MAX_CHUNKS 64
+#define SPAN_TABLE_SIZE 2048 /* Power of two, twice the maximum span count */
+#define NUM_CACHES 32
+#define CACHE_SIZE 16
+
+OE_STATIC_ASSERT(SPAN_TABLE_SIZE >= 2 * MAX_CHUNKS * SPANS_PER_CHUNK);
+
+typedef struct _span_entry
+{
+    /* Span address >> SPAN_SHIFT (zero if the entry is unused) */
+    volatile uint64_t key;
+    uint64_t size_class;
+} span_entry_t;
+
+typedef struct _central_list
+{
+    oe_spinlock_t lock;
+
+    /* Blocks returned by the thread caches */
+    void** blocks;
+    size_t num_blocks;
+    size_t capacity;
+
+    /* Unused tail of the span this class currently carves from */
+    uint8_t* next;
+    uint8_t* end;
+} central_list_t;
+
+typedef struct _thread_cache
+{
+    oe_spinlock_t lock;
+    void* blocks[NUM_CLASSES][CACHE_SIZE];
+    size_t num_blocks[NUM_CLASSES];
+} thread_cache_t;
+
+static span_entry_t _spans[SPAN_TABLE_SIZE];
+static central_list_t _central[NUM_CLASSES];
+static thread_cache_t _caches[NUM_CACHES];
+
+static oe_spinlock_t _chunks_lock = OE_SPINLOCK_INITIALIZER;
+static void* _chunks[MAX_CHUNKS];
+static size_t _num_chunks;
+static uint8_t* _next_span;
+static uint8_t* _spans_end;
+
+static size_t _size_class(size_t size)
+{
+    size_t size_class = 0;
+
+    while ((size_t)(MIN_BLOCK_SIZE << size_class) < size)
+        size_class++;
+
+    return size_class;
+}
+
+static size_t _span_hash(uint64_t key)
+{
+    return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 53) &
+           (SPAN_TABLE_SIZE - 1);
+}
+
+/* Caller holds _chunks_lock */
+static void _insert_span(uint8_t* span, size_t size_class)
+{
+    uint64_t key = (uint64_t)span >> SPAN_SHIFT;
+    size_t i = _span_hash(key);
+
+    while (_spans[i].key)
+        i = (i + 1) & (SPAN_TABLE_SIZE - 1);
+
+    /* Publish the class before the key; lookups take no lock */
+    _spans[i].size_class = size_class;
+    oe_atomic_store_ptr((void* volatile*)&_spans[i].key, (void*)key);
+}
+
+/* Find the size class of a block handed out by this allocator */
+static bool _lookup_span(const void* ptr, size_t* size_class)
+{
+    uint64_t key = (uint64_t)ptr >> SPAN_SHIFT;
+    size_t i = _span_hash(key);
+    uint64_t entry_key;
+
+    while ((entry_key = (uint64_t)oe_atomic_load_ptr(
+                (void* volatile*)&_spans[i].key)) != 0)
+    {
+        if (entry_key == key)
+        {
+            *size_class = _spans[i].size_class;
+            return true;
+        }
+
+        i = (i + 1) & (SPAN_TABLE_SIZE - 1);
+    }
+
+    return false;
+}
+
+/* Take the next free span, obtaining a new chunk from the host if needed */
+static uint8_t* _new_span(size_t size_class)
+{
+    uint8_t* span = NULL;
+
+    oe_spin_lock(&_chunks_lock);
+
+    if (_next_span == _spans_end)
+    {
+        uint8_t* chunk;
+
+        if (_num_chunks == MAX_CHUNKS)
+            goto done;
+
+        /* oe_host_malloc() validates the chunk once, for all the blocks
+         * carved from it */
+        if (!(chunk = (uint8_t*)oe_host_malloc(CHUNK_SIZE + SPAN_SIZE)))
+            goto done;
+
+        _chunks[_num_chunks++] = chunk;
+        _next_span = (uint8_t*)oe_round_up_to_multiple(
+            (uint64_t)chunk, (uint64_t)SPAN_SIZE);
+        _spans_end = _next_span + CHUNK_SIZE;
+    }
+
+    span = _next_span;
+    _next_span += SPAN_SIZE;
+    _insert_span(span, size_class);
+
+done:
+    oe_spin_unlock(&_chunks_lock);
+    return span;
+}
+
+static thread_cache_t* _get_cache(void)
+{
+    uint64_t thread = (uint64_t)oe_thread_self() >> 12;
+
+    return &_caches[(thread * 0x9E3779B97F4A7C15ULL) >> 59];
+}
+
+/* Move up to half a cache worth of blocks from the central list into the
+ * cache. Caller holds the cache lock. */
+static void _refill_cache(thread_cache_t* cache, size_t size_class)
+{
+    central_list_t* central = &_central[size_class];
+    const size_t block_size = (size_t)MIN_BLOCK_SIZE << size_class;
+
+    oe_spin_lock(&central->lock);
+
+    while (cache->num_blocks[size_class] < CACHE_SIZE / 2)
+    {
+        void* block;
+
+        if (central->num_blocks)
+        {
+            block = central->blocks[--central->num_blocks];
+        }
+        else
+        {
+            if (central->next == central->end)
+            {
+                uint8_t* span = _new_span(size_class);
+
+                if (!span)
+                    break;
+
+                central->next = span;
+                central->end = span + SPAN_SIZE;
+            }
+
+            block = central->next;
+            central->next += block_size;
+        }
+
+        cache->blocks[size_class][cache->num_blocks[size_class]++] = block;
+    }
+
+    oe_spin_unlock(&central->lock);
+}
+
+/* Move half of the cached blocks to the central list. Caller holds the cache
+ * lock. */
+static void _flush_cache(thread_cache_t* cache, size_t size_class)
+{
+    central_list_t* central = &_central[size_class];
+
+    oe_spin_lock(&central->lock);
+
+    while (cache->num_blocks[size_class] > CACHE_SIZE / 2)
+    {
+        if (central->num_blocks == central->capacity)
+        {
+            size_t capacity = central->capacity ? central->capacity * 2 : 64;
+            void** blocks = (void**)oe_realloc(
+                central->blocks, capacity * sizeof(void*));
+
+            if (!blocks)
+                break;
+
+            central->blocks = blocks;
+            central->capacity = capacity;
+        }
+
+        central->blocks[central->num_blocks++] =
+            cache->blocks[size_class][--cache->num_blocks[size_class]];
+    }
+
+    oe_spin_unlock(&central->lock);
+}
+
+void* oe_host_small_malloc(size_t size)
+{
+    thread_cache_t* cache;
+    size_t size_class;
+    void* block = NULL;
+
+    if (size > MAX_BLOCK_SIZE)
+        return oe_host_malloc(size);
+
+    size_class = _size_class(size);
+    cache = _get_cache();
+
+    oe_spin_lock(&cache->lock);
+    {
+        if (!cache->num_blocks[size_class])
+            _refill_cache(cache, size_class);
+
+        if (cache->num_blocks[size_class])
+            block = cache->blocks[size_class][--cache->num_blocks[size_class]];
+    }
+    oe_spin_unlock(&cache->lock);
+
+    /* Fall back to the host's malloc() once the chunk limit is reached */
+    return block ? block : oe_host_malloc(size);
+}
+
+void oe_host_small_free(void* ptr)
+{
+    thread_cache_t* cache;
+    size_t size_class;
+
+    if (!ptr)
+        return;
+
+    if (!_lookup_span(ptr, &size_class))
+    {
+        oe_host_free(ptr);
+        return;
+    }
+
+    cache = _get_cache();
+
+    oe_spin_lock(&cache->lock);
+    {
+        if (cache->num_blocks[size_class] == CACHE_SIZE)
+            _flush_cache(cache, size_class);
+
+        /* If the central list could not grow, the block is lost */
+        if (cache->num_blocks[size_class] < CACHE_SIZE)
+            cache->blocks[size_class][cache->num_blocks[size_class]++] = ptr;
+    }
+    oe_spin_unlock(&cache->lock);
+}
+
+void oe_host_heap_destroy(void)
+{
+    oe_spin_lock(&_chunks_lock);
+    {
+        for (size_t i = 0; i < NUM_CLASSES; i++)
+            oe_free(_central[i].blocks);
+
+        for (size_t i = 0; i < _num_chunks; i++)
+            oe_host_free(_chunks[i]);
+
+        memset(_spans, 0, sizeof(_spans));
+        memset(_central, 0, sizeof(_central));
+        memset(_caches, 0, sizeof(_caches));
+        memset(_chunks, 0, sizeof(_chunks));
+        _num_chunks = 0;
+        _next_span = NULL;
+        _spans_end = NULL;
+    }
+    oe_spin_unlock(&_chunks_lock);
+}
@@ -1,16 +1,22 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <openenclave/allocator.h>
 #include <openenclave/bits/safecrt.h>
+#include <openenclave/bits/safemath.h>
 #include <openenclave/corelibc/stdio.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/defs.h>
 #include <openenclave/internal/fault.h>
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/malloc.h>
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/thread.h>
 #include "debugmalloc.h"
+#include "heapprof.h"
+#include "tee_t.h"
 
 /* The use of dlmalloc/malloc.c below requires stdc names from these headers */
 #define OE_NEED_STDC_NAMES
@@ -29,6 +35,7 @@
 #define LACKS_STDLIB_H
 #define LACKS_STRING_H
 #define USE_LOCKS 1
+#define MALLOC_INSPECT_ALL 1
 #define sbrk oe_sbrk
 #define fprintf _dlmalloc_stats_fprintf
 
@@ -43,6 +50,284 @@ static int _dlmalloc_stats_fprintf(FILE* stream, const char* format, ...);
 
 #pragma GCC diagnostic pop
 
+#if defined(OE_USE_SCALABLE_MALLOC) && !defined(OE_USE_DEBUG_MALLOC)
+
+/*
+**==============================================================================
+**
+** Thread caches:
+**
+**     dlmalloc serializes every call on a single lock, which becomes the
+**     bottleneck when many TCSs allocate at once. With OE_USE_SCALABLE_MALLOC,
+**     small blocks (up to 1 KB) are served from a cache owned by the calling
+**     thread, which is accessed without any lock:
+**
+**         - Requests are rounded up to one of a few size classes. A cache
+**           miss fetches a batch of blocks of that class from dlmalloc with
+**           a single dlindependent_comalloc() call, i.e. one lock round trip.
+**         - A freed block goes to the cache of the thread that frees it,
+**           whichever thread allocated it. Its class is derived from its
+**           usable size, so blocks from dlrealloc() or dlmemalign() can be
+**           cached as well.
+**         - When a class holds too many blocks, half of them are returned to
+**           dlmalloc with dlbulk_free(). Blocks freed by other threads thus
+**           find their way back to the shared heap lazily, in batches.
+**
+**     Caches are claimed on first use by oe_thread_self(), which is stable
+**     for a TCS across ECALLs (unlike thread-local variables). Larger blocks,
+**     and threads that find no free cache, use dlmalloc directly. Cached
+**     blocks count as in use in oe_get_malloc_stats().
+**
+**==============================================================================
+*/
+
+#define NUM_CLASSES 11
+#define MAX_CACHED_SIZE 1024
+#define CLASS_CACHE_BYTES (8 * 1024) /* Bytes cached per class and thread */
+#define MIN_CLASS_BLOCKS 8
+#define BATCH_SIZE 32
+#define NUM_THREAD_CACHES 64 /* Power of two, above the maximum TCS count */
+
+typedef struct _cache_list
+{
+    void* head;
+    size_t count;
+} cache_list_t;
+
+typedef struct _thread_cache
+{
+    /* Thread that owns this cache (null if the cache is unused) */
+    void* volatile owner;
+    cache_list_t lists[NUM_CLASSES];
+} thread_cache_t;
+
+/* Multiples of 16 bytes up to 128 bytes, then powers of two */
+static const size_t _class_sizes[NUM_CLASSES] =
+    {16, 32, 48, 64, 80, 96, 112, 128, 256, 512, 1024};
+
+static thread_cache_t _thread_caches[NUM_THREAD_CACHES];
+
+/* Smallest class that can serve a request of the given size */
+static size_t _size_to_class(size_t size)
+{
+    if (size <= 128)
+        return size ? (size - 1) >> 4 : 0;
+
+    if (size <= 256)
+        return 8;
+
+    return size <= 512 ? 9 : 10;
+}
+
+/* Largest class that a block of the given usable size can serve, or
+ * NUM_CLASSES if the block is too small or too large to be cached */
+static size_t _usable_size_to_class(size_t usable)
+{
+    if (usable < 16 || usable >= 2 * MAX_CACHED_SIZE)
+        return NUM_CLASSES;
+
+    if (usable < 128)
+        return (usable >> 4) - 1;
+
+    if (usable < 256)
+        return 7;
+
+    if (usable < 512)
+        return 8;
+
+    return usable < 1024 ? 9 : 10;
+}
+
+static size_t _max_class_blocks(size_t size_class)
+{
+    size_t n = CLASS_CACHE_BYTES / _class_sizes[size_class];
+    return n < MIN_CLASS_BLOCKS ? MIN_CLASS_BLOCKS : n;
+}
+
+static thread_cache_t* _get_thread_cache(void)
+{
+    void* self = (void*)oe_thread_self();
+    uint64_t hash = ((uint64_t)self >> 12) * 0x9E3779B97F4A7C15ULL;
+
+    for (size_t i = 0; i < NUM_THREAD_CACHES; i++)
+    {
+        thread_cache_t* cache =
+            &_thread_caches[(hash + i) & (NUM_THREAD_CACHES - 1)];
+        void* owner = oe_atomic_load_ptr(&cache->owner);
+
+        if (owner == self)
+            return cache;
+
+        if (!owner &&
+            oe_atomic_compare_and_swap_ptr(&cache->owner, NULL, self))
+            return cache;
+    }
+
+    return NULL;
+}
+
+/* Fill an empty list with a batch of blocks from dlmalloc */
+static bool _refill_list(cache_list_t* list, size_t size_class)
+{
+    size_t sizes[BATCH_SIZE];
+    void* blocks[BATCH_SIZE];
+    size_t n = _max_class_blocks(size_class) / 2;
+
+    if (n > BATCH_SIZE)
+        n = BATCH_SIZE;
+
+    for (size_t i = 0; i < n; i++)
+        sizes[i] = _class_sizes[size_class];
+
+    if (!dlindependent_comalloc(n, sizes, blocks))
+        return false;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        *(void**)blocks[i] = list->head;
+        list->head = blocks[i];
+    }
+
+    list->count += n;
+    return true;
+}
+
+/* Return the given number of blocks of a list to dlmalloc */
+static void _release_list(cache_list_t* list, size_t count)
+{
+    void* blocks[BATCH_SIZE];
+
+    while (count && list->head)
+    {
+        size_t n = 0;
+
+        while (n < BATCH_SIZE && n < count && list->head)
+        {
+            blocks[n] = list->head;
+            list->head = *(void**)list->head;
+            n++;
+        }
+
+        list->count -= n;
+        count -= n;
+        dlbulk_free(blocks, n);
+    }
+}
+
+static void* _cached_malloc(size_t size)
+{
+    thread_cache_t* cache;
+    cache_list_t* list;
+    size_t size_class;
+    void* ptr;
+
+    if (size > MAX_CACHED_SIZE || !(cache = _get_thread_cache()))
+        return dlmalloc(size);
+
+    size_class = _size_to_class(size);
+    list = &cache->lists[size_class];
+
+    if (!list->head && !_refill_list(list, size_class))
+        return dlmalloc(size);
+
+    ptr = list->head;
+    list->head = *(void**)ptr;
+    list->count--;
+
+    return ptr;
+}
+
+static void* _cached_calloc(size_t nmemb, size_t size)
+{
+    size_t total;
+    void* ptr;
+
+    if (oe_safe_mul_sizet(nmemb, size, &total) != OE_OK ||
+        total > MAX_CACHED_SIZE)
+        return dlcalloc(nmemb, size);
+
+    if ((ptr = _cached_malloc(total)))
+        memset(ptr, 0, total);
+
+    return ptr;
+}
+
+static void _cached_free(void* ptr)
+{
+    thread_cache_t* cache;
+    cache_list_t* list;
+    size_t size_class;
+
+    if (!ptr)
+        return;
+
+    size_class = _usable_size_to_class(dlmalloc_usable_size(ptr));
+
+    if (size_class == NUM_CLASSES || !(cache = _get_thread_cache()))
+    {
+        dlfree(ptr);
+        return;
+    }
+
+    list = &cache->lists[size_class];
+    *(void**)ptr = list->head;
+    list->head = ptr;
+
+    if (++list->count > _max_class_blocks(size_class))
+        _release_list(list, list->count / 2);
+}
+
+#endif /* defined(OE_USE_SCALABLE_MALLOC) && !defined(OE_USE_DEBUG_MALLOC) */
+
+/*
+**==============================================================================
+**
+** Default allocator:
+**
+**     dlmalloc (behind the thread caches with OE_USE_SCALABLE_MALLOC) is
+**     exported under the oe_allocator_*() names as weak aliases. An enclave
+**     that defines these functions itself replaces it (see allocator.h).
+**
+**==============================================================================
+*/
+
+static void _dlmalloc_init(void* heap_start_address, void* heap_end_address)
+{
+    /* dlmalloc obtains the heap with oe_sbrk() on demand */
+    OE_UNUSED(heap_start_address);
+    OE_UNUSED(heap_end_address);
+}
+
+static void _dlmalloc_cleanup(void)
+{
+}
+
+OE_WEAK_ALIAS(_dlmalloc_init, oe_allocator_init);
+OE_WEAK_ALIAS(_dlmalloc_cleanup, oe_allocator_cleanup);
+#if defined(OE_USE_SCALABLE_MALLOC) && !defined(OE_USE_DEBUG_MALLOC)
+OE_WEAK_ALIAS(_cached_malloc, oe_allocator_malloc);
+OE_WEAK_ALIAS(_cached_free, oe_allocator_free);
+OE_WEAK_ALIAS(_cached_calloc, oe_allocator_calloc);
+#else
+OE_WEAK_ALIAS(dlmalloc, oe_allocator_malloc);
+OE_WEAK_ALIAS(dlfree, oe_allocator_free);
+OE_WEAK_ALIAS(dlcalloc, oe_allocator_calloc);
+#endif
+OE_WEAK_ALIAS(dlrealloc, oe_allocator_realloc);
+OE_WEAK_ALIAS(dlmemalign, oe_allocator_memalign);
+OE_WEAK_ALIAS(dlposix_memalign, oe_allocator_posix_memalign);
+
+/* Whether the enclave defines the oe_allocator_*() functions itself. The
+ * statistics below describe dlmalloc and are unavailable if so. */
+static bool _is_allocator_replaced(void)
+{
+#if defined(OE_USE_SCALABLE_MALLOC) && !defined(OE_USE_DEBUG_MALLOC)
+    return oe_allocator_malloc != _cached_malloc;
+#else
+    return oe_allocator_malloc != dlmalloc;
+#endif
+}
+
 /* Choose release mode or debug mode allocation functions */
 #if defined(OE_USE_DEBUG_MALLOC)
 #define MALLOC oe_debug_malloc
@@ -52,12 +337,12 @@ static int _dlmalloc_stats_fprintf(FILE* stream, const char* format, ...);
 #define POSIX_MEMALIGN oe_debug_posix_memalign
 #define FREE oe_debug_free
 #else
-#define MALLOC dlmalloc
-#define CALLOC dlcalloc
-#define REALLOC dlrealloc
-#define MEMALIGN dlmemalign
-#define POSIX_MEMALIGN dlposix_memalign
-#define FREE dlfree
+#define MALLOC oe_allocator_malloc
+#define CALLOC oe_allocator_calloc
+#define REALLOC oe_allocator_realloc
+#define MEMALIGN oe_allocator_memalign
+#define POSIX_MEMALIGN oe_allocator_posix_memalign
+#define FREE oe_allocator_free
 #endif
 
 static oe_allocation_failure_callback_t _failure_callback;
@@ -72,6 +357,8 @@ void* oe_malloc(size_t size)
 {
     void* p = MALLOC(size);
 
+    oe_heap_profile_record_malloc(p, size);
+
     if (!p && size)
     {
         errno = ENOMEM;
@@ -85,11 +372,13 @@ void* oe_malloc(size_t size)
 
 void oe_free(void* ptr)
 {
+    oe_heap_profile_record_free(ptr);
     FREE(ptr);
 }
 
 void oe_memalign_free(void* ptr)
 {
+    oe_heap_profile_record_free(ptr);
     FREE(ptr);
 }
 
@@ -97,6 +386,8 @@ void* oe_calloc(size_t nmemb, size_t size)
 {
     void* p = CALLOC(nmemb, size);
 
+    oe_heap_profile_record_malloc(p, nmemb * size);
+
     if (!p && nmemb && size)
     {
         errno = ENOMEM;
@@ -110,10 +401,21 @@ void* oe_calloc(size_t nmemb, size_t size)
 
 void* oe_realloc(void* ptr, size_t size)
 {
-    void* p = REALLOC(ptr, size);
+    oe_heap_profile_sample_t sample;
+    void* p;
+
+    /* Before the block can be reused by another thread */
+    oe_heap_profile_record_resize(ptr, &sample);
+
+    p = REALLOC(ptr, size);
+
+    oe_heap_profile_record_malloc(p, size);
 
     if (!p && size)
     {
+        /* The original block is left untouched */
+        oe_heap_profile_record_resize_failed(ptr, &sample);
+
         errno = ENOMEM;
 
         if (_failure_callback)
@@ -127,6 +429,9 @@ int oe_posix_memalign(void** memptr, size_t alignment, size_t size)
 {
     int rc = POSIX_MEMALIGN(memptr, alignment, size);
 
+    if (rc == 0)
+        oe_heap_profile_record_malloc(*memptr, size);
+
     if (rc != 0 && size)
     {
         errno = ENOMEM;
@@ -142,6 +447,8 @@ void* oe_memalign(size_t alignment, size_t size)
 {
     void* p = MEMALIGN(alignment, size);
 
+    oe_heap_profile_record_malloc(p, size);
+
     if (!p && size)
     {
         errno = ENOMEM;
@@ -224,6 +531,12 @@ oe_result_t oe_get_malloc_stats(oe_malloc_stats_t* stats)
     if (!stats)
         goto done;
 
+    if (_is_allocator_replaced())
+    {
+        result = OE_UNSUPPORTED;
+        goto done;
+    }
+
     // This function indirectly calls _dlmalloc_stats_fprintf(), which sets
     // fields in the _malloc_stats structure.
     _dlmalloc_stats_fprintf_calls = 0;
@@ -241,3 +554,82 @@ done:
     oe_mutex_unlock(&_mutex);
     return result;
 }
+
+/*
+**==============================================================================
+**
+** oe_get_heap_stats()
+**
+**     Combines dlmallinfo() with a walk of the heap by dlmalloc_inspect_all(),
+**     which calls _inspect_chunk() for every chunk while holding the
+**     allocator lock.
+**
+**==============================================================================
+*/
+
+static void _inspect_chunk(
+    void* start,
+    void* end,
+    size_t used_bytes,
+    void* arg)
+{
+    oe_heap_stats_t* stats = (oe_heap_stats_t*)arg;
+    size_t size = (size_t)((uint8_t*)end - (uint8_t*)start);
+    size_t bucket = 0;
+
+    if (used_bytes)
+        return;
+
+    /* The top chunk is reported separately */
+    if ((uint8_t*)end == (uint8_t*)gm->top + gm->topsize)
+        return;
+
+    while ((size >> bucket) > 1 && bucket < OE_HEAP_STATS_NUM_BUCKETS - 1)
+        bucket++;
+
+    stats->free_chunk_histogram[bucket]++;
+    stats->num_free_chunks++;
+
+    if (size > stats->largest_free_chunk_bytes)
+        stats->largest_free_chunk_bytes = size;
+}
+
+oe_result_t oe_get_heap_stats(oe_heap_stats_t* stats)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    struct mallinfo info;
+    size_t sbrk_bytes;
+    size_t peak_sbrk_bytes;
+
+    if (stats)
+        memset(stats, 0, sizeof(oe_heap_stats_t));
+
+    if (!stats)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (_is_allocator_replaced())
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    info = dlmallinfo();
+    dlmalloc_inspect_all(_inspect_chunk, stats);
+    oe_get_sbrk_usage(&sbrk_bytes, &peak_sbrk_bytes);
+
+    stats->heap_size = __oe_get_heap_size();
+    stats->sbrk_bytes = sbrk_bytes;
+    stats->peak_sbrk_bytes = peak_sbrk_bytes;
+    stats->system_bytes = info.arena + info.hblkhd;
+    stats->peak_system_bytes = info.usmblks;
+    stats->in_use_bytes = info.uordblks;
+    stats->free_bytes = info.fordblks;
+    stats->top_chunk_bytes = info.keepcost;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_get_heap_stats_ecall(oe_heap_stats_t* stats)
+{
+    return oe_get_heap_stats(stats);
+}
@@ -74,3 +74,34 @@ oe_result_t oe_call_host_function(
         output_bytes_written,
         false /* non-switchless */);
 }
+
+/* OCALL batches are only supported in SGX enclaves */
+
+oe_result_t oe_ocall_batch_begin(oe_ocall_batch_t* batch)
+{
+    OE_UNUSED(batch);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_ocall_batch_add(
+    oe_ocall_batch_t* batch,
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size)
+{
+    OE_UNUSED(batch);
+    OE_UNUSED(function_id);
+    OE_UNUSED(input_buffer);
+    OE_UNUSED(input_buffer_size);
+    OE_UNUSED(output_buffer);
+    OE_UNUSED(output_buffer_size);
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_ocall_batch_submit(oe_ocall_batch_t* batch)
+{
+    OE_UNUSED(batch);
+    return OE_UNSUPPORTED;
+}
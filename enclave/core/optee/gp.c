@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #define OE_NEED_STDC_NAMES
+#include <openenclave/allocator.h>
 #include <openenclave/bits/defs.h>
 #include <openenclave/bits/types.h>
 #include <openenclave/corelibc/stdlib.h>
@@ -9,6 +10,8 @@
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/calls.h>
+#include <openenclave/internal/globals.h>
+#include <openenclave/internal/hostheap.h>
 #include <openenclave/internal/raise.h>
 #include "../atexit.h"
 #include "../calls.h"
@@ -399,6 +402,10 @@ TEE_Result TA_CreateEntryPoint(void)
     if (result != TEE_SUCCESS)
         return result;
 
+    /* Initialize the allocator before the initialization functions, which
+     * may allocate */
+    oe_allocator_init((void*)__oe_get_heap_base(), (void*)__oe_get_heap_end());
+
     /* Call compiler-generated initialization functions */
     oe_call_init_functions();
 
@@ -493,4 +500,10 @@ void TA_DestroyEntryPoint(void)
 
     /* Call all finalization functions */
     oe_call_fini_functions();
+
+    /* Return the host memory chunks used by oe_host_small_malloc() */
+    oe_host_heap_destroy();
+
+    /* Release the allocator */
+    oe_allocator_cleanup();
 }
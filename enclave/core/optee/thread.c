@@ -46,6 +46,39 @@ bool oe_thread_equal(oe_thread_t thread1, oe_thread_t thread2)
     return thread1 == thread2;
 }
 
+/* Trusted applications are single-threaded */
+oe_result_t oe_thread_create(
+    oe_thread_handle_t* thread,
+    void* (*start_routine)(void*),
+    void* arg)
+{
+    OE_UNUSED(thread);
+    OE_UNUSED(start_routine);
+    OE_UNUSED(arg);
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_thread_join(oe_thread_handle_t thread, void** retval)
+{
+    OE_UNUSED(thread);
+    OE_UNUSED(retval);
+
+    return OE_INVALID_PARAMETER;
+}
+
+oe_result_t oe_thread_detach(oe_thread_handle_t thread)
+{
+    OE_UNUSED(thread);
+
+    return OE_INVALID_PARAMETER;
+}
+
+bool oe_is_enclave_terminating(void)
+{
+    return false;
+}
+
 /*
 **==============================================================================
 **
@@ -197,6 +230,18 @@ oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
     return OE_OK;
 }
 
+oe_result_t oe_cond_timedwait(
+    oe_cond_t* condition,
+    oe_mutex_t* mutex,
+    uint64_t deadline)
+{
+    OE_UNUSED(condition);
+    OE_UNUSED(mutex);
+    OE_UNUSED(deadline);
+
+    return OE_UNSUPPORTED;
+}
+
 oe_result_t oe_cond_signal(oe_cond_t* condition)
 {
     oe_cond_impl_t* cond = (oe_cond_impl_t*)condition;
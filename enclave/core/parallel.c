@@ -0,0 +1,409 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/defs.h>
+#include <openenclave/internal/parallel.h>
+#include <openenclave/internal/thread.h>
+
+/*
+**==============================================================================
+**
+** Task deques:
+**
+**     A deque holds tasks in slots[top] to slots[bottom - 1] (modulo the
+**     deque size). Its owner pushes and pops at the bottom; other threads
+**     steal from the top, so the oldest (and usually largest) tasks move
+**     between threads. Deques are short-lived critical sections, so each is
+**     guarded by a spinlock. The number of queued tasks in all deques is
+**     updated under the same locks, so it never drops below zero.
+**
+**==============================================================================
+*/
+
+#define MAX_WORKERS 32 /* Not less than the maximum TCS count */
+#define DEQUE_SIZE 256 /* Power of two */
+
+typedef struct _task
+{
+    void (*func)(void* arg);
+    void* arg;
+    struct _task_group_impl* group;
+
+    /* Allocated by oe_task_spawn() and freed once run */
+    bool allocated;
+} task_t;
+
+typedef struct _task_group_impl
+{
+    /* Tasks spawned into the group that have not finished */
+    volatile uint64_t pending;
+    uint64_t reserved;
+} task_group_impl_t;
+
+OE_STATIC_ASSERT(sizeof(task_group_impl_t) <= sizeof(oe_task_group_t));
+
+typedef struct _deque
+{
+    oe_spinlock_t lock;
+    volatile uint32_t top;
+    volatile uint32_t bottom;
+    task_t* slots[DEQUE_SIZE];
+} OE_ALIGNED(64) deque_t;
+
+/* Deques of the workers, followed by the shared queue of other threads */
+static deque_t _deques[MAX_WORKERS + 1];
+static deque_t* const _shared_queue = &_deques[MAX_WORKERS];
+
+/* Number of workers that have started (some may have failed to) */
+static volatile uint64_t _num_workers;
+
+/* Tasks queued in all deques */
+static volatile uint64_t _num_queued;
+
+/* Deque of the calling thread, if it is a worker */
+static __thread deque_t* _self_deque;
+
+static bool _push(deque_t* deque, task_t* task)
+{
+    bool pushed = false;
+
+    oe_spin_lock(&deque->lock);
+    {
+        if (deque->bottom - deque->top < DEQUE_SIZE)
+        {
+            deque->slots[deque->bottom++ & (DEQUE_SIZE - 1)] = task;
+            oe_atomic_increment(&_num_queued);
+            pushed = true;
+        }
+    }
+    oe_spin_unlock(&deque->lock);
+
+    return pushed;
+}
+
+/* Take the newest task (owner) or the oldest task (thieves) */
+static task_t* _take(deque_t* deque, bool newest)
+{
+    task_t* task = NULL;
+
+    /* Skip empty deques without taking their lock */
+    if (deque->top == deque->bottom)
+        return NULL;
+
+    oe_spin_lock(&deque->lock);
+    {
+        if (deque->top != deque->bottom)
+        {
+            if (newest)
+                task = deque->slots[--deque->bottom & (DEQUE_SIZE - 1)];
+            else
+                task = deque->slots[deque->top++ & (DEQUE_SIZE - 1)];
+
+            oe_atomic_decrement(&_num_queued);
+        }
+    }
+    oe_spin_unlock(&deque->lock);
+
+    return task;
+}
+
+static size_t _get_num_workers(void)
+{
+    uint64_t n = oe_atomic_load_u64(&_num_workers);
+    return n < MAX_WORKERS ? (size_t)n : MAX_WORKERS;
+}
+
+/* Find a task for the calling thread: its own newest task first, then the
+ * oldest shared task, then the oldest task of another worker */
+static task_t* _find_task(void)
+{
+    deque_t* self = _self_deque;
+    size_t num_workers = _get_num_workers();
+    size_t start = self ? (size_t)(self - _deques) + 1 : 0;
+    task_t* task;
+
+    if (self && (task = _take(self, true)))
+        return task;
+
+    if ((task = _take(_shared_queue, false)))
+        return task;
+
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        deque_t* victim = &_deques[(start + i) % num_workers];
+
+        if (victim != self && (task = _take(victim, false)))
+            return task;
+    }
+
+    return NULL;
+}
+
+/*
+**==============================================================================
+**
+** Parking:
+**
+**     Idle workers, and threads waiting for a group with nothing to run,
+**     sleep on one condition variable. A thread increments _num_sleepers
+**     before it checks for work, and a thread that makes work available
+**     reads _num_sleepers after it did so (both sequentially consistent),
+**     so either the sleeper sees the work or the waker sees the sleeper and
+**     signals under the mutex.
+**
+**==============================================================================
+*/
+
+static oe_mutex_t _park_mutex = OE_MUTEX_INITIALIZER;
+static oe_cond_t _park_cond = OE_COND_INITIALIZER;
+static volatile uint64_t _num_sleepers;
+static volatile uint32_t _stopping;
+
+/* Sleep until a task is queued, or the group has finished (if any), or the
+ * workers are stopped (otherwise) */
+static void _park(task_group_impl_t* group)
+{
+    oe_mutex_lock(&_park_mutex);
+    oe_atomic_increment(&_num_sleepers);
+
+    while (!oe_atomic_load_u64(&_num_queued))
+    {
+        if (group ? !oe_atomic_load_u64(&group->pending)
+                  : oe_atomic_load_u32(&_stopping))
+            break;
+
+        oe_cond_wait(&_park_cond, &_park_mutex);
+    }
+
+    oe_atomic_decrement(&_num_sleepers);
+    oe_mutex_unlock(&_park_mutex);
+}
+
+static void _unpark(bool all)
+{
+    if (!oe_atomic_load_u64(&_num_sleepers))
+        return;
+
+    oe_mutex_lock(&_park_mutex);
+
+    if (all)
+        oe_cond_broadcast(&_park_cond);
+    else
+        oe_cond_signal(&_park_cond);
+
+    oe_mutex_unlock(&_park_mutex);
+}
+
+static void _run_task(task_t* task)
+{
+    task_group_impl_t* group = task->group;
+
+    task->func(task->arg);
+
+    if (task->allocated)
+        oe_free(task);
+
+    /* The group (and the task, if not allocated) may be released by its
+     * waiter as soon as the count drops to zero */
+    if (oe_atomic_decrement(&group->pending) == 0)
+        _unpark(true);
+}
+
+static void _submit(task_t* task)
+{
+    oe_atomic_increment(&task->group->pending);
+
+    if (_push(_self_deque ? _self_deque : _shared_queue, task))
+        _unpark(false);
+    else
+        _run_task(task);
+}
+
+/*
+**==============================================================================
+**
+** Task groups
+**
+**==============================================================================
+*/
+
+oe_result_t oe_task_group_init(oe_task_group_t* group)
+{
+    task_group_impl_t* impl = (task_group_impl_t*)group;
+
+    if (!impl)
+        return OE_INVALID_PARAMETER;
+
+    impl->pending = 0;
+    impl->reserved = 0;
+
+    return OE_OK;
+}
+
+oe_result_t oe_task_spawn(
+    oe_task_group_t* group,
+    void (*func)(void* arg),
+    void* arg)
+{
+    task_t* task;
+
+    if (!group || !func)
+        return OE_INVALID_PARAMETER;
+
+    if (!(task = (task_t*)oe_malloc(sizeof(task_t))))
+        return OE_OUT_OF_MEMORY;
+
+    task->func = func;
+    task->arg = arg;
+    task->group = (task_group_impl_t*)group;
+    task->allocated = true;
+
+    _submit(task);
+
+    return OE_OK;
+}
+
+oe_result_t oe_task_group_wait(oe_task_group_t* group)
+{
+    task_group_impl_t* impl = (task_group_impl_t*)group;
+
+    if (!impl)
+        return OE_INVALID_PARAMETER;
+
+    while (oe_atomic_load_u64(&impl->pending))
+    {
+        task_t* task;
+
+        if ((task = _find_task()))
+            _run_task(task);
+        else
+            _park(impl);
+    }
+
+    return OE_OK;
+}
+
+/*
+**==============================================================================
+**
+** oe_parallel_for()
+**
+**==============================================================================
+*/
+
+typedef struct _chunk
+{
+    task_t task;
+    size_t begin;
+    size_t end;
+    void (*body)(size_t begin, size_t end, void* arg);
+    void* arg;
+} chunk_t;
+
+static void _run_chunk(void* arg)
+{
+    chunk_t* chunk = (chunk_t*)arg;
+
+    chunk->body(chunk->begin, chunk->end, chunk->arg);
+}
+
+oe_result_t oe_parallel_for(
+    size_t begin,
+    size_t end,
+    size_t grain,
+    void (*body)(size_t begin, size_t end, void* arg),
+    void* arg)
+{
+    oe_task_group_t group = OE_TASK_GROUP_INITIALIZER;
+    size_t count = end - begin;
+    size_t num_chunks;
+    chunk_t* chunks;
+
+    if (begin > end || !body)
+        return OE_INVALID_PARAMETER;
+
+    if (!count)
+        return OE_OK;
+
+    /* A few chunks per thread, so that stealing evens out uneven chunks */
+    if (!grain)
+    {
+        grain = count / (4 * (_get_num_workers() + 1));
+
+        if (!grain)
+            grain = 1;
+    }
+
+    num_chunks = count / grain + (count % grain != 0);
+
+    if (num_chunks == 1 || !_get_num_workers())
+    {
+        body(begin, end, arg);
+        return OE_OK;
+    }
+
+    if (!(chunks = (chunk_t*)oe_calloc(num_chunks, sizeof(chunk_t))))
+        return OE_OUT_OF_MEMORY;
+
+    for (size_t i = 0; i < num_chunks; i++)
+    {
+        chunk_t* chunk = &chunks[i];
+
+        chunk->task.func = _run_chunk;
+        chunk->task.arg = chunk;
+        chunk->task.group = (task_group_impl_t*)&group;
+        chunk->begin = begin + i * grain;
+        chunk->end = (i == num_chunks - 1) ? end : chunk->begin + grain;
+        chunk->body = body;
+        chunk->arg = arg;
+
+        _submit(&chunk->task);
+    }
+
+    oe_task_group_wait(&group);
+    oe_free(chunks);
+
+    return OE_OK;
+}
+
+/*
+**==============================================================================
+**
+** Workers
+**
+**==============================================================================
+*/
+
+oe_result_t oe_run_parallel_worker(void)
+{
+    uint64_t index = oe_atomic_increment(&_num_workers) - 1;
+
+    if (index >= MAX_WORKERS)
+        return OE_OUT_OF_THREADS;
+
+    _self_deque = &_deques[index];
+
+    while (!oe_atomic_load_u32(&_stopping))
+    {
+        task_t* task;
+
+        if ((task = _find_task()))
+            _run_task(task);
+        else
+            _park(NULL);
+    }
+
+    /* Tasks left in the deque are stolen by the threads waiting for them */
+    _self_deque = NULL;
+
+    return OE_OK;
+}
+
+void oe_stop_parallel_workers(void)
+{
+    oe_atomic_store_u32(&_stopping, 1);
+    _unpark(true);
+}
@@ -11,7 +11,7 @@ OE_STATIC_ASSERT(sizeof(oe_pthread_once_t) == sizeof(oe_once_t));
 OE_STATIC_ASSERT(sizeof(oe_pthread_spinlock_t) == sizeof(oe_spinlock_t));
 OE_STATIC_ASSERT(sizeof(oe_pthread_mutex_t) >= sizeof(oe_mutex_t));
 OE_STATIC_ASSERT(sizeof(oe_pthread_cond_t) >= sizeof(oe_cond_t));
-OE_STATIC_ASSERT(sizeof(oe_pthread_rwlock_t) >= sizeof(oe_rwlock_t));
+OE_STATIC_ASSERT(sizeof(oe_pthread_rwlock_t) >= sizeof(oe_biased_rwlock_t));
 
 /* Map an oe_result_t to a POSIX error number */
 OE_INLINE int _to_errno(oe_result_t result)
@@ -28,6 +28,8 @@ OE_INLINE int _to_errno(oe_result_t result)
             return OE_EPERM;
         case OE_OUT_OF_MEMORY:
             return OE_ENOMEM;
+        case OE_TIMEDOUT:
+            return OE_ETIMEDOUT;
         default:
             return OE_EINVAL; /* unreachable */
     }
@@ -186,6 +188,9 @@ int oe_pthread_mutex_destroy(oe_pthread_mutex_t* m)
 **
 ** oe_pthread_rwlock_t
 **
+**     Backed by oe_biased_rwlock_t, like pthread_rwlock_t in oelibc, so that
+**     both names of the lock run the same implementation.
+**
 **==============================================================================
 */
 
@@ -194,27 +199,27 @@ int oe_pthread_rwlock_init(
     const oe_pthread_rwlockattr_t* attr)
 {
     OE_UNUSED(attr);
-    return _to_errno(oe_rwlock_init((oe_rwlock_t*)rwlock));
+    return _to_errno(oe_biased_rwlock_init((oe_biased_rwlock_t*)rwlock));
 }
 
 int oe_pthread_rwlock_rdlock(oe_pthread_rwlock_t* rwlock)
 {
-    return _to_errno(oe_rwlock_rdlock((oe_rwlock_t*)rwlock));
+    return _to_errno(oe_biased_rwlock_rdlock((oe_biased_rwlock_t*)rwlock));
 }
 
 int oe_pthread_rwlock_wrlock(oe_pthread_rwlock_t* rwlock)
 {
-    return _to_errno(oe_rwlock_wrlock((oe_rwlock_t*)rwlock));
+    return _to_errno(oe_biased_rwlock_wrlock((oe_biased_rwlock_t*)rwlock));
 }
 
 int oe_pthread_rwlock_unlock(oe_pthread_rwlock_t* rwlock)
 {
-    return _to_errno(oe_rwlock_unlock((oe_rwlock_t*)rwlock));
+    return _to_errno(oe_biased_rwlock_unlock((oe_biased_rwlock_t*)rwlock));
 }
 
 int oe_pthread_rwlock_destroy(oe_pthread_rwlock_t* rwlock)
 {
-    return _to_errno(oe_rwlock_destroy((oe_rwlock_t*)rwlock));
+    return _to_errno(oe_biased_rwlock_destroy((oe_biased_rwlock_t*)rwlock));
 }
 
 /*
@@ -243,11 +248,24 @@ int oe_pthread_cond_timedwait(
     oe_pthread_mutex_t* mutex,
     const struct oe_timespec* ts)
 {
-    OE_UNUSED(cond);
-    OE_UNUSED(mutex);
-    OE_UNUSED(ts);
-    oe_assert("oe_pthread_cond_timedwait(): panic" == NULL);
-    return -1;
+    uint64_t deadline = 0;
+
+    /* The deadline is measured against CLOCK_REALTIME */
+    if (!ts || ts->tv_nsec < 0 || ts->tv_nsec >= 1000000000)
+        return OE_EINVAL;
+
+    /* A deadline before the Epoch has already passed */
+    if (ts->tv_sec > 0)
+    {
+        if ((uint64_t)ts->tv_sec >= OE_UINT64_MAX / 1000000000)
+            deadline = OE_UINT64_MAX;
+        else
+            deadline = (uint64_t)ts->tv_sec * 1000000000 +
+                       (uint64_t)ts->tv_nsec;
+    }
+
+    return _to_errno(
+        oe_cond_timedwait((oe_cond_t*)cond, (oe_mutex_t*)mutex, deadline));
 }
 
 int oe_pthread_cond_signal(oe_pthread_cond_t* cond)
@@ -2,31 +2,53 @@
 // Licensed under the MIT License.
 
 #include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/globals.h>
-#include <openenclave/internal/thread.h>
+#include <openenclave/internal/malloc.h>
+
+static void* volatile _heap_next;
+static void* volatile _heap_peak;
 
 void* oe_sbrk(ptrdiff_t increment)
 {
-    static unsigned char* _heap_next;
-    static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
-    void* ptr = (void*)-1;
+    unsigned char* next;
+    void* peak;
 
-    oe_spin_lock(&_lock);
+    /* Lock-free bump of the break: retry if another thread moved it */
+    do
     {
         ptrdiff_t remaining;
 
-        if (!_heap_next)
-            _heap_next = (unsigned char*)__oe_get_heap_base();
-
-        remaining = (unsigned char*)__oe_get_heap_end() - _heap_next;
-
-        if (increment <= remaining)
+        if (!(next = (unsigned char*)oe_atomic_load_ptr(&_heap_next)))
         {
-            ptr = _heap_next;
-            _heap_next += increment;
+            oe_atomic_compare_and_swap_ptr(
+                &_heap_next, NULL, (void*)__oe_get_heap_base());
+            continue;
         }
-    }
-    oe_spin_unlock(&_lock);
 
-    return ptr;
+        remaining = (unsigned char*)__oe_get_heap_end() - next;
+
+        if (increment > remaining)
+            return (void*)-1;
+    } while (!next || !oe_atomic_compare_and_swap_ptr(
+                          &_heap_next, next, next + increment));
+
+    /* Record the high-water mark of the break */
+    while ((peak = oe_atomic_load_ptr(&_heap_peak)) <
+               (void*)(next + increment) &&
+           !oe_atomic_compare_and_swap_ptr(
+               &_heap_peak, peak, next + increment))
+        ;
+
+    return next;
+}
+
+void oe_get_sbrk_usage(size_t* current, size_t* peak)
+{
+    const unsigned char* base = (const unsigned char*)__oe_get_heap_base();
+    unsigned char* next = (unsigned char*)oe_atomic_load_ptr(&_heap_next);
+    unsigned char* high = (unsigned char*)oe_atomic_load_ptr(&_heap_peak);
+
+    *current = next ? (size_t)(next - base) : 0;
+    *peak = high ? (size_t)(high - base) : 0;
 }
@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <openenclave/allocator.h>
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/corelibc/stdio.h>
 #include <openenclave/enclave.h>
@@ -40,7 +41,7 @@ int oe_backtrace(void** buffer, int size)
 {
     OE_UNUSED(buffer);
     OE_UNUSED(size);
-#ifdef OE_USE_DEBUG_MALLOC
+#if defined(OE_USE_DEBUG_MALLOC) || defined(OE_USE_HEAP_PROFILER)
     // Fetch the frame-pointer of the current function.
     // The current function oe_backtrace is not expected to be inlined.
     // The rbp register contains the frame-pointer upon entry to the function.
@@ -91,9 +92,6 @@ int oe_backtrace(void** buffer, int size)
 char** oe_backtrace_symbols(void* const* buffer, int size)
 {
     /* Backtrace must use the internal allocator to bypass debug-malloc. */
-    extern void* dlmalloc(size_t size);
-    extern void dlfree(void* ptr);
-    extern void* dlrealloc(void* ptr, size_t size);
     char** ret = NULL;
     void* symbols_buffer = NULL;
     const size_t SYMBOLS_BUFFER_SIZE = 4096;
@@ -105,7 +103,7 @@ char** oe_backtrace_symbols(void* const* buffer, int size)
     if (!buffer || size < 0)
         goto done;
 
-    if (!(symbols_buffer = dlmalloc(symbols_buffer_size)))
+    if (!(symbols_buffer = oe_allocator_malloc(symbols_buffer_size)))
         goto done;
 
     /* First call might return OE_BUFFER_TOO_SMALL. */
@@ -126,7 +124,8 @@ char** oe_backtrace_symbols(void* const* buffer, int size)
     {
         symbols_buffer_size = symbols_buffer_size_out;
 
-        if (!(symbols_buffer = dlrealloc(symbols_buffer, symbols_buffer_size)))
+        if (!(symbols_buffer = oe_allocator_realloc(
+                  symbols_buffer, symbols_buffer_size)))
             goto done;
 
         if (oe_backtrace_symbols_ocall(
@@ -155,8 +154,8 @@ char** oe_backtrace_symbols(void* const* buffer, int size)
             symbols_buffer_size_out,
             &argv,
             (size_t)size,
-            dlmalloc,
-            dlfree) != OE_OK)
+            oe_allocator_malloc,
+            oe_allocator_free) != OE_OK)
     {
         goto done;
     }
@@ -167,10 +166,10 @@ char** oe_backtrace_symbols(void* const* buffer, int size)
 done:
 
     if (symbols_buffer)
-        dlfree(symbols_buffer);
+        oe_allocator_free(symbols_buffer);
 
     if (argv)
-        dlfree(argv);
+        oe_allocator_free(argv);
 
     return ret;
 }
@@ -178,7 +177,5 @@ done:
 void oe_backtrace_symbols_free(char** ptr)
 {
     /* Backtrace must use the internal allocator to bypass debug-malloc. */
-    extern void dlfree(void* ptr);
-
-    dlfree(ptr);
+    oe_allocator_free(ptr);
 }
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include "../calls.h"
+#include <openenclave/allocator.h>
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/bits/safemath.h>
 #include <openenclave/corelibc/stdlib.h>
@@ -11,6 +12,7 @@
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/fault.h>
 #include <openenclave/internal/globals.h>
+#include <openenclave/internal/hostheap.h>
 #include <openenclave/internal/jump.h>
 #include <openenclave/internal/malloc.h>
 #include <openenclave/internal/print.h>
@@ -21,12 +23,14 @@
 #include <openenclave/internal/utils.h>
 #include "../../sgx/report.h"
 #include "../atexit.h"
+#include "../heapprof.h"
 #include "../shm.h"
 #include "asmdefs.h"
 #include "cpuid.h"
 #include "init.h"
 #include "report.h"
 #include "sgx_t.h"
+#include "switchless.h"
 #include "td.h"
 #include "tee_t.h"
 
@@ -151,6 +155,10 @@ static oe_result_t _handle_init_enclave(uint64_t arg_in)
         {
             oe_enclave_t* enclave = (oe_enclave_t*)arg_in;
 
+            /* Initialize the allocator before anything can allocate. */
+            oe_allocator_init(
+                (void*)__oe_get_heap_base(), (void*)__oe_get_heap_end());
+
             /* Install the common TEE ECALL function table. */
             OE_CHECK(oe_register_tee_ecall_function_table());
 
@@ -181,10 +189,76 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** ECALL marshaling buffers
+**
+**     Each td_t caches the buffer used to marshal the parameters of its
+**     ECALLs, so that small ECALLs do not go through the heap. The buffer
+**     grows on demand up to OE_MAX_CACHED_ECALL_BUFFER_SIZE; larger calls use
+**     a heap buffer that is freed on return. Cached buffers are released by
+**     td_free_caches() when the enclave is destroyed.
+**
+**==============================================================================
+*/
+
+#define OE_MIN_CACHED_ECALL_BUFFER_SIZE 1024
+#define OE_MAX_CACHED_ECALL_BUFFER_SIZE (16 * 1024)
+
+/* Take a buffer of at least the given size. The cached buffer is detached
+ * from the td_t while in use, so that nested calls (as made by switchless
+ * workers) get a buffer of their own. *capacity is zero for heap buffers
+ * that must not be cached. */
+static uint8_t* _acquire_ecall_buffer(td_t* td, size_t size, size_t* capacity)
+{
+    uint8_t* buffer = td->ecall_buffer;
+    size_t buffer_size = td->ecall_buffer_size;
+
+    *capacity = 0;
+
+    if (size > OE_MAX_CACHED_ECALL_BUFFER_SIZE)
+        return oe_malloc(size);
+
+    td->ecall_buffer = NULL;
+    td->ecall_buffer_size = 0;
+
+    if (!buffer || buffer_size < size)
+    {
+        oe_free(buffer);
+
+        if (!buffer_size)
+            buffer_size = OE_MIN_CACHED_ECALL_BUFFER_SIZE;
+
+        while (buffer_size < size)
+            buffer_size *= 2;
+
+        if (!(buffer = oe_malloc(buffer_size)))
+            return NULL;
+    }
+
+    *capacity = buffer_size;
+    return buffer;
+}
+
+static void _release_ecall_buffer(td_t* td, uint8_t* buffer, size_t capacity)
+{
+    /* Keep the buffer unless it is too big or a nested call cached one */
+    if (!capacity || td->ecall_buffer)
+    {
+        oe_free(buffer);
+        return;
+    }
+
+    td->ecall_buffer = buffer;
+    td->ecall_buffer_size = capacity;
+    td_register_caches(td);
+}
+
 /**
  * This is the preferred way to call enclave functions.
  */
-static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
+oe_result_t oe_handle_call_enclave_function(uint64_t arg_in)
 {
     oe_call_enclave_function_args_t args, *args_ptr;
     oe_result_t result = OE_OK;
@@ -193,8 +267,10 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
     uint8_t* input_buffer = NULL;
     uint8_t* output_buffer = NULL;
     size_t buffer_size = 0;
+    size_t buffer_capacity = 0;
     size_t output_bytes_written = 0;
     ecall_table_t ecall_table;
+    td_t* td = oe_get_td();
 
     // Ensure that args lies outside the enclave.
     if (!oe_is_outside_enclave(
@@ -258,7 +334,8 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
         OE_RAISE(OE_NOT_FOUND);
 
     // Allocate buffers in enclave memory
-    buffer = input_buffer = oe_malloc(buffer_size);
+    buffer = input_buffer =
+        _acquire_ecall_buffer(td, buffer_size, &buffer_capacity);
     if (buffer == NULL)
         OE_RAISE(OE_OUT_OF_MEMORY);
 
@@ -296,7 +373,7 @@ static oe_result_t _handle_call_enclave_function(uint64_t arg_in)
 
 done:
     if (buffer)
-        oe_free(buffer);
+        _release_ecall_buffer(td, buffer, buffer_capacity);
 
     return result;
 }
@@ -385,7 +462,7 @@ static void _handle_ecall(
     {
         case OE_ECALL_CALL_ENCLAVE_FUNCTION:
         {
-            arg_out = _handle_call_enclave_function(arg_in);
+            arg_out = oe_handle_call_enclave_function(arg_in);
             /* clear up shared memory upon ERET */
             oe_shm_clear();
             break;
@@ -401,6 +478,15 @@ static void _handle_ecall(
             /* Free shared memory upon destroying enclave */
             oe_shm_destroy();
 
+            /* Free the per-thread ECALL buffers and OCALL arenas */
+            td_free_caches();
+
+            /* Return the host memory chunks used by oe_host_small_malloc() */
+            oe_host_heap_destroy();
+
+            /* Release the heap profile, which is allocated from the heap */
+            oe_heap_profile_destroy();
+
 #if defined(OE_USE_DEBUG_MALLOC)
 
             /* If memory still allocated, print a trace and return an error */
@@ -409,6 +495,9 @@ static void _handle_ecall(
 
 #endif /* defined(OE_USE_DEBUG_MALLOC) */
 
+            /* Nothing allocates from the heap after this point */
+            oe_allocator_cleanup();
+
             break;
         }
         case OE_ECALL_VIRTUAL_EXCEPTION_HANDLER:
@@ -567,7 +656,7 @@ oe_result_t oe_call_host_function_by_table_id(
 
     /* Initialize the arguments */
     args = switchless ? oe_shm_calloc(sizeof(*args))
-                      : oe_host_calloc(1, sizeof(*args));
+                      : oe_allocate_ocall_buffer(sizeof(*args));
 
     if (args == NULL)
     {
@@ -576,6 +665,8 @@ oe_result_t oe_call_host_function_by_table_id(
         OE_RAISE(OE_OUT_OF_MEMORY);
     }
 
+    memset(args, 0, sizeof(*args));
+
     args->table_id = table_id;
     args->function_id = function_id;
     args->input_buffer = input_buffer;
@@ -584,13 +675,19 @@ oe_result_t oe_call_host_function_by_table_id(
     args->output_buffer_size = output_buffer_size;
     args->result = OE_UNEXPECTED;
 
-    /* Call the host function with this address */
-    // TODO: for switchessless calls, push the job (wrapped in args) to an
-    // available worker thread, and wait for result
-    // if (!switchless)
+    /* Call the host function with this address. Switchless calls are handed
+     * to a host worker; fall back to a regular OCALL if none is available. */
+    if (switchless)
+        result = oe_post_switchless_ocall(args);
+
+    if (!switchless || result == OE_BUSY)
     {
         OE_CHECK(oe_ocall(OE_OCALL_CALL_HOST_FUNCTION, (uint64_t)args, NULL));
     }
+    else
+    {
+        OE_CHECK(result);
+    }
 
     /* Check the result */
     OE_CHECK(args->result);
@@ -599,9 +696,9 @@ oe_result_t oe_call_host_function_by_table_id(
     result = OE_OK;
 
 done:
-    if (!switchless)
+    if (!switchless && args)
     {
-        oe_host_free(args);
+        oe_free_ocall_buffer(args);
     }
 
     return result;
@@ -663,6 +760,151 @@ oe_result_t oe_switchless_call_host_function(
         true /* switchless */);
 }
 
+/*
+**==============================================================================
+**
+** oe_ocall_batch_begin()
+** oe_ocall_batch_add()
+** oe_ocall_batch_submit()
+**
+**     Run several independent host function calls with a single OCALL. The
+**     batch is marshaled into one host buffer holding a header followed by
+**     an array of oe_call_host_function_args_t; the host dispatches each
+**     entry in turn (see _handle_call_host_function_batch()).
+**
+**==============================================================================
+*/
+
+oe_result_t oe_ocall_batch_begin(oe_ocall_batch_t* batch)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!batch)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    batch->num_calls = 0;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_ocall_batch_add(
+    oe_ocall_batch_t* batch,
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t index;
+
+    if (!batch || !input_buffer || input_buffer_size == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* The host uses the buffers directly */
+    if (!oe_is_outside_enclave(input_buffer, input_buffer_size) ||
+        !oe_is_outside_enclave(output_buffer, output_buffer_size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((index = batch->num_calls) >= OE_OCALL_BATCH_MAX_CALLS)
+        OE_RAISE(OE_OUT_OF_BOUNDS);
+
+    batch->calls[index].function_id = function_id;
+    batch->calls[index].input_buffer = input_buffer;
+    batch->calls[index].input_buffer_size = input_buffer_size;
+    batch->calls[index].output_buffer = output_buffer;
+    batch->calls[index].output_buffer_size = output_buffer_size;
+    batch->calls[index].output_bytes_written = 0;
+    batch->calls[index].result = OE_UNEXPECTED;
+    batch->num_calls++;
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_ocall_batch_submit(oe_ocall_batch_t* batch)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_function_batch_args_t* args = NULL;
+    oe_call_host_function_args_t* calls;
+    size_t num_calls;
+    size_t size;
+
+    if (!batch || batch->num_calls > OE_OCALL_BATCH_MAX_CALLS)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if ((num_calls = batch->num_calls) == 0)
+    {
+        result = OE_OK;
+        goto done;
+    }
+
+    size = sizeof(*args) + num_calls * sizeof(*calls);
+
+    if (!(args = oe_allocate_ocall_buffer(size)))
+    {
+        /* Fail if the enclave is crashing. */
+        OE_CHECK(__oe_enclave_status);
+        OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    memset(args, 0, size);
+
+    /* Keep an enclave copy of the array address: the header is host memory */
+    calls = (oe_call_host_function_args_t*)(args + 1);
+    args->num_calls = num_calls;
+    args->calls = calls;
+
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        calls[i].table_id = OE_UINT64_MAX;
+        calls[i].function_id = batch->calls[i].function_id;
+        calls[i].input_buffer = batch->calls[i].input_buffer;
+        calls[i].input_buffer_size = batch->calls[i].input_buffer_size;
+        calls[i].output_buffer = batch->calls[i].output_buffer;
+        calls[i].output_buffer_size = batch->calls[i].output_buffer_size;
+        calls[i].result = OE_UNEXPECTED;
+    }
+
+    /* One transition for the whole batch */
+    OE_CHECK(oe_ocall(
+        OE_OCALL_CALL_HOST_FUNCTION_BATCH, (uint64_t)args, NULL));
+
+    /* The array is host memory: read each field once, and do not trust a
+     * byte count that exceeds the output buffer */
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        oe_result_t call_result = calls[i].result;
+        size_t bytes_written = 0;
+
+        if (call_result == OE_OK)
+        {
+            bytes_written = calls[i].output_bytes_written;
+
+            if (bytes_written > batch->calls[i].output_buffer_size)
+            {
+                call_result = OE_UNEXPECTED;
+                bytes_written = 0;
+            }
+        }
+
+        batch->calls[i].result = call_result;
+        batch->calls[i].output_bytes_written = bytes_written;
+    }
+
+    result = OE_OK;
+
+done:
+    if (args)
+        oe_free_ocall_buffer(args);
+
+    return result;
+}
+
 /*
 **==============================================================================
 **
@@ -1,21 +1,154 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include "hostcalls.h"
+#include <openenclave/bits/safemath.h>
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/edger8r/enclave.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/hostheap.h>
+#include <openenclave/internal/utils.h>
+#include "td.h"
 
-// Function used by oeedger8r for allocating ocall buffers. This function can be
-// optimized by allocating a buffer for making ocalls and pass it in to the
-// ecall and making it available for use here.
+/*
+**==============================================================================
+**
+** OCALL arenas
+**
+**     Every OCALL made through oeedger8r-generated code needs a host buffer
+**     for its marshaled parameters. Obtaining it with oe_host_malloc() and
+**     releasing it with oe_host_free() costs two more OCALLs. Instead, each
+**     thread allocates a block of host memory once and carves the buffers
+**     out of it. OCALL buffers are almost always released in reverse order
+**     of allocation, so the arena is a stack; a buffer released out of order
+**     is marked and reclaimed when the buffers above it are released.
+**
+**     The arena bookkeeping lives in enclave memory so that the host cannot
+**     influence where buffers are placed. Requests that do not fit fall back
+**     to oe_host_small_malloc().
+**
+**==============================================================================
+*/
+
+#define OE_OCALL_ARENA_SIZE (64 * 1024)
+#define OE_OCALL_ARENA_MAX_BLOCKS 8
+#define OE_OCALL_ARENA_ALIGNMENT 16
+
+typedef struct _oe_ocall_arena
+{
+    /* Host memory of OE_OCALL_ARENA_SIZE bytes */
+    uint8_t* base;
+
+    /* Bytes in use (the top of the stack) */
+    size_t used;
+
+    /* Live buffers, in allocation order */
+    struct
+    {
+        size_t offset;
+        bool freed;
+    } blocks[OE_OCALL_ARENA_MAX_BLOCKS];
+    size_t num_blocks;
+} oe_ocall_arena_t;
+
+static oe_ocall_arena_t* _get_ocall_arena(td_t* td)
+{
+    oe_ocall_arena_t* arena = td->ocall_arena;
+
+    if (arena)
+        return arena;
+
+    if (!(arena = (oe_ocall_arena_t*)oe_calloc(1, sizeof(*arena))))
+        return NULL;
+
+    /* oe_host_malloc() aborts if the host returns enclave memory */
+    if (!(arena->base = (uint8_t*)oe_host_malloc(OE_OCALL_ARENA_SIZE)))
+    {
+        oe_free(arena);
+        return NULL;
+    }
+
+    td->ocall_arena = arena;
+    td_register_caches(td);
+
+    return arena;
+}
+
+static bool _is_arena_buffer(oe_ocall_arena_t* arena, void* buffer)
+{
+    return arena && (uint8_t*)buffer >= arena->base &&
+           (uint8_t*)buffer < arena->base + OE_OCALL_ARENA_SIZE;
+}
+
+// Function used by oeedger8r for allocating ocall buffers.
 void* oe_allocate_ocall_buffer(size_t size)
 {
-    return oe_host_malloc(size);
+    oe_ocall_arena_t* arena = _get_ocall_arena(oe_get_td());
+    size_t aligned_size;
+    size_t used;
+
+    if (arena && arena->num_blocks < OE_OCALL_ARENA_MAX_BLOCKS &&
+        oe_safe_add_sizet(size, OE_OCALL_ARENA_ALIGNMENT - 1, &aligned_size) ==
+            OE_OK)
+    {
+        aligned_size &= ~(size_t)(OE_OCALL_ARENA_ALIGNMENT - 1);
+
+        if (oe_safe_add_sizet(arena->used, aligned_size, &used) == OE_OK &&
+            used <= OE_OCALL_ARENA_SIZE)
+        {
+            size_t offset = arena->used;
+
+            arena->blocks[arena->num_blocks].offset = offset;
+            arena->blocks[arena->num_blocks].freed = false;
+            arena->num_blocks++;
+            arena->used = used;
+
+            return arena->base + offset;
+        }
+    }
+
+    return oe_host_small_malloc(size);
 }
 
 // Function used by oeedger8r for freeing ocall buffers.
 void oe_free_ocall_buffer(void* buffer)
 {
-    oe_host_free(buffer);
+    oe_ocall_arena_t* arena = oe_get_td()->ocall_arena;
+
+    if (!_is_arena_buffer(arena, buffer))
+    {
+        oe_host_small_free(buffer);
+        return;
+    }
+
+    for (size_t i = arena->num_blocks; i > 0; i--)
+    {
+        if (arena->base + arena->blocks[i - 1].offset == buffer)
+        {
+            arena->blocks[i - 1].freed = true;
+            break;
+        }
+    }
+
+    /* Pop the released buffers off the top of the stack */
+    while (arena->num_blocks > 0 &&
+           arena->blocks[arena->num_blocks - 1].freed)
+    {
+        arena->num_blocks--;
+        arena->used = arena->blocks[arena->num_blocks].offset;
+    }
+}
+
+void oe_free_ocall_arena(td_t* td)
+{
+    oe_ocall_arena_t* arena = td->ocall_arena;
+
+    if (arena)
+    {
+        oe_host_free(arena->base);
+        oe_free(arena);
+        td->ocall_arena = NULL;
+    }
 }
 
 void* oe_reserve_shm(size_t capacity)
@@ -26,4 +159,4 @@ void* oe_reserve_shm(size_t capacity)
 void oe_unreserve_shm(void* buffer)
 {
     oe_host_free(buffer);
-}
\ No newline at end of file
+}
@@ -0,0 +1,12 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_CORE_SGX_HOSTCALLS_H
+#define _OE_CORE_SGX_HOSTCALLS_H
+
+#include <openenclave/internal/sgxtypes.h>
+
+// Release the OCALL arena of the given thread (see td_t.ocall_arena).
+void oe_free_ocall_arena(td_t* td);
+
+#endif /* _OE_CORE_SGX_HOSTCALLS_H */
@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/parallel.h>
+#include "sgx_t.h"
+
+/*
+**==============================================================================
+**
+** oe_sgx_parallel_worker_ecall()
+**
+**     Entry point of a host thread donated to the parallel runtime when the
+**     enclave was created. The thread keeps its TCS until the host calls
+**     oe_sgx_stop_parallel_workers_ecall() before terminating the enclave.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_parallel_worker_ecall(void)
+{
+    return oe_run_parallel_worker();
+}
+
+oe_result_t oe_sgx_stop_parallel_workers_ecall(void)
+{
+    oe_stop_parallel_workers();
+    return OE_OK;
+}
@@ -0,0 +1,190 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "switchless.h"
+#include <openenclave/bits/safemath.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/calls.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/switchless.h>
+#include <openenclave/internal/utils.h>
+#include "../shm.h"
+#include "sgx_t.h"
+
+/* Contexts of the host workers that service switchless OCALLs (in host
+ * memory). Published once by oe_sgx_init_switchless_host_workers_ecall(). */
+static oe_host_worker_context_t* _host_worker_contexts;
+static size_t _num_host_workers;
+static uint64_t _next_host_worker;
+
+/*
+**==============================================================================
+**
+** oe_sgx_switchless_enclave_worker_thread_ecall()
+**
+**     Entry point of a switchless enclave worker. The host thread stays in
+**     this ECALL and services the calls posted to its context until the host
+**     stops it. The context lives in host memory and is read fresh on every
+**     access; the posted args are validated by
+**     oe_handle_call_enclave_function() like those of a regular ECALL.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_switchless_enclave_worker_thread_ecall(
+    oe_enclave_worker_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t idle_spins = 0;
+
+    if (!context || !oe_is_outside_enclave(context, sizeof(*context)))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    while (!oe_atomic_load_u32(&context->is_stopping))
+    {
+        oe_call_enclave_function_args_t* args =
+            (oe_call_enclave_function_args_t*)oe_atomic_load_ptr(
+                (void* volatile*)&context->call_arg);
+
+        if (args)
+        {
+            oe_result_t call_result =
+                oe_handle_call_enclave_function((uint64_t)args);
+
+            /* Regular ECALLs report dispatch failures through the ERET
+             * argument; workers report them through the args structure. */
+            if (call_result != OE_OK &&
+                oe_is_outside_enclave(args, sizeof(*args)))
+                args->result = call_result;
+
+            /* Release buffers of switchless OCALLs made by the function */
+            oe_shm_clear();
+
+            /* Complete the handshake with the caller */
+            oe_atomic_store_ptr((void* volatile*)&context->call_arg, NULL);
+            idle_spins = 0;
+        }
+        else if (++idle_spins < OE_SWITCHLESS_WORKER_SPIN_COUNT)
+        {
+            OE_CPU_RELAX();
+        }
+        else
+        {
+            /* Returns once a call is posted or the worker is stopped */
+            if (oe_sgx_sleep_switchless_worker_ocall(context) != OE_OK)
+                OE_RAISE(OE_FAILURE);
+
+            idle_spins = 0;
+        }
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_sgx_init_switchless_host_workers_ecall()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_init_switchless_host_workers_ecall(
+    oe_host_worker_context_t* contexts,
+    size_t num_contexts)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    size_t size;
+
+    if (!contexts || num_contexts == 0)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_safe_mul_sizet(num_contexts, sizeof(*contexts), &size));
+
+    if (!oe_is_outside_enclave(contexts, size))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* The host workers can only be set up once */
+    if (oe_atomic_load_ptr((void* volatile*)&_host_worker_contexts))
+        OE_RAISE(OE_UNEXPECTED);
+
+    /* Publish the count before the contexts */
+    _num_host_workers = num_contexts;
+    oe_atomic_store_ptr((void* volatile*)&_host_worker_contexts, contexts);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_post_switchless_ocall()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args)
+{
+    oe_host_worker_context_t* contexts;
+    oe_host_worker_context_t* context = NULL;
+    size_t num_workers;
+    uint64_t start;
+
+    contexts = (oe_host_worker_context_t*)oe_atomic_load_ptr(
+        (void* volatile*)&_host_worker_contexts);
+
+    if (!contexts)
+        return OE_BUSY;
+
+    num_workers = _num_host_workers;
+
+    /* Spread callers over the workers, then try each worker at most once */
+    start = oe_atomic_increment(&_next_host_worker);
+
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        oe_host_worker_context_t* candidate =
+            &contexts[(start + i) % num_workers];
+
+        if (candidate->call_arg == NULL &&
+            !oe_atomic_load_u32(&candidate->is_stopping) &&
+            oe_atomic_compare_and_swap_ptr(
+                (void* volatile*)&candidate->call_arg, NULL, args))
+        {
+            context = candidate;
+            break;
+        }
+    }
+
+    if (!context)
+        return OE_BUSY;
+
+    /* A sleeping worker can only be woken with a (one-off) OCALL. If even
+     * that fails, take the call back unless the worker already has it. */
+    if (oe_atomic_load_u32(&context->is_sleeping) &&
+        oe_sgx_wake_switchless_worker_ocall(context) != OE_OK &&
+        oe_atomic_compare_and_swap_ptr(
+            (void* volatile*)&context->call_arg, args, NULL))
+        return OE_BUSY;
+
+    /* The worker clears its slot once the call has completed */
+    while (oe_atomic_load_ptr((void* volatile*)&context->call_arg) == args)
+    {
+        /* The worker exited without picking up the call */
+        if (oe_atomic_load_u32(&context->is_stopping) &&
+            oe_atomic_compare_and_swap_ptr(
+                (void* volatile*)&context->call_arg, args, NULL))
+            return OE_BUSY;
+
+        OE_CPU_RELAX();
+    }
+
+    return OE_OK;
+}
@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_CORE_SGX_SWITCHLESS_H
+#define _OE_CORE_SGX_SWITCHLESS_H
+
+#include <openenclave/bits/result.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/calls.h>
+
+// Dispatch the oe_call_enclave_function_args_t at the given host address to
+// its ECALL. Used by regular ECALLs and by the switchless enclave workers.
+oe_result_t oe_handle_call_enclave_function(uint64_t arg_in);
+
+// Hand the OCALL to an idle host worker and spin until it completes. Returns
+// OE_BUSY if no worker accepted the call, in which case the caller falls back
+// to a regular OCALL.
+oe_result_t oe_post_switchless_ocall(oe_call_host_function_args_t* args);
+
+#endif /* _OE_CORE_SGX_SWITCHLESS_H */
@@ -3,14 +3,17 @@
 
 #include "td.h"
 #include <openenclave/bits/safecrt.h>
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/fault.h>
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/sgxtypes.h>
+#include <openenclave/internal/thread.h>
 #include <openenclave/internal/utils.h>
 #include "asmdefs.h"
+#include "hostcalls.h"
 #include "thread.h"
 
 #if __linux__
@@ -310,3 +313,67 @@ void td_clear(td_t* td)
 
     /* Never clear td_t.initialized nor host registers */
 }
+
+/*
+**==============================================================================
+**
+** td_register_caches()
+**
+**     Record a td_t that caches per-thread resources (td_t.ecall_buffer,
+**     td_t.ocall_arena), so that td_free_caches() can release them. Unlike
+**     thread-local variables, these survive td_clear().
+**
+**==============================================================================
+*/
+
+static td_t* _cache_owners[OE_SGX_MAX_TCS];
+static oe_spinlock_t _cache_owners_lock = OE_SPINLOCK_INITIALIZER;
+
+void td_register_caches(td_t* td)
+{
+    size_t i;
+
+    oe_spin_lock(&_cache_owners_lock);
+
+    for (i = 0; i < OE_SGX_MAX_TCS && _cache_owners[i]; i++)
+    {
+        if (_cache_owners[i] == td)
+            break;
+    }
+
+    if (i < OE_SGX_MAX_TCS)
+        _cache_owners[i] = td;
+
+    oe_spin_unlock(&_cache_owners_lock);
+}
+
+/*
+**==============================================================================
+**
+** td_free_caches()
+**
+**     Release the per-thread resources of all registered td_t's. Called by
+**     the enclave destructor, when no other ECALLs are in progress.
+**
+**==============================================================================
+*/
+
+void td_free_caches(void)
+{
+    oe_spin_lock(&_cache_owners_lock);
+
+    for (size_t i = 0; i < OE_SGX_MAX_TCS && _cache_owners[i]; i++)
+    {
+        td_t* td = _cache_owners[i];
+
+        oe_free(td->ecall_buffer);
+        td->ecall_buffer = NULL;
+        td->ecall_buffer_size = 0;
+
+        oe_free_ocall_arena(td);
+
+        _cache_owners[i] = NULL;
+    }
+
+    oe_spin_unlock(&_cache_owners_lock);
+}
@@ -76,4 +76,8 @@ void td_clear(td_t* td);
 
 bool td_initialized(td_t* td);
 
+void td_register_caches(td_t* td);
+
+void td_free_caches(void);
+
 #endif /* _TD_H */
@@ -9,6 +9,7 @@
 #include <openenclave/internal/raise.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
 #include "sgx_t.h"
 #include "td.h"
 
@@ -56,6 +57,55 @@ done:
     return ret;
 }
 
+/* Wake the waiter (if any) and wait until woken or the deadline passes.
+ * Returns OE_TIMEDOUT if the deadline passed first. */
+static oe_result_t _thread_timedwait(
+    oe_thread_data_t* waiter,
+    oe_thread_data_t* self,
+    uint64_t deadline)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    uint64_t waiter_tcs = waiter ? (uint64_t)td_to_tcs((td_t*)waiter) : 0;
+    uint64_t self_tcs = (uint64_t)td_to_tcs((td_t*)self);
+
+    if (oe_thread_timedwait_ocall(
+            &result, oe_get_enclave(), waiter_tcs, self_tcs, deadline) !=
+        OE_OK)
+        return OE_FAILURE;
+
+    return result;
+}
+
+/* Wake all threads of a list linked through their next fields, with as few
+ * OCALLs as possible. The list must not be used afterwards, since the woken
+ * threads may reuse their next fields. */
+static int _thread_wake_list(oe_thread_data_t* list)
+{
+    int ret = 0;
+
+    if (list && !list->next)
+        return _thread_wake(list);
+
+    while (list)
+    {
+        uint64_t tcs[OE_SGX_MAX_TCS];
+        size_t num_tcs = 0;
+
+        /* Read each next field before the thread can be woken */
+        while (list && num_tcs < OE_COUNTOF(tcs))
+        {
+            tcs[num_tcs++] = (uint64_t)td_to_tcs((td_t*)list);
+            list = list->next;
+        }
+
+        if (oe_thread_wake_multiple_ocall(oe_get_enclave(), tcs, num_tcs) !=
+            OE_OK)
+            ret = -1;
+    }
+
+    return ret;
+}
+
 /*
 **==============================================================================
 **
@@ -110,11 +160,152 @@ static bool _queue_contains(Queue* queue, oe_thread_data_t* thread)
     return false;
 }
 
+static void _queue_remove(Queue* queue, oe_thread_data_t* thread)
+{
+    oe_thread_data_t* prev = NULL;
+
+    for (oe_thread_data_t* p = queue->front; p; prev = p, p = p->next)
+    {
+        if (p == thread)
+        {
+            if (prev)
+                prev->next = p->next;
+            else
+                queue->front = p->next;
+
+            if (queue->back == p)
+                queue->back = prev;
+
+            return;
+        }
+    }
+}
+
 static __inline__ bool _queue_empty(Queue* queue)
 {
     return queue->front ? false : true;
 }
 
+/*
+**==============================================================================
+**
+** Spinning:
+**
+**     Waking a thread blocked in the host costs an OCALL for the waker and
+**     another for the waiter, each tens of microseconds, while locks are
+**     typically held for a few microseconds. So a thread that has to wait
+**     first spins for a bounded time, with its wait_state set to
+**     WAIT_STATE_SPINNING, before blocking in the host. A thread that
+**     selects a spinning waiter sets its state to WAIT_STATE_WOKEN instead of
+**     performing the wake OCALL. Both sides update wait_state under the lock
+**     of the object waited on, so a waiter either sees WAIT_STATE_WOKEN or
+**     gets a wake OCALL, never neither.
+**
+**     The spin limit is tuned per object: it tracks how long waiters had to
+**     spin before being selected, and shrinks when spinning fails, so that
+**     objects that are held for long (e.g. across OCALLs) quickly stop
+**     spinning.
+**
+**==============================================================================
+*/
+
+#define WAIT_STATE_RUNNING 0
+#define WAIT_STATE_SPINNING 1
+#define WAIT_STATE_WOKEN 2
+
+/* Bounds of the spin limit, in pause instructions */
+#define MIN_SPINS 32
+#define MAX_SPINS 1024
+
+static uint32_t _spin_limit(uint32_t estimate)
+{
+    const uint32_t limit = MIN_SPINS + 2 * estimate;
+    return limit < MAX_SPINS ? limit : MAX_SPINS;
+}
+
+/* Caller holds the lock of the object that the estimate belongs to */
+static void _update_spin_estimate(uint32_t* estimate, uint32_t spins, bool ok)
+{
+    if (ok)
+        *estimate = (uint32_t)((int64_t)*estimate +
+                               ((int64_t)spins - (int64_t)*estimate) / 8);
+    else
+        *estimate /= 2;
+}
+
+/* Spin until selected or for at most limit iterations; returns the number of
+ * iterations */
+static uint32_t _spin_wait(oe_thread_data_t* self, uint32_t limit)
+{
+    td_t* td = (td_t*)self;
+    uint32_t spins = 0;
+
+    while (spins < limit && td->wait_state == WAIT_STATE_SPINNING)
+    {
+        OE_CPU_RELAX();
+        spins++;
+    }
+
+    return spins;
+}
+
+/* Caller holds the lock of the object that selected the waiter. Returns
+ * whether the waiter still has to be woken by an OCALL. */
+static bool _select_waiter(oe_thread_data_t* waiter)
+{
+    td_t* td = (td_t*)waiter;
+
+    if (td->wait_state == WAIT_STATE_SPINNING)
+    {
+        td->wait_state = WAIT_STATE_WOKEN;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+**==============================================================================
+**
+** Mutex wait list:
+**
+**     Like Queue, but without a back pointer, which leaves room for the spin
+**     estimate in oe_mutex_t. Wait lists are bounded by the number of TCSs.
+**
+**==============================================================================
+*/
+
+static void _list_push_back(oe_thread_data_t** list, oe_thread_data_t* thread)
+{
+    thread->next = NULL;
+
+    while (*list)
+        list = &(*list)->next;
+
+    *list = thread;
+}
+
+static oe_thread_data_t* _list_pop_front(oe_thread_data_t** list)
+{
+    oe_thread_data_t* thread = *list;
+
+    if (thread)
+        *list = thread->next;
+
+    return thread;
+}
+
+static bool _list_contains(oe_thread_data_t* list, oe_thread_data_t* thread)
+{
+    for (oe_thread_data_t* p = list; p; p = p->next)
+    {
+        if (p == thread)
+            return true;
+    }
+
+    return false;
+}
+
 /*
 **==============================================================================
 **
@@ -153,8 +344,11 @@ typedef struct _oe_mutex_impl
     /* The thread that has locked this mutex */
     oe_thread_data_t* owner;
 
-    /* Queue of waiting threads (front holds the mutex) */
-    Queue queue;
+    /* List of waiting threads (front holds the mutex) */
+    oe_thread_data_t* queue;
+
+    /* Number of spins waiters recently needed to obtain the mutex */
+    uint32_t spin_estimate;
 } oe_mutex_impl_t;
 
 OE_STATIC_ASSERT(sizeof(oe_mutex_impl_t) <= sizeof(oe_mutex_t));
@@ -190,7 +384,7 @@ static int _mutex_lock(oe_mutex_impl_t* m, oe_thread_data_t* self)
     if (m->owner == NULL)
     {
         /* If the waiters queue is empty */
-        if (m->queue.front == NULL)
+        if (m->queue == NULL)
         {
             /* Obtain the mutex */
             m->owner = self;
@@ -199,10 +393,10 @@ static int _mutex_lock(oe_mutex_impl_t* m, oe_thread_data_t* self)
         }
 
         /* If this thread is at the front of the waiters queue */
-        if (m->queue.front == self)
+        if (m->queue == self)
         {
             /* Remove this thread from front of the waiters queue */
-            _queue_pop_front(&m->queue);
+            _list_pop_front(&m->queue);
 
             /* Obtain the mutex */
             m->owner = self;
@@ -219,35 +413,61 @@ oe_result_t oe_mutex_lock(oe_mutex_t* mutex)
     oe_mutex_impl_t* m = (oe_mutex_impl_t*)mutex;
     oe_thread_data_t* self = oe_get_thread_data();
 
+    bool spun = false;
+
     if (!m)
         return OE_INVALID_PARAMETER;
 
+    oe_spin_lock(&m->lock);
+
     /* Loop until SELF obtains mutex */
     for (;;)
     {
-        oe_spin_lock(&m->lock);
+        /* Attempt to acquire lock */
+        if (_mutex_lock(m, self) == 0)
+            break;
+
+        /* If the waiters queue does not contain this thread */
+        if (!_list_contains(m->queue, self))
         {
-            /* Attempt to acquire lock */
-            if (_mutex_lock(m, self) == 0)
-            {
-                oe_spin_unlock(&m->lock);
-                return OE_OK;
-            }
+            /* Insert thread at back of waiters queue */
+            _list_push_back(&m->queue, self);
+        }
 
-            /* If the waiters queue does not contain this thread */
-            if (!_queue_contains(&m->queue, self))
-            {
-                /* Insert thread at back of waiters queue */
-                _queue_push_back(&m->queue, self);
-            }
+        /* Spin once before blocking in the host */
+        if (!spun)
+        {
+            const uint32_t limit = _spin_limit(m->spin_estimate);
+            uint32_t spins;
+            bool ok;
+
+            ((td_t*)self)->wait_state = WAIT_STATE_SPINNING;
+            oe_spin_unlock(&m->lock);
+
+            spins = _spin_wait(self, limit);
+
+            oe_spin_lock(&m->lock);
+            ((td_t*)self)->wait_state = WAIT_STATE_RUNNING;
+            spun = true;
+
+            ok = _mutex_lock(m, self) == 0;
+            _update_spin_estimate(&m->spin_estimate, spins, ok);
+
+            if (ok)
+                break;
         }
+
         oe_spin_unlock(&m->lock);
 
         /* Ask host to wait for an event on this thread */
         _thread_wait(self);
+
+        oe_spin_lock(&m->lock);
     }
 
-    /* Unreachable! */
+    oe_spin_unlock(&m->lock);
+
+    return OE_OK;
 }
 
 oe_result_t oe_mutex_trylock(oe_mutex_t* mutex)
@@ -289,8 +509,10 @@ static int _mutex_unlock(oe_mutex_t* mutex, oe_thread_data_t** waiter)
                 /* Thread no longer has this mutex locked */
                 m->owner = NULL;
 
-                /* Set waiter to the next thread on the queue (maybe none) */
-                *waiter = m->queue.front;
+                /* Set waiter to the next thread on the queue (maybe none),
+                 * unless it is still spinning and will notice by itself */
+                if (m->queue && _select_waiter(m->queue))
+                    *waiter = m->queue;
             }
 
             ret = 0;
@@ -331,7 +553,7 @@ oe_result_t oe_mutex_destroy(oe_mutex_t* mutex)
 
     oe_spin_lock(&m->lock);
     {
-        if (_queue_empty(&m->queue))
+        if (m->queue == NULL)
         {
             memset(m, 0, sizeof(oe_mutex_t));
             result = OE_OK;
@@ -362,6 +584,9 @@ typedef struct _oe_cond_impl
         oe_thread_data_t* front;
         oe_thread_data_t* back;
     } queue;
+
+    /* Number of spins waiters recently needed to be signaled */
+    uint32_t spin_estimate;
 } oe_cond_impl_t;
 
 OE_STATIC_ASSERT(sizeof(oe_cond_impl_t) <= sizeof(oe_cond_t));
@@ -403,13 +628,14 @@ oe_result_t oe_cond_destroy(oe_cond_t* condition)
     return OE_OK;
 }
 
-oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
+/* Wait without a deadline if deadline is null */
+static oe_result_t _cond_wait(
+    oe_cond_impl_t* cond,
+    oe_mutex_t* mutex,
+    const uint64_t* deadline)
 {
-    oe_cond_impl_t* cond = (oe_cond_impl_t*)condition;
     oe_thread_data_t* self = oe_get_thread_data();
-
-    if (!cond || !mutex)
-        return OE_INVALID_PARAMETER;
+    oe_result_t result = OE_OK;
 
     oe_spin_lock(&cond->lock);
     {
@@ -425,11 +651,41 @@ oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
             return OE_BUSY;
         }
 
-        for (;;)
+        /* Spin before blocking in the host, unless a blocked thread has to
+         * be woken to take over the mutex: _thread_wake_wait() does both in
+         * a single OCALL. */
+        if (!waiter)
         {
+            const uint32_t limit = _spin_limit(cond->spin_estimate);
+            uint32_t spins;
+
+            ((td_t*)self)->wait_state = WAIT_STATE_SPINNING;
+            oe_spin_unlock(&cond->lock);
+
+            spins = _spin_wait(self, limit);
+
+            oe_spin_lock(&cond->lock);
+            ((td_t*)self)->wait_state = WAIT_STATE_RUNNING;
+
+            _update_spin_estimate(
+                &cond->spin_estimate,
+                spins,
+                !_queue_contains((Queue*)&cond->queue, self));
+        }
+
+        /* If self is no longer in the queue, then it was selected */
+        while (_queue_contains((Queue*)&cond->queue, self))
+        {
+            oe_result_t wait_result = OE_OK;
+
             oe_spin_unlock(&cond->lock);
             {
-                if (waiter)
+                if (deadline)
+                {
+                    wait_result = _thread_timedwait(waiter, self, *deadline);
+                    waiter = NULL;
+                }
+                else if (waiter)
                 {
                     _thread_wake_wait(waiter, self);
                     waiter = NULL;
@@ -441,15 +697,45 @@ oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
             }
             oe_spin_lock(&cond->lock);
 
-            /* If self is no longer in the queue, then it was selected */
-            if (!_queue_contains((Queue*)&cond->queue, self))
-                break;
+            /* A thread that was selected as the deadline passed has been
+             * (or is about to be) woken; its wait succeeds, and the wake
+             * makes a later wait of this thread return early, which every
+             * waiter tolerates by checking its condition again. */
+            if (wait_result == OE_TIMEDOUT &&
+                _queue_contains((Queue*)&cond->queue, self))
+            {
+                _queue_remove((Queue*)&cond->queue, self);
+                result = OE_TIMEDOUT;
+            }
         }
     }
     oe_spin_unlock(&cond->lock);
     oe_mutex_lock(mutex);
 
-    return OE_OK;
+    return result;
+}
+
+oe_result_t oe_cond_wait(oe_cond_t* condition, oe_mutex_t* mutex)
+{
+    oe_cond_impl_t* cond = (oe_cond_impl_t*)condition;
+
+    if (!cond || !mutex)
+        return OE_INVALID_PARAMETER;
+
+    return _cond_wait(cond, mutex, NULL);
+}
+
+oe_result_t oe_cond_timedwait(
+    oe_cond_t* condition,
+    oe_mutex_t* mutex,
+    uint64_t deadline)
+{
+    oe_cond_impl_t* cond = (oe_cond_impl_t*)condition;
+
+    if (!cond || !mutex)
+        return OE_INVALID_PARAMETER;
+
+    return _cond_wait(cond, mutex, &deadline);
 }
 
 oe_result_t oe_cond_signal(oe_cond_t* condition)
@@ -462,6 +748,9 @@ oe_result_t oe_cond_signal(oe_cond_t* condition)
 
     oe_spin_lock(&cond->lock);
     waiter = _queue_pop_front((Queue*)&cond->queue);
+
+    if (waiter && !_select_waiter(waiter))
+        waiter = NULL;
     oe_spin_unlock(&cond->lock);
 
     if (!waiter)
@@ -483,20 +772,17 @@ oe_result_t oe_cond_broadcast(oe_cond_t* condition)
     {
         oe_thread_data_t* p;
 
+        /* Spinning waiters notice by themselves */
         while ((p = _queue_pop_front((Queue*)&cond->queue)))
-            _queue_push_back(&waiters, p);
+        {
+            if (_select_waiter(p))
+                _queue_push_back(&waiters, p);
+        }
     }
     oe_spin_unlock(&cond->lock);
 
-    oe_thread_data_t* p_next = NULL;
-    for (oe_thread_data_t* p = waiters.front; p; p = p_next)
-    {
-        // p could wake up and immediately use a synchronization
-        // primitive that could modify the next field.
-        // Therefore fetch the next thread before waking up p.
-        p_next = p->next;
-        _thread_wake(p);
-    }
+    /* Wake all remaining waiters with a single OCALL */
+    _thread_wake_list(waiters.front);
 
     return OE_OK;
 }
@@ -617,10 +903,10 @@ static oe_result_t _wake_waiters(oe_rwlock_impl_t* rw_lock)
     // ownership of the rw_lock.
     oe_spin_unlock(&rw_lock->lock);
 
-    // Wake the waiters in FIFO order. However actual acquisition of the lock
-    // will be dependent on OS scheduling of the threads.
-    while ((p = _queue_pop_front(&waiters)))
-        _thread_wake(p);
+    // Wake the waiters in FIFO order, with a single OCALL. However actual
+    // acquisition of the lock will be dependent on OS scheduling of the
+    // threads.
+    _thread_wake_list(waiters.front);
 
     return OE_OK;
 }
@@ -0,0 +1,259 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/thread.h>
+#include "sgx_t.h"
+
+/*
+**==============================================================================
+**
+** Enclave-created threads:
+**
+**     oe_thread_create() queues a handle on the pending list and asks the
+**     host to spawn a thread, which enters the enclave through
+**     oe_sgx_thread_start_ecall() with the address of the handle. The host
+**     may pass any value back, so the ECALL only accepts handles that it
+**     finds on the pending list, and takes them off the list so that each
+**     handle is started at most once.
+**
+**     Joining waits on the condition variable of the handle until the start
+**     routine has returned. The handle is released by whichever of
+**     oe_thread_join(), oe_thread_detach() and the finishing thread comes
+**     last.
+**
+**==============================================================================
+*/
+
+struct _oe_thread_handle
+{
+    /* Link of the pending list, until the thread starts */
+    struct _oe_thread_handle* next;
+
+    void* (*start_routine)(void*);
+    void* arg;
+    void* retval;
+
+    /* Protects the fields below */
+    oe_mutex_t mutex;
+
+    /* Broadcast when the start routine returns */
+    oe_cond_t cond;
+
+    bool done;
+    bool detached;
+};
+
+static oe_spinlock_t _pending_lock = OE_SPINLOCK_INITIALIZER;
+static struct _oe_thread_handle* _pending;
+
+/* Set by oe_sgx_notify_termination_ecall() */
+static volatile bool _terminating;
+
+static void _push_pending(struct _oe_thread_handle* handle)
+{
+    oe_spin_lock(&_pending_lock);
+    handle->next = _pending;
+    _pending = handle;
+    oe_spin_unlock(&_pending_lock);
+}
+
+/* Remove the handle from the pending list, if it is still there */
+static bool _remove_pending(struct _oe_thread_handle* handle)
+{
+    bool found = false;
+
+    oe_spin_lock(&_pending_lock);
+    {
+        struct _oe_thread_handle** p;
+
+        for (p = &_pending; *p; p = &(*p)->next)
+        {
+            if (*p == handle)
+            {
+                *p = handle->next;
+                handle->next = NULL;
+                found = true;
+                break;
+            }
+        }
+    }
+    oe_spin_unlock(&_pending_lock);
+
+    return found;
+}
+
+static void _free_handle(struct _oe_thread_handle* handle)
+{
+    oe_cond_destroy(&handle->cond);
+    oe_mutex_destroy(&handle->mutex);
+    oe_free(handle);
+}
+
+oe_result_t oe_thread_create(
+    oe_thread_handle_t* thread,
+    void* (*start_routine)(void*),
+    void* arg)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+    struct _oe_thread_handle* handle = NULL;
+
+    if (thread)
+        *thread = NULL;
+
+    if (!thread || !start_routine)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(handle = oe_calloc(1, sizeof(*handle))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    handle->start_routine = start_routine;
+    handle->arg = arg;
+    oe_mutex_init(&handle->mutex);
+    oe_cond_init(&handle->cond);
+
+    _push_pending(handle);
+
+    if (oe_sgx_thread_create_ocall(
+            &retval, oe_get_enclave(), (uint64_t)handle) != OE_OK)
+        retval = OE_FAILURE;
+
+    /* A thread that already started owns the handle, whatever the host
+     * reported */
+    if (retval != OE_OK && _remove_pending(handle))
+        OE_RAISE_NO_TRACE(retval);
+
+    *thread = handle;
+    handle = NULL;
+    result = OE_OK;
+
+done:
+
+    if (handle)
+        _free_handle(handle);
+
+    return result;
+}
+
+oe_result_t oe_thread_join(oe_thread_handle_t thread, void** retval)
+{
+    struct _oe_thread_handle* handle = thread;
+
+    if (!handle)
+        return OE_INVALID_PARAMETER;
+
+    oe_mutex_lock(&handle->mutex);
+    {
+        if (handle->detached)
+        {
+            oe_mutex_unlock(&handle->mutex);
+            return OE_INVALID_PARAMETER;
+        }
+
+        while (!handle->done)
+            oe_cond_wait(&handle->cond, &handle->mutex);
+
+        if (retval)
+            *retval = handle->retval;
+    }
+    oe_mutex_unlock(&handle->mutex);
+
+    _free_handle(handle);
+
+    return OE_OK;
+}
+
+oe_result_t oe_thread_detach(oe_thread_handle_t thread)
+{
+    struct _oe_thread_handle* handle = thread;
+    bool done;
+
+    if (!handle)
+        return OE_INVALID_PARAMETER;
+
+    oe_mutex_lock(&handle->mutex);
+    {
+        if (handle->detached)
+        {
+            oe_mutex_unlock(&handle->mutex);
+            return OE_INVALID_PARAMETER;
+        }
+
+        handle->detached = true;
+        done = handle->done;
+    }
+    oe_mutex_unlock(&handle->mutex);
+
+    /* Otherwise the thread releases the handle when it finishes */
+    if (done)
+        _free_handle(handle);
+
+    return OE_OK;
+}
+
+/*
+**==============================================================================
+**
+** oe_sgx_thread_start_ecall()
+**
+**     Entry point of the host thread spawned for oe_thread_create(). The
+**     thread-specific data of the thread is destructed when this ECALL, its
+**     outermost one, returns.
+**
+**==============================================================================
+*/
+
+oe_result_t oe_sgx_thread_start_ecall(uint64_t arg)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    struct _oe_thread_handle* handle = (struct _oe_thread_handle*)arg;
+    void* retval;
+    bool detached;
+
+    /* Do not touch the handle unless this enclave queued it */
+    if (!_remove_pending(handle))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    retval = handle->start_routine(handle->arg);
+
+    oe_mutex_lock(&handle->mutex);
+    {
+        handle->retval = retval;
+        handle->done = true;
+        detached = handle->detached;
+        oe_cond_broadcast(&handle->cond);
+    }
+    oe_mutex_unlock(&handle->mutex);
+
+    if (detached)
+        _free_handle(handle);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_sgx_notify_termination_ecall()
+**
+**     Called by oe_terminate_enclave() while threads created here are still
+**     running, before it waits for them to return.
+**
+**==============================================================================
+*/
+
+void oe_sgx_notify_termination_ecall(void)
+{
+    _terminating = true;
+}
+
+bool oe_is_enclave_terminating(void)
+{
+    return _terminating;
+}
@@ -3,6 +3,10 @@
 
 #include <openenclave/host.h>
 #include <openenclave/internal/raise.h>
+#include <stdlib.h>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
 
 #include "calls.h"
 
@@ -50,7 +54,17 @@ done:
 **==============================================================================
 */
 
-oe_result_t oe_call_enclave_function_by_table_id(
+/* Give the threads that hold the TCSs of the enclave time to release one */
+static void _wait_for_tcs(void)
+{
+#if defined(_WIN32)
+    Sleep(1);
+#else
+    usleep(1000);
+#endif
+}
+
+static oe_result_t _call_enclave_function(
     oe_enclave_t* enclave,
     uint64_t table_id,
     uint64_t function_id,
@@ -58,7 +72,8 @@ oe_result_t oe_call_enclave_function_by_table_id(
     size_t input_buffer_size,
     void* output_buffer,
     size_t output_buffer_size,
-    size_t* output_bytes_written)
+    size_t* output_bytes_written,
+    bool wait_for_tcs)
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_call_enclave_function_args_t args;
@@ -79,15 +94,26 @@ oe_result_t oe_call_enclave_function_by_table_id(
         args.result = OE_UNEXPECTED;
     }
 
-    /* Perform the ECALL */
+    /* Perform the ECALL. oe_ecall() fails with OE_OUT_OF_THREADS only if no
+     * TCS was free, so the ECALL can be retried. */
     {
         uint64_t arg_out = 0;
 
-        OE_CHECK(oe_ecall(
-            enclave,
-            OE_ECALL_CALL_ENCLAVE_FUNCTION,
-            (uint64_t)&args,
-            &arg_out));
+        for (;;)
+        {
+            result = oe_ecall(
+                enclave,
+                OE_ECALL_CALL_ENCLAVE_FUNCTION,
+                (uint64_t)&args,
+                &arg_out);
+
+            if (result != OE_OUT_OF_THREADS || !wait_for_tcs)
+                break;
+
+            _wait_for_tcs();
+        }
+
+        OE_CHECK(result);
         OE_CHECK((oe_result_t)arg_out);
     }
 
@@ -101,6 +127,28 @@ done:
     return result;
 }
 
+oe_result_t oe_call_enclave_function_by_table_id(
+    oe_enclave_t* enclave,
+    uint64_t table_id,
+    uint64_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    size_t* output_bytes_written)
+{
+    return _call_enclave_function(
+        enclave,
+        table_id,
+        function_id,
+        input_buffer,
+        input_buffer_size,
+        output_buffer,
+        output_buffer_size,
+        output_bytes_written,
+        false);
+}
+
 /*
 **==============================================================================
 **
@@ -131,3 +179,373 @@ oe_result_t oe_call_enclave_function(
         output_buffer_size,
         output_bytes_written);
 }
+
+/*
+**==============================================================================
+**
+** oe_call_enclave_function_async()
+**
+**     Asynchronous ECALLs are queued on a per-enclave pool of host threads,
+**     sized by the TEE to the number of calls the enclave can run at once.
+**     Each thread takes the oldest queued call, performs it synchronously
+**     and reports its result. The threads share the TCSs with the
+**     application's own ECALLs, so a call that finds no free TCS waits for
+**     one instead of failing with OE_OUT_OF_THREADS.
+**
+**==============================================================================
+*/
+
+#if defined(_WIN32)
+typedef SRWLOCK _pool_lock_t;
+typedef CONDITION_VARIABLE _pool_cond_t;
+typedef HANDLE _pool_thread_t;
+#else
+typedef pthread_mutex_t _pool_lock_t;
+typedef pthread_cond_t _pool_cond_t;
+typedef pthread_t _pool_thread_t;
+#endif
+
+struct _oe_call_handle
+{
+    oe_async_call_pool_t* pool;
+    oe_call_handle_t* next;
+
+    uint32_t function_id;
+    const void* input_buffer;
+    size_t input_buffer_size;
+    void* output_buffer;
+    size_t output_buffer_size;
+    oe_call_completion_t completion;
+    void* completion_context;
+
+    /* False if no handle was returned, in which case the pool frees it */
+    bool has_waiter;
+
+    /* Set under the pool lock once the call has completed */
+    bool done;
+    oe_result_t result;
+    size_t output_bytes_written;
+};
+
+struct _oe_async_call_pool
+{
+    oe_enclave_t* enclave;
+
+    _pool_lock_t lock;
+    _pool_cond_t work_available;
+    _pool_cond_t call_completed;
+
+    /* Queued calls, oldest first */
+    oe_call_handle_t* head;
+    oe_call_handle_t* tail;
+
+    bool stopping;
+    size_t num_workers;
+    _pool_thread_t* workers;
+};
+
+static void _pool_lock(oe_async_call_pool_t* pool)
+{
+#if defined(_WIN32)
+    AcquireSRWLockExclusive(&pool->lock);
+#else
+    pthread_mutex_lock(&pool->lock);
+#endif
+}
+
+static void _pool_unlock(oe_async_call_pool_t* pool)
+{
+#if defined(_WIN32)
+    ReleaseSRWLockExclusive(&pool->lock);
+#else
+    pthread_mutex_unlock(&pool->lock);
+#endif
+}
+
+/* Wait on cond; the caller holds the pool lock */
+static void _pool_wait(oe_async_call_pool_t* pool, _pool_cond_t* cond)
+{
+#if defined(_WIN32)
+    SleepConditionVariableSRW(cond, &pool->lock, INFINITE, 0);
+#else
+    pthread_cond_wait(cond, &pool->lock);
+#endif
+}
+
+static void _pool_signal(_pool_cond_t* cond)
+{
+#if defined(_WIN32)
+    WakeConditionVariable(cond);
+#else
+    pthread_cond_signal(cond);
+#endif
+}
+
+static void _pool_broadcast(_pool_cond_t* cond)
+{
+#if defined(_WIN32)
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+static void _run_async_call(oe_call_handle_t* call)
+{
+    oe_async_call_pool_t* pool = call->pool;
+    oe_result_t result;
+    size_t output_bytes_written = 0;
+
+    result = _call_enclave_function(
+        pool->enclave,
+        OE_UINT64_MAX,
+        call->function_id,
+        call->input_buffer,
+        call->input_buffer_size,
+        call->output_buffer,
+        call->output_buffer_size,
+        &output_bytes_written,
+        true);
+
+    if (call->completion)
+        call->completion(
+            result, output_bytes_written, call->completion_context);
+
+    _pool_lock(pool);
+    {
+        if (call->has_waiter)
+        {
+            call->result = result;
+            call->output_bytes_written = output_bytes_written;
+            call->done = true;
+            _pool_broadcast(&pool->call_completed);
+        }
+        else
+        {
+            free(call);
+        }
+    }
+    _pool_unlock(pool);
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI _async_call_worker(LPVOID arg)
+#else
+static void* _async_call_worker(void* arg)
+#endif
+{
+    oe_async_call_pool_t* pool = (oe_async_call_pool_t*)arg;
+
+    for (;;)
+    {
+        oe_call_handle_t* call;
+
+        _pool_lock(pool);
+        {
+            while (!pool->head && !pool->stopping)
+                _pool_wait(pool, &pool->work_available);
+
+            /* Only stop once the queue has been drained */
+            if (!(call = pool->head))
+            {
+                _pool_unlock(pool);
+                break;
+            }
+
+            if (!(pool->head = call->next))
+                pool->tail = NULL;
+        }
+        _pool_unlock(pool);
+
+        _run_async_call(call);
+    }
+
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+oe_result_t oe_create_async_call_pool(
+    oe_enclave_t* enclave,
+    size_t num_workers,
+    oe_async_call_pool_t** pool_out)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_async_call_pool_t* pool = NULL;
+
+    if (pool_out)
+        *pool_out = NULL;
+
+    if (!enclave || num_workers == 0 || !pool_out)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(pool = (oe_async_call_pool_t*)calloc(1, sizeof(*pool))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (!(pool->workers =
+              (_pool_thread_t*)calloc(num_workers, sizeof(_pool_thread_t))))
+    {
+        free(pool);
+        OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    pool->enclave = enclave;
+
+#if defined(_WIN32)
+    InitializeSRWLock(&pool->lock);
+    InitializeConditionVariable(&pool->work_available);
+    InitializeConditionVariable(&pool->call_completed);
+#else
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    pthread_cond_init(&pool->call_completed, NULL);
+#endif
+
+    for (; pool->num_workers < num_workers; pool->num_workers++)
+    {
+        _pool_thread_t* thread = &pool->workers[pool->num_workers];
+
+#if defined(_WIN32)
+        if (!(*thread =
+                  CreateThread(NULL, 0, _async_call_worker, pool, 0, NULL)))
+            break;
+#else
+        if (pthread_create(thread, NULL, _async_call_worker, pool) != 0)
+            break;
+#endif
+    }
+
+    if (pool->num_workers == 0)
+    {
+        oe_destroy_async_call_pool(pool);
+        OE_RAISE(OE_FAILURE);
+    }
+
+    *pool_out = pool;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_destroy_async_call_pool(oe_async_call_pool_t* pool)
+{
+    if (!pool)
+        return;
+
+    _pool_lock(pool);
+    pool->stopping = true;
+    _pool_broadcast(&pool->work_available);
+    _pool_unlock(pool);
+
+    for (size_t i = 0; i < pool->num_workers; i++)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(pool->workers[i], INFINITE);
+        CloseHandle(pool->workers[i]);
+#else
+        pthread_join(pool->workers[i], NULL);
+#endif
+    }
+
+#if !defined(_WIN32)
+    pthread_cond_destroy(&pool->call_completed);
+    pthread_cond_destroy(&pool->work_available);
+    pthread_mutex_destroy(&pool->lock);
+#endif
+
+    free(pool->workers);
+    free(pool);
+}
+
+oe_result_t oe_call_enclave_function_async(
+    oe_enclave_t* enclave,
+    uint32_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_call_completion_t completion,
+    void* completion_context,
+    oe_call_handle_t** handle)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_async_call_pool_t* pool;
+    oe_call_handle_t* call;
+
+    if (handle)
+        *handle = NULL;
+
+    if (!enclave || (!completion && !handle))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(pool = oe_get_async_call_pool(enclave)))
+        OE_RAISE(OE_UNSUPPORTED);
+
+    if (!(call = (oe_call_handle_t*)calloc(1, sizeof(*call))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    call->pool = pool;
+    call->function_id = function_id;
+    call->input_buffer = input_buffer;
+    call->input_buffer_size = input_buffer_size;
+    call->output_buffer = output_buffer;
+    call->output_buffer_size = output_buffer_size;
+    call->completion = completion;
+    call->completion_context = completion_context;
+    call->has_waiter = handle != NULL;
+    call->result = OE_UNEXPECTED;
+
+    /* Set the handle first: a completion callback may already run before
+     * this function returns */
+    if (handle)
+        *handle = call;
+
+    _pool_lock(pool);
+    {
+        if (pool->tail)
+            pool->tail->next = call;
+        else
+            pool->head = call;
+
+        pool->tail = call;
+        _pool_signal(&pool->work_available);
+    }
+    _pool_unlock(pool);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_wait_enclave_function_async(
+    oe_call_handle_t* handle,
+    size_t* output_bytes_written)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_async_call_pool_t* pool;
+
+    if (!handle || !handle->has_waiter)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    pool = handle->pool;
+
+    _pool_lock(pool);
+    {
+        while (!handle->done)
+            _pool_wait(pool, &pool->call_completed);
+    }
+    _pool_unlock(pool);
+
+    if (output_bytes_written)
+        *output_bytes_written = handle->output_bytes_written;
+
+    result = handle->result;
+    free(handle);
+
+done:
+    return result;
+}
@@ -17,4 +17,20 @@ typedef struct _ocall_table
 
 extern ocall_table_t _ocall_tables[];
 
+/* Host threads that run the ECALLs of oe_call_enclave_function_async() for
+ * one enclave */
+typedef struct _oe_async_call_pool oe_async_call_pool_t;
+
+oe_result_t oe_create_async_call_pool(
+    oe_enclave_t* enclave,
+    size_t num_workers,
+    oe_async_call_pool_t** pool);
+
+/* Run the calls still queued, then stop the threads and free the pool */
+void oe_destroy_async_call_pool(oe_async_call_pool_t* pool);
+
+/* Implemented per TEE: return the pool of the enclave, creating it on first
+ * use, or NULL if asynchronous calls are not supported */
+oe_async_call_pool_t* oe_get_async_call_pool(oe_enclave_t* enclave);
+
 #endif /* OE_HOST_CALLS_H */
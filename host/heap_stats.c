@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/raise.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fopen.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include "sgx/enclave.h"
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#if defined(__linux__)
+#include "optee/linux/enclave.h"
+#else
+#error "OP-TEE is not yet supported on non-Linux platforms."
+#endif
+#else
+#error "Open Enclave is not supported on this architecture."
+#endif
+
+#include "tee_u.h"
+
+/* Initial size of the buffer the heap profile is written to */
+#define HEAP_PROFILE_BUFFER_SIZE (64 * 1024)
+
+/* The profile may grow between two ECALLs; retry a few times */
+#define HEAP_PROFILE_MAX_ATTEMPTS 4
+
+oe_result_t oe_get_enclave_heap_stats(
+    oe_enclave_t* enclave,
+    oe_heap_stats_t* stats)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    if (stats)
+        memset(stats, 0, sizeof(*stats));
+
+    if (!enclave || !stats)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    OE_CHECK(oe_get_heap_stats_ecall(enclave, &retval, stats));
+    OE_CHECK(retval);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_write_enclave_heap_profile(
+    oe_enclave_t* enclave,
+    const char* path)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+    char* buffer = NULL;
+    size_t buffer_size = HEAP_PROFILE_BUFFER_SIZE;
+    size_t length;
+    FILE* file = NULL;
+
+    if (!enclave || !path)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (size_t i = 0; i < HEAP_PROFILE_MAX_ATTEMPTS; i++)
+    {
+        size_t buffer_size_out = 0;
+
+        free(buffer);
+
+        if (!(buffer = (char*)malloc(buffer_size)))
+            OE_RAISE(OE_OUT_OF_MEMORY);
+
+        OE_CHECK(oe_get_heap_profile_ecall(
+            enclave,
+            &retval,
+            enclave->path,
+            buffer,
+            buffer_size,
+            &buffer_size_out));
+
+        if (retval != OE_BUFFER_TOO_SMALL)
+            break;
+
+        /* Leave room for sites added in the meantime */
+        buffer_size = buffer_size_out + buffer_size_out / 4;
+    }
+
+    if (retval == OE_BUFFER_TOO_SMALL)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    OE_CHECK(retval);
+
+    length = strnlen(buffer, buffer_size);
+
+    if (oe_fopen(&file, path, "w") != 0)
+        OE_RAISE(OE_FAILURE);
+
+    if (fwrite(buffer, 1, length, file) != length)
+        OE_RAISE(OE_FAILURE);
+
+    result = OE_OK;
+
+done:
+
+    if (file)
+        fclose(file);
+
+    free(buffer);
+    return result;
+}
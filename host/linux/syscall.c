@@ -15,6 +15,7 @@
 #include <sys/epoll.h>
 #include <sys/ioctl.h>
 #include <sys/poll.h>
+#include <sys/sendfile.h>
 #include <sys/signal.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
@@ -152,6 +153,134 @@ oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
     return lseek((int)fd, offset, whence);
 }
 
+ssize_t oe_syscall_pread_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    errno = 0;
+
+    return pread((int)fd, buf, count, offset);
+}
+
+ssize_t oe_syscall_pwrite_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    errno = 0;
+
+    return pwrite((int)fd, buf, count, offset);
+}
+
+ssize_t oe_syscall_preadv_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    struct oe_iovec* iov = (struct oe_iovec*)iov_buf;
+    ssize_t ret = -1;
+    ssize_t size_read;
+
+    OE_UNUSED(iov_buf_size);
+
+    errno = 0;
+
+    if ((!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    /* Handle zero data case. */
+    if (!iov || iovcnt == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    {
+        _relocate_iov_bases(iov, iovcnt, (ptrdiff_t)iov_buf);
+
+        size_read = preadv((int)fd, (struct iovec*)iov, iovcnt, offset);
+
+        _relocate_iov_bases(iov, iovcnt, -(ptrdiff_t)iov_buf);
+    }
+
+    ret = size_read;
+
+done:
+    return ret;
+}
+
+ssize_t oe_syscall_pwritev_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    ssize_t size_written;
+    struct oe_iovec* iov = (struct oe_iovec*)iov_buf;
+
+    OE_UNUSED(iov_buf_size);
+
+    errno = 0;
+
+    if ((!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+    {
+        errno = EINVAL;
+        goto done;
+    }
+
+    /* Handle zero data case. */
+    if (!iov || iovcnt == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    _relocate_iov_bases(iov, iovcnt, (ptrdiff_t)iov_buf);
+    size_written = pwritev((int)fd, (struct iovec*)iov, iovcnt, offset);
+
+    ret = size_written;
+
+done:
+    return ret;
+}
+
+ssize_t oe_syscall_sendfile_ocall(
+    oe_host_fd_t out_fd,
+    oe_host_fd_t in_fd,
+    oe_off_t offset,
+    size_t count)
+{
+    off_t off = (off_t)offset;
+
+    errno = 0;
+
+    return sendfile((int)out_fd, (int)in_fd, offset < 0 ? NULL : &off, count);
+}
+
+int oe_syscall_fsync_ocall(oe_host_fd_t fd)
+{
+    errno = 0;
+
+    return fsync((int)fd);
+}
+
+int oe_syscall_fdatasync_ocall(oe_host_fd_t fd)
+{
+    errno = 0;
+
+    return fdatasync((int)fd);
+}
+
 int oe_syscall_close_ocall(oe_host_fd_t fd)
 {
     errno = 0;
@@ -178,10 +307,33 @@ uint64_t oe_syscall_opendir_ocall(const char* name)
     return (uint64_t)opendir(name);
 }
 
-int oe_syscall_readdir_ocall(uint64_t dirp, struct oe_dirent* entry)
+/* Copy a host directory entry to an enclave one. */
+static int _copy_dirent(struct oe_dirent* entry, const struct dirent* ent)
 {
-    int ret = -1;
-    struct dirent* ent;
+    size_t len = strlen(ent->d_name);
+
+    if (len >= sizeof(entry->d_name))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    entry->d_ino = ent->d_ino;
+    entry->d_off = ent->d_off;
+    entry->d_type = ent->d_type;
+    entry->d_reclen = sizeof(struct oe_dirent);
+    memcpy(entry->d_name, ent->d_name, len + 1);
+
+    return 0;
+}
+
+ssize_t oe_syscall_readdir_batch_ocall(
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count)
+{
+    ssize_t ret = -1;
+    size_t n = 0;
 
     errno = 0;
 
@@ -191,45 +343,41 @@ int oe_syscall_readdir_ocall(uint64_t dirp, struct oe_dirent* entry)
         goto done;
     }
 
-    if (!entry)
+    if (!entries || count > SSIZE_MAX)
     {
         errno = EINVAL;
         goto done;
     }
 
-    /* Perform the readdir() operation. */
+    /* readdir() returns the entries buffered by its getdents64() calls, so
+     * this costs one system call per buffer rather than per entry. */
+    while (n < count)
     {
+        struct dirent* ent;
+
         errno = 0;
 
         if (!(ent = readdir((DIR*)dirp)))
         {
-            if (errno)
+            /* Report an error with the entries read before it, if any. */
+            if (errno && n == 0)
                 goto done;
 
-            ret = 1;
-            goto done;
+            break;
         }
-    }
-
-    /* Copy the local entry to the caller's entry structure. */
-    {
-        size_t len = strlen(ent->d_name);
 
-        entry->d_ino = ent->d_ino;
-        entry->d_off = ent->d_off;
-        entry->d_type = ent->d_type;
-        entry->d_reclen = sizeof(struct oe_dirent);
-
-        if (len >= sizeof(entry->d_name))
+        if (_copy_dirent(&entries[n], ent) != 0)
         {
-            errno = ENAMETOOLONG;
-            goto done;
+            if (n == 0)
+                goto done;
+
+            break;
         }
 
-        memcpy(entry->d_name, ent->d_name, len + 1);
+        n++;
     }
 
-    ret = 0;
+    ret = (ssize_t)n;
 
 done:
     return ret;
@@ -0,0 +1,26 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+
+/* Call statistics are only collected for SGX enclaves */
+
+oe_result_t oe_get_call_statistics(
+    oe_enclave_t* enclave,
+    oe_call_statistics_t* statistics,
+    size_t* count)
+{
+    OE_UNUSED(enclave);
+    OE_UNUSED(statistics);
+
+    if (count)
+        *count = 0;
+
+    return OE_UNSUPPORTED;
+}
+
+oe_result_t oe_reset_call_statistics(oe_enclave_t* enclave)
+{
+    OE_UNUSED(enclave);
+    return OE_UNSUPPORTED;
+}
@@ -533,6 +533,13 @@ done:
     return result;
 }
 
+oe_async_call_pool_t* oe_get_async_call_pool(oe_enclave_t* enclave)
+{
+    /* Asynchronous ECALLs are not supported on OP-TEE yet */
+    OE_UNUSED(enclave);
+    return NULL;
+}
+
 oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
 {
     oe_result_t result = OE_UNEXPECTED;
@@ -3,11 +3,13 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #if defined(__linux__)
 #include <dlfcn.h>
 #include <linux/futex.h>
+#include <pthread.h>
 #include <setjmp.h>
 #include <sys/mman.h>
 #include <sys/syscall.h>
@@ -21,6 +23,7 @@
 #include <openenclave/bits/safecrt.h>
 #include <openenclave/bits/safemath.h>
 #include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/calls.h>
 #include <openenclave/internal/debugrt/host.h>
 #include <openenclave/internal/raise.h>
@@ -31,8 +34,12 @@
 #include "../hostthread.h"
 #include "../ocalls.h"
 #include "asmdefs.h"
+#include "callstats.h"
 #include "enclave.h"
 #include "ocalls.h"
+#include "parallel.h"
+#include "sgx_u.h"
+#include "switchless.h"
 
 /*
 **==============================================================================
@@ -245,16 +252,14 @@ done:
 /*
 **==============================================================================
 **
-** _handle_call_host_function()
+** oe_handle_call_host_function()
 **
 ** Handle calls from the enclave.
 **
 **==============================================================================
 */
 
-static oe_result_t _handle_call_host_function(
-    uint64_t arg,
-    oe_enclave_t* enclave)
+oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave)
 {
     oe_call_host_function_args_t* args_ptr = NULL;
     oe_result_t result = OE_OK;
@@ -312,12 +317,36 @@ static oe_result_t _handle_call_host_function(
         OE_RAISE(OE_INVALID_PARAMETER);
 
     // Call the function.
-    func(
-        args_ptr->input_buffer,
-        args_ptr->input_buffer_size,
-        args_ptr->output_buffer,
-        args_ptr->output_buffer_size,
-        &args_ptr->output_bytes_written);
+    if (enclave->call_statistics)
+    {
+        const uint64_t start = oe_call_statistics_now();
+
+        func(
+            args_ptr->input_buffer,
+            args_ptr->input_buffer_size,
+            args_ptr->output_buffer,
+            args_ptr->output_buffer_size,
+            &args_ptr->output_bytes_written);
+
+        oe_record_call_statistics(
+            enclave->call_statistics,
+            OE_CALL_KIND_OCALL,
+            args_ptr->table_id,
+            args_ptr->function_id,
+            args_ptr->input_buffer_size,
+            args_ptr->output_bytes_written,
+            start,
+            false);
+    }
+    else
+    {
+        func(
+            args_ptr->input_buffer,
+            args_ptr->input_buffer_size,
+            args_ptr->output_buffer,
+            args_ptr->output_buffer_size,
+            &args_ptr->output_bytes_written);
+    }
 
     // The ocall succeeded.
     args_ptr->result = OE_OK;
@@ -327,6 +356,42 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _handle_call_host_function_batch()
+**
+** Handle a batch of calls from the enclave (oe_ocall_batch_submit()). Each
+** call is dispatched as if it had been made by its own OCALL; a failure is
+** reported in that call's result and does not stop the remaining calls.
+**
+**==============================================================================
+*/
+
+static oe_result_t _handle_call_host_function_batch(
+    uint64_t arg,
+    oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_host_function_batch_args_t* args_ptr;
+
+    args_ptr = (oe_call_host_function_batch_args_t*)arg;
+    if (args_ptr == NULL || args_ptr->calls == NULL)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    for (uint64_t i = 0; i < args_ptr->num_calls; i++)
+    {
+        oe_call_host_function_args_t* call = &args_ptr->calls[i];
+
+        call->result = oe_handle_call_host_function((uint64_t)call, enclave);
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
 static const char* oe_ocall_str(oe_func_t ocall)
 {
     // clang-format off
@@ -339,6 +404,7 @@ static const char* oe_ocall_str(oe_func_t ocall)
         "FREE",
         "SLEEP",
         "GET_TIME",
+        "CALL_HOST_FUNCTION_BATCH",
     };
     // clang-format on
 
@@ -402,13 +468,20 @@ static oe_result_t _handle_ocall(
         "%s 0x%x %s: %s\n",
         enclave->path,
         enclave->addr,
-        func == OE_OCALL_CALL_HOST_FUNCTION ? "EDL_OCALL" : "OE_OCALL",
+        (func == OE_OCALL_CALL_HOST_FUNCTION ||
+         func == OE_OCALL_CALL_HOST_FUNCTION_BATCH)
+            ? "EDL_OCALL"
+            : "OE_OCALL",
         oe_ocall_str(func));
 
     switch ((oe_func_t)func)
     {
         case OE_OCALL_CALL_HOST_FUNCTION:
-            _handle_call_host_function(arg_in, enclave);
+            oe_handle_call_host_function(arg_in, enclave);
+            break;
+
+        case OE_OCALL_CALL_HOST_FUNCTION_BATCH:
+            _handle_call_host_function_batch(arg_in, enclave);
             break;
 
         case OE_OCALL_MALLOC:
@@ -544,6 +617,178 @@ int __oe_dispatch_ocall(
     return 1;
 }
 
+/*
+**==============================================================================
+**
+** TCS assignment helpers
+**
+**     Free TCSs are tracked in enclave->busy_bindings, one bit per binding,
+**     so claiming and releasing a TCS is a single CAS. A binding is only
+**     modified by the thread that owns it. TSD usually holds the innermost
+**     binding of the calling thread, so most nested ECALLs find theirs
+**     without a lookup. It does not always: dissolving the binding of a
+**     nested ECALL into another enclave clears TSD until the OCALL below it
+**     returns. TSD also counts the bindings the thread owns in all enclaves.
+**     Only a thread that owns some, yet has none of this enclave in TSD,
+**     searches the bindings of this enclave by thread; top-level ECALLs
+**     never do.
+**
+**==============================================================================
+*/
+
+OE_STATIC_ASSERT(OE_SGX_MAX_TCS <= 64);
+
+#if defined(USE_TLS_FOR_THREADING_BINDING)
+/* Index (plus one) of the binding the calling thread used last */
+static oe_once_type _tcs_hint_once;
+static oe_thread_key _tcs_hint_key;
+
+static void _create_tcs_hint_key(void)
+{
+    oe_thread_key_create(&_tcs_hint_key);
+}
+#endif
+
+static size_t _get_tcs_hint(void)
+{
+#if defined(USE_TLS_FOR_THREADING_BINDING)
+    oe_once(&_tcs_hint_once, _create_tcs_hint_key);
+    return (size_t)(uintptr_t)oe_thread_getspecific(_tcs_hint_key);
+#else
+    return 0;
+#endif
+}
+
+static void _set_tcs_hint(size_t hint)
+{
+#if defined(USE_TLS_FOR_THREADING_BINDING)
+    oe_once(&_tcs_hint_once, _create_tcs_hint_key);
+    oe_thread_setspecific(_tcs_hint_key, (void*)(uintptr_t)hint);
+#else
+    OE_UNUSED(hint);
+#endif
+}
+
+#if defined(USE_TLS_FOR_THREADING_BINDING)
+/* Number of bindings, in any enclave, owned by the calling thread */
+static oe_once_type _num_owned_once;
+static oe_thread_key _num_owned_key;
+
+static void _create_num_owned_key(void)
+{
+    oe_thread_key_create(&_num_owned_key);
+}
+#endif
+
+static size_t _get_num_owned_bindings(void)
+{
+#if defined(USE_TLS_FOR_THREADING_BINDING)
+    oe_once(&_num_owned_once, _create_num_owned_key);
+    return (size_t)(uintptr_t)oe_thread_getspecific(_num_owned_key);
+#else
+    /* Unknown, so always search */
+    return 1;
+#endif
+}
+
+static void _add_num_owned_bindings(ptrdiff_t delta)
+{
+#if defined(USE_TLS_FOR_THREADING_BINDING)
+    size_t num_owned = _get_num_owned_bindings() + (size_t)delta;
+    oe_thread_setspecific(_num_owned_key, (void*)(uintptr_t)num_owned);
+#else
+    OE_UNUSED(delta);
+#endif
+}
+
+static size_t _lowest_set_bit(uint64_t x)
+{
+#if defined(__GNUC__)
+    return (size_t)__builtin_ctzll(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return index;
+#endif
+}
+
+static bool _is_enclave_binding(oe_enclave_t* enclave, ThreadBinding* binding)
+{
+    return binding >= enclave->bindings &&
+           binding < enclave->bindings + enclave->num_bindings;
+}
+
+/* Find the binding of this enclave owned by the calling thread. Needed only
+ * when the thread nests ECALLs across enclaves. Other threads never set
+ * binding->thread to the calling thread, so no lock is needed. */
+static ThreadBinding* _find_owned_binding(
+    oe_enclave_t* enclave,
+    oe_thread thread)
+{
+    for (size_t i = 0; i < enclave->num_bindings; i++)
+    {
+        ThreadBinding* binding = &enclave->bindings[i];
+
+        if ((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
+            return binding;
+    }
+
+    return NULL;
+}
+
+/* Atomically claim a free binding, preferring the given index */
+static ThreadBinding* _claim_free_binding(oe_enclave_t* enclave, size_t hint)
+{
+    const uint64_t all = (enclave->num_bindings == 64)
+                             ? OE_UINT64_MAX
+                             : ((uint64_t)1 << enclave->num_bindings) - 1;
+
+    for (;;)
+    {
+        uint64_t busy = oe_atomic_load_u64(&enclave->busy_bindings);
+        uint64_t free = ~busy & all;
+        size_t index;
+
+        if (!free)
+            return NULL;
+
+        if (hint < enclave->num_bindings && (free & ((uint64_t)1 << hint)))
+            index = hint;
+        else
+            index = _lowest_set_bit(free);
+
+        if (oe_atomic_compare_and_swap_u64(
+                &enclave->busy_bindings, busy, busy | ((uint64_t)1 << index)))
+            return &enclave->bindings[index];
+    }
+}
+
+static void _free_binding(oe_enclave_t* enclave, ThreadBinding* binding)
+{
+    const uint64_t bit = (uint64_t)1 << (binding - enclave->bindings);
+    uint64_t busy;
+
+    do
+    {
+        busy = oe_atomic_load_u64(&enclave->busy_bindings);
+    } while (!oe_atomic_compare_and_swap_u64(
+        &enclave->busy_bindings, busy, busy & ~bit));
+}
+
+/* Reset a binding whose count dropped to zero and publish it as free */
+static void _dissolve_binding(oe_enclave_t* enclave, ThreadBinding* binding)
+{
+    binding->flags &= (~_OE_THREAD_BUSY);
+    binding->thread = 0;
+    memset(&binding->event, 0, sizeof(binding->event));
+    _set_thread_binding(NULL);
+    assert(GetThreadBinding() == NULL);
+    _add_num_owned_bindings(-1);
+
+    /* Publish the binding as free only once it has been reset */
+    _free_binding(enclave, binding);
+}
+
 /*
 **==============================================================================
 **
@@ -554,8 +799,8 @@ int __oe_dispatch_ocall(
 **         - an enclave thread context
 **
 **     If such a binding already exists, the binding's count in incremented.
-**     Else, the calling host thread is bound to the first available enclave
-**     thread context.
+**     Else, the calling host thread is bound to an available enclave thread
+**     context, preferably the one it was bound to last.
 **
 **     Returns the address of the thread control structure (TCS) corresponding
 **     to the enclave thread context.
@@ -565,60 +810,54 @@ int __oe_dispatch_ocall(
 
 static void* _assign_tcs(oe_enclave_t* enclave)
 {
-    void* tcs = NULL;
-    size_t i;
     oe_thread thread = oe_thread_self();
+    ThreadBinding* binding = GetThreadBinding();
 
-    oe_mutex_lock(&enclave->lock);
+    /* TSD holds the innermost binding of this thread, if it owns any. A
+     * binding of another enclave, or none at all while the thread owns some,
+     * means that it nests ECALLs across enclaves and may own one here. */
+    if (!binding || !_is_enclave_binding(enclave, binding))
     {
-        /* First attempt to find a busy td_t owned by this thread */
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            ThreadBinding* binding = &enclave->bindings[i];
+        binding = NULL;
 
-            if ((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread)
-            {
-                binding->count++;
-                tcs = (void*)binding->tcs;
+        if (_get_num_owned_bindings() > 0)
+            binding = _find_owned_binding(enclave, thread);
+    }
 
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_push_thread_binding(
-                        enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                break;
-            }
-        }
+    if (binding)
+    {
+        assert((binding->flags & _OE_THREAD_BUSY) && binding->thread == thread);
+        binding->count++;
 
-        /* If binding not found above, look for an available ThreadBinding */
-        if (!tcs)
-        {
-            for (i = 0; i < enclave->num_bindings; i++)
-            {
-                ThreadBinding* binding = &enclave->bindings[i];
+        /* Asynchronous exceptions get the binding from TSD */
+        _set_thread_binding(binding);
+    }
+    else
+    {
+        /* Prefer the TCS this thread used last (no hint wraps to SIZE_MAX) */
+        size_t hint = _get_tcs_hint() - 1;
 
-                if (!(binding->flags & _OE_THREAD_BUSY))
-                {
-                    binding->flags |= _OE_THREAD_BUSY;
-                    binding->thread = thread;
-                    binding->count = 1;
-                    tcs = (void*)binding->tcs;
-
-                    /* Set into TSD so asynchronous exceptions can get it */
-                    _set_thread_binding(binding);
-                    assert(GetThreadBinding() == binding);
-
-                    /* Notify the debugger runtime */
-                    if (enclave->debug && enclave->debug_enclave != NULL)
-                        oe_debug_push_thread_binding(
-                            enclave->debug_enclave, (sgx_tcs_t*)tcs);
-                    break;
-                }
-            }
-        }
+        if (!(binding = _claim_free_binding(enclave, hint)))
+            return NULL;
+
+        binding->flags |= _OE_THREAD_BUSY;
+        binding->thread = thread;
+        binding->count = 1;
+
+        /* Set into TSD so asynchronous exceptions can get it */
+        _set_thread_binding(binding);
+        assert(GetThreadBinding() == binding);
+        _add_num_owned_bindings(1);
+
+        _set_tcs_hint((size_t)(binding - enclave->bindings) + 1);
     }
-    oe_mutex_unlock(&enclave->lock);
 
-    return tcs;
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_push_thread_binding(
+            enclave->debug_enclave, (sgx_tcs_t*)binding->tcs);
+
+    return (void*)binding->tcs;
 }
 
 /*
@@ -634,36 +873,243 @@ static void* _assign_tcs(oe_enclave_t* enclave)
 
 static void _release_tcs(oe_enclave_t* enclave, void* tcs)
 {
-    size_t i;
+    ThreadBinding* binding = GetThreadBinding();
 
-    oe_mutex_lock(&enclave->lock);
+    /* The TCS is normally that of the innermost binding */
+    if (!binding || (void*)binding->tcs != tcs)
     {
-        for (i = 0; i < enclave->num_bindings; i++)
-        {
-            ThreadBinding* binding = &enclave->bindings[i];
+        binding = NULL;
 
-            if ((binding->flags & _OE_THREAD_BUSY) &&
-                (void*)binding->tcs == tcs)
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+        {
+            if ((void*)enclave->bindings[i].tcs == tcs)
             {
-                binding->count--;
-
-                /* Notify the debugger runtime */
-                if (enclave->debug && enclave->debug_enclave != NULL)
-                    oe_debug_pop_thread_binding();
-
-                if (binding->count == 0)
-                {
-                    binding->flags &= (~_OE_THREAD_BUSY);
-                    binding->thread = 0;
-                    memset(&binding->event, 0, sizeof(binding->event));
-                    _set_thread_binding(NULL);
-                    assert(GetThreadBinding() == NULL);
-                }
+                binding = &enclave->bindings[i];
                 break;
             }
         }
+
+        if (!binding || !(binding->flags & _OE_THREAD_BUSY))
+            return;
+    }
+
+    binding->count--;
+
+    /* Notify the debugger runtime */
+    if (enclave->debug && enclave->debug_enclave != NULL)
+        oe_debug_pop_thread_binding();
+
+    if (binding->count == 0)
+        _dissolve_binding(enclave, binding);
+}
+
+/*
+**==============================================================================
+**
+** oe_sgx_thread_create_ocall()
+**
+**     Spawn a host thread for a thread created inside the enclave. The TCS is
+**     reserved here rather than by the new thread, so that the enclave learns
+**     synchronously whether one is free. The new thread adopts the reserved
+**     binding with a count of zero, which oe_ecall() then increments as for
+**     any binding the thread already owns, and enters the enclave through
+**     oe_sgx_thread_start_ecall(). The argument is opaque to the host.
+**
+**     The thread is counted in enclave->num_enclave_threads from before it
+**     is spawned until it no longer uses the enclave, so that
+**     oe_terminate_enclave() waits for it.
+**
+**==============================================================================
+*/
+
+typedef struct _enclave_thread_start
+{
+    oe_enclave_t* enclave;
+    ThreadBinding* binding;
+    uint64_t arg;
+} enclave_thread_start_t;
+
+static void _run_enclave_thread(enclave_thread_start_t* start)
+{
+    oe_enclave_t* enclave = start->enclave;
+    ThreadBinding* binding = start->binding;
+    oe_result_t result;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    binding->flags |= _OE_THREAD_BUSY;
+    binding->thread = oe_thread_self();
+    binding->count = 0;
+    _set_thread_binding(binding);
+    _add_num_owned_bindings(1);
+
+    result = oe_sgx_thread_start_ecall(enclave, &retval, start->arg);
+
+    if (result == OE_OK)
+        result = retval;
+
+    if (result != OE_OK)
+        OE_TRACE_ERROR("enclave thread exited: %s\n", oe_result_str(result));
+
+    /* The ECALL failed before it assigned the TCS */
+    if (GetThreadBinding() == binding && binding->count == 0)
+        _dissolve_binding(enclave, binding);
+
+    free(start);
+
+    /* The enclave may be released from here on */
+    oe_atomic_decrement(&enclave->num_enclave_threads);
+}
+
+#if defined(__linux__)
+static void* _enclave_thread(void* arg)
+{
+    _run_enclave_thread((enclave_thread_start_t*)arg);
+    return NULL;
+}
+#elif defined(_WIN32)
+static DWORD WINAPI _enclave_thread(LPVOID arg)
+{
+    _run_enclave_thread((enclave_thread_start_t*)arg);
+    return 0;
+}
+#endif
+
+oe_result_t oe_sgx_thread_create_ocall(oe_enclave_t* enclave, uint64_t arg)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    enclave_thread_start_t* start = NULL;
+    ThreadBinding* binding = NULL;
+    bool counted = false;
+
+    if (!enclave)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(start = (enclave_thread_start_t*)malloc(sizeof(*start))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (!(binding = _claim_free_binding(enclave, OE_SIZE_MAX)))
+        OE_RAISE_NO_TRACE(OE_OUT_OF_THREADS);
+
+    start->enclave = enclave;
+    start->binding = binding;
+    start->arg = arg;
+
+    oe_atomic_increment(&enclave->num_enclave_threads);
+    counted = true;
+
+#if defined(__linux__)
+    {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, _enclave_thread, start) != 0)
+            OE_RAISE(OE_FAILURE);
+
+        pthread_detach(thread);
+    }
+#elif defined(_WIN32)
+    {
+        HANDLE thread = CreateThread(NULL, 0, _enclave_thread, start, 0, NULL);
+
+        if (!thread)
+            OE_RAISE(OE_FAILURE);
+
+        CloseHandle(thread);
+    }
+#endif
+
+    /* Owned by the new thread */
+    start = NULL;
+    binding = NULL;
+    counted = false;
+    result = OE_OK;
+
+done:
+
+    if (counted)
+        oe_atomic_decrement(&enclave->num_enclave_threads);
+
+    if (binding)
+        _free_binding(enclave, binding);
+
+    free(start);
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_sgx_wait_for_enclave_threads()
+**
+**     Called before the enclave destructor runs. The enclave is first told
+**     that it is being terminated, so that threads that run until they are
+**     asked to stop, such as detached worker loops, see it through
+**     oe_is_enclave_terminating() and return. The notification needs a free
+**     TCS, which these threads may all hold, so it is retried while waiting.
+**     Threads exit rarely, so polling the count is enough. Fails with
+**     OE_BUSY if threads are still running after the timeout.
+**
+**==============================================================================
+*/
+
+#define ENCLAVE_THREADS_TIMEOUT_MS 10000
+#define NOTIFY_RETRY_MS 100
+
+oe_result_t oe_sgx_wait_for_enclave_threads(oe_enclave_t* enclave)
+{
+    bool notified = false;
+
+    for (uint32_t ms = 0; oe_atomic_load_u64(&enclave->num_enclave_threads);
+         ms++)
+    {
+        if (ms == ENCLAVE_THREADS_TIMEOUT_MS)
+            return OE_BUSY;
+
+        if (!notified && ms % NOTIFY_RETRY_MS == 0)
+            notified = oe_sgx_notify_termination_ecall(enclave) == OE_OK;
+
+#if defined(__linux__)
+        usleep(1000);
+#elif defined(_WIN32)
+        Sleep(1);
+#endif
     }
-    oe_mutex_unlock(&enclave->lock);
+
+    return OE_OK;
+}
+
+/*
+**==============================================================================
+**
+** _record_ecall()
+**
+**     Record an OE_ECALL_CALL_ENCLAVE_FUNCTION call in the enclave's call
+**     statistics. The arguments are host memory owned by the caller.
+**
+**==============================================================================
+*/
+
+static void _record_ecall(
+    oe_enclave_t* enclave,
+    uint64_t arg,
+    uint64_t start,
+    bool failed)
+{
+    const oe_call_enclave_function_args_t* args =
+        (const oe_call_enclave_function_args_t*)arg;
+
+    if (!args)
+        return;
+
+    oe_record_call_statistics(
+        enclave->call_statistics,
+        OE_CALL_KIND_ECALL,
+        args->table_id,
+        args->function_id,
+        args->input_buffer_size,
+        args->output_bytes_written,
+        start,
+        failed || args->result != OE_OK);
 }
 
 /*
@@ -689,10 +1135,14 @@ oe_result_t oe_ecall(
     uint16_t func_out = 0;
     uint16_t result_out = 0;
     uint64_t arg_out = 0;
+    uint64_t start = 0;
 
     if (!enclave)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    if (enclave->call_statistics && func == OE_ECALL_CALL_ENCLAVE_FUNCTION)
+        start = oe_call_statistics_now();
+
     /* Assign a td_t for this operation */
     if (!(tcs = _assign_tcs(enclave)))
         OE_RAISE(OE_OUT_OF_THREADS);
@@ -732,6 +1182,9 @@ done:
     if (enclave && tcs)
         _release_tcs(enclave, tcs);
 
+    if (start)
+        _record_ecall(enclave, arg, start, result != OE_OK || arg_out != 0);
+
     /* ATTN: this causes an assertion with call nesting. */
     /* ATTN: make enclave argument a cookie. */
     /* ATTN: the SetEnclave() function no longer exists */
@@ -763,6 +1216,7 @@ static oe_result_t oe_switchless_call_enclave_function_by_table_id(
 {
     oe_result_t result = OE_UNEXPECTED;
     oe_call_enclave_function_args_t args;
+    uint64_t start = 0;
 
     /* Reject invalid parameters */
     if (!enclave)
@@ -780,9 +1234,31 @@ static oe_result_t oe_switchless_call_enclave_function_by_table_id(
         args.result = OE_UNEXPECTED;
     }
 
-    /* TODO: @EMumau Perform the Switchless ECALL */
+    /* Hand the call to a switchless enclave worker. Fall back to a regular
+     * ECALL if no worker is running or all of them are busy. */
+    if (enclave->call_statistics)
+        start = oe_call_statistics_now();
+
+    result = oe_post_switchless_ecall(enclave->switchless_manager, &args);
+
+    /* The fallback ECALL is recorded by oe_ecall() */
+    if (start && result != OE_BUSY)
+        _record_ecall(enclave, (uint64_t)&args, start, result != OE_OK);
+
+    if (result == OE_BUSY)
     {
-        OE_RAISE(OE_UNSUPPORTED);
+        uint64_t arg_out = 0;
+
+        OE_CHECK(oe_ecall(
+            enclave,
+            OE_ECALL_CALL_ENCLAVE_FUNCTION,
+            (uint64_t)&args,
+            &arg_out));
+        OE_CHECK((oe_result_t)arg_out);
+    }
+    else
+    {
+        OE_CHECK(result);
     }
 
     /* Check the result */
@@ -825,6 +1301,54 @@ oe_result_t oe_switchless_call_enclave_function(
         output_bytes_written);
 }
 
+/*
+**==============================================================================
+**
+** oe_get_async_call_pool()
+**
+**     Create the enclave's pool for oe_call_enclave_function_async() on first
+**     use, with one thread per TCS that is not held for the lifetime of the
+**     enclave by a switchless enclave worker or a parallel worker.
+**
+**==============================================================================
+*/
+
+oe_async_call_pool_t* oe_get_async_call_pool(oe_enclave_t* enclave)
+{
+    oe_async_call_pool_t* pool;
+    size_t num_reserved = oe_get_num_parallel_workers(enclave);
+    size_t num_workers;
+
+    pool = (oe_async_call_pool_t*)oe_atomic_load_ptr(
+        (void* volatile*)&enclave->async_call_pool);
+
+    if (pool)
+        return pool;
+
+    if (enclave->switchless_manager)
+        num_reserved += enclave->switchless_manager->num_enclave_workers;
+
+    /* oe_create_enclave() keeps at least one TCS free of workers */
+    num_workers = num_reserved < enclave->num_bindings
+                      ? enclave->num_bindings - num_reserved
+                      : 0;
+
+    if (oe_create_async_call_pool(
+            enclave, num_workers ? num_workers : 1, &pool) != OE_OK)
+        return NULL;
+
+    /* Another thread may have created the pool concurrently */
+    if (!oe_atomic_compare_and_swap_ptr(
+            (void* volatile*)&enclave->async_call_pool, NULL, pool))
+    {
+        oe_destroy_async_call_pool(pool);
+        pool = (oe_async_call_pool_t*)oe_atomic_load_ptr(
+            (void* volatile*)&enclave->async_call_pool);
+    }
+
+    return pool;
+}
+
 /*
 ** These two functions are needed to notify the debugger. They should not be
 ** optimized out even though they don't do anything in here.
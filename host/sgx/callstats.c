@@ -0,0 +1,275 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "callstats.h"
+
+#if defined(__linux__)
+#include <time.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/raise.h>
+#include "enclave.h"
+
+/*
+**==============================================================================
+**
+** oe_call_statistics_table_t:
+**
+**     Open-addressed table with one entry per (kind, table, function). An
+**     entry is claimed by atomically setting its key, after which its
+**     counters are only ever updated with atomic adds, so recording a call
+**     takes no lock. Entries are never removed; a reset only zeroes the
+**     counters.
+**
+**     The key packs the call kind (2 bits), the table id plus one (14 bits,
+**     so that the default table OE_UINT64_MAX becomes zero) and the function
+**     id (48 bits). Since the kind is never zero, neither is a key. Calls
+**     whose ids do not fit, or made once the table is full, are not
+**     recorded.
+**
+**==============================================================================
+*/
+
+#define MAX_ENTRIES 512 /* Power of two */
+#define KIND_SHIFT 62
+#define TABLE_SHIFT 48
+#define TABLE_MASK 0x3FFFULL
+#define FUNCTION_MASK 0xFFFFFFFFFFFFULL
+
+typedef struct _entry
+{
+    volatile uint64_t key;
+    volatile uint64_t num_calls;
+    volatile uint64_t num_failures;
+    volatile uint64_t bytes_in;
+    volatile uint64_t bytes_out;
+    volatile uint64_t total_nsec;
+    volatile uint64_t histogram[OE_CALL_STATISTICS_NUM_BUCKETS];
+} entry_t;
+
+struct _oe_call_statistics_table
+{
+    entry_t entries[MAX_ENTRIES];
+};
+
+static bool _make_key(
+    oe_call_kind_t kind,
+    uint64_t table_id,
+    uint64_t function_id,
+    uint64_t* key)
+{
+    const uint64_t table = table_id + 1;
+
+    if (table > TABLE_MASK || function_id > FUNCTION_MASK)
+        return false;
+
+    *key = ((uint64_t)kind << KIND_SHIFT) | (table << TABLE_SHIFT) |
+           function_id;
+    return true;
+}
+
+static entry_t* _find_entry(oe_call_statistics_table_t* table, uint64_t key)
+{
+    size_t i = (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) % MAX_ENTRIES;
+
+    for (size_t n = 0; n < MAX_ENTRIES; n++)
+    {
+        entry_t* entry = &table->entries[i];
+        uint64_t entry_key = oe_atomic_load_u64(&entry->key);
+
+        if (entry_key == key)
+            return entry;
+
+        /* Claim the empty slot, unless another thread just did */
+        if (entry_key == 0)
+        {
+            if (oe_atomic_compare_and_swap_u64(&entry->key, 0, key) ||
+                oe_atomic_load_u64(&entry->key) == key)
+                return entry;
+        }
+
+        i = (i + 1) % MAX_ENTRIES;
+    }
+
+    return NULL;
+}
+
+static size_t _bucket(uint64_t nsec)
+{
+    size_t bucket = 0;
+
+    while ((nsec >>= 1) != 0 && bucket < OE_CALL_STATISTICS_NUM_BUCKETS - 1)
+        bucket++;
+
+    return bucket;
+}
+
+oe_result_t oe_create_call_statistics(oe_call_statistics_table_t** table)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    if (!table)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(*table = (oe_call_statistics_table_t*)calloc(1, sizeof(**table))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+void oe_free_call_statistics(oe_call_statistics_table_t* table)
+{
+    free(table);
+}
+
+uint64_t oe_call_statistics_now(void)
+{
+#if defined(__linux__)
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return 0;
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#elif defined(_WIN32)
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&counter);
+
+    /* Split to avoid overflowing the multiplication */
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL /
+               (uint64_t)frequency.QuadPart;
+#endif
+}
+
+void oe_record_call_statistics(
+    oe_call_statistics_table_t* table,
+    oe_call_kind_t kind,
+    uint64_t table_id,
+    uint64_t function_id,
+    uint64_t bytes_in,
+    uint64_t bytes_out,
+    uint64_t start_nsec,
+    bool failed)
+{
+    const uint64_t end_nsec = oe_call_statistics_now();
+    const uint64_t nsec = end_nsec > start_nsec ? end_nsec - start_nsec : 0;
+    entry_t* entry;
+    uint64_t key;
+
+    if (!table || !_make_key(kind, table_id, function_id, &key))
+        return;
+
+    if (!(entry = _find_entry(table, key)))
+        return;
+
+    oe_atomic_increment(&entry->num_calls);
+
+    if (failed)
+        oe_atomic_increment(&entry->num_failures);
+
+    oe_atomic_add_u64(&entry->bytes_in, bytes_in);
+    oe_atomic_add_u64(&entry->bytes_out, bytes_out);
+    oe_atomic_add_u64(&entry->total_nsec, nsec);
+    oe_atomic_increment(&entry->histogram[_bucket(nsec)]);
+}
+
+oe_result_t oe_get_call_statistics(
+    oe_enclave_t* enclave,
+    oe_call_statistics_t* statistics,
+    size_t* count)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_statistics_table_t* table;
+    size_t n = 0;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC || !count ||
+        (*count && !statistics))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(table = enclave->call_statistics))
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    for (size_t i = 0; i < MAX_ENTRIES; i++)
+    {
+        entry_t* entry = &table->entries[i];
+        uint64_t key = oe_atomic_load_u64(&entry->key);
+        oe_call_statistics_t* out;
+
+        if (key == 0)
+            continue;
+
+        if (n++ >= *count)
+            continue;
+
+        out = &statistics[n - 1];
+        out->kind = (oe_call_kind_t)(key >> KIND_SHIFT);
+        out->table_id = ((key >> TABLE_SHIFT) & TABLE_MASK) - 1;
+        out->function_id = key & FUNCTION_MASK;
+        out->num_calls = entry->num_calls;
+        out->num_failures = entry->num_failures;
+        out->bytes_in = entry->bytes_in;
+        out->bytes_out = entry->bytes_out;
+        out->total_nsec = entry->total_nsec;
+
+        for (size_t j = 0; j < OE_CALL_STATISTICS_NUM_BUCKETS; j++)
+            out->latency_histogram[j] = entry->histogram[j];
+    }
+
+    if (n > *count)
+    {
+        *count = n;
+        OE_RAISE_NO_TRACE(OE_BUFFER_TOO_SMALL);
+    }
+
+    *count = n;
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+oe_result_t oe_reset_call_statistics(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_call_statistics_table_t* table;
+
+    if (!enclave || enclave->magic != ENCLAVE_MAGIC)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (!(table = enclave->call_statistics))
+        OE_RAISE_NO_TRACE(OE_UNSUPPORTED);
+
+    /* Keep the keys so that concurrent recorders keep a valid entry */
+    for (size_t i = 0; i < MAX_ENTRIES; i++)
+    {
+        entry_t* entry = &table->entries[i];
+
+        entry->num_calls = 0;
+        entry->num_failures = 0;
+        entry->bytes_in = 0;
+        entry->bytes_out = 0;
+        entry->total_nsec = 0;
+
+        for (size_t j = 0; j < OE_CALL_STATISTICS_NUM_BUCKETS; j++)
+            entry->histogram[j] = 0;
+    }
+
+    result = OE_OK;
+
+done:
+    return result;
+}
@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_CALLSTATS_H
+#define _OE_HOST_SGX_CALLSTATS_H
+
+#include <openenclave/host.h>
+
+typedef struct _oe_call_statistics_table oe_call_statistics_table_t;
+
+oe_result_t oe_create_call_statistics(oe_call_statistics_table_t** table);
+
+void oe_free_call_statistics(oe_call_statistics_table_t* table);
+
+/* Current time in nanoseconds, for measuring call latencies */
+uint64_t oe_call_statistics_now(void);
+
+/* Record one call that started at start_nsec */
+void oe_record_call_statistics(
+    oe_call_statistics_table_t* table,
+    oe_call_kind_t kind,
+    uint64_t table_id,
+    uint64_t function_id,
+    uint64_t bytes_in,
+    uint64_t bytes_out,
+    uint64_t start_nsec,
+    bool failed);
+
+#endif /* _OE_HOST_SGX_CALLSTATS_H */
@@ -48,12 +48,16 @@ static char* get_fullpath(const char* path)
 #include <openenclave/internal/trace.h>
 #include <openenclave/internal/utils.h>
 #include <string.h>
+#include "../calls.h"
 #include "../memalign.h"
+#include "callstats.h"
 #include "cpuid.h"
 #include "enclave.h"
 #include "exception.h"
+#include "parallel.h"
 #include "sgx_u.h"
 #include "sgxload.h"
+#include "switchless.h"
 
 static oe_once_type _enclave_init_once;
 
@@ -625,6 +629,142 @@ done:
     return result;
 }
 
+/*
+**==============================================================================
+**
+** _check_worker_counts()
+**
+**     Each switchless enclave worker and each parallel worker occupies a TCS
+**     for the lifetime of the enclave; at least one TCS is kept for regular
+**     ECALLs.
+**
+**==============================================================================
+*/
+
+static oe_result_t _check_worker_counts(
+    const oe_enclave_t* enclave,
+    const oe_enclave_config_t* config)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    const size_t num_workers = (size_t)config->max_enclave_workers +
+                               (size_t)config->num_parallel_workers;
+
+    if (num_workers && num_workers >= enclave->num_bindings)
+        OE_RAISE_MSG(
+            OE_INVALID_PARAMETER,
+            "%zu switchless enclave and parallel workers requested, but the "
+            "enclave only has %zu TCS\n",
+            num_workers,
+            enclave->num_bindings);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** _stop_enclave_threads()
+**
+**     Stop the host threads that run inside the enclave, so that their TCSs
+**     are released before the enclave destructor runs. Fails with OE_BUSY,
+**     leaving the enclave usable, if threads created inside the enclave do
+**     not exit.
+**
+**==============================================================================
+*/
+
+static oe_result_t _stop_enclave_threads(oe_enclave_t* enclave)
+{
+    oe_result_t result = OE_UNEXPECTED;
+
+    /* Finish the queued asynchronous ECALLs while the enclave is usable */
+    oe_destroy_async_call_pool(enclave->async_call_pool);
+    enclave->async_call_pool = NULL;
+
+    /* Threads created inside the enclave hold TCSs and use the enclave */
+    OE_CHECK(oe_sgx_wait_for_enclave_threads(enclave));
+
+    /* Release the TCSs held by the parallel and switchless enclave workers */
+    oe_stop_parallel_workers(enclave);
+    oe_stop_switchless_enclave_workers(enclave);
+
+    result = OE_OK;
+
+done:
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** _release_enclave()
+**
+**     Release an enclave built by oe_sgx_build_enclave(), once its destructor
+**     has run or if it was never initialized. The enclave memory and data
+**     structures are freed on a best effort basis.
+**
+**==============================================================================
+*/
+
+static oe_result_t _release_enclave(oe_enclave_t* enclave)
+{
+    oe_result_t result;
+
+    /* The destructor may still have made switchless OCALLs */
+    oe_stop_switchless_manager(enclave);
+
+    if (enclave->debug_enclave)
+    {
+        oe_debug_notify_enclave_terminated(enclave->debug_enclave);
+        free(enclave->debug_enclave->tcs_array);
+        free(enclave->debug_enclave);
+    }
+
+    /* Remove this enclave from the global list. */
+    oe_remove_enclave_instance(enclave);
+
+    /* Clear the magic number */
+    enclave->magic = 0;
+
+    oe_mutex_lock(&enclave->lock);
+    {
+        /* Unmap the enclave memory region.
+         * Track failures reported by the platform, but do not exit early */
+        result = oe_sgx_delete_enclave(enclave);
+
+#if defined(_WIN32)
+
+        /* Release Windows events created during enclave creation */
+        for (size_t i = 0; i < enclave->num_bindings; i++)
+        {
+            ThreadBinding* binding = &enclave->bindings[i];
+            CloseHandle(binding->event.handle);
+        }
+
+#endif
+
+        /* Free the path name of the enclave image file */
+        free(enclave->path);
+    }
+    /* Release and destroy the mutex object */
+    oe_mutex_unlock(&enclave->lock);
+    oe_mutex_destroy(&enclave->lock);
+
+    oe_free_call_statistics(enclave->call_statistics);
+
+    /* Clear the contents of the enclave structure */
+
+    memset(enclave, 0, sizeof(oe_enclave_t));
+
+    /* Free the enclave structure */
+    free(enclave);
+
+    return result;
+}
+
 /*
 ** This method encapsulates all steps of the enclave creation process:
 **     - Loads an enclave image file
@@ -653,6 +793,9 @@ oe_result_t oe_create_enclave(
     oe_result_t result = OE_UNEXPECTED;
     oe_enclave_t* enclave = NULL;
     oe_sgx_load_context_t context;
+    oe_enclave_config_t enclave_config = {0};
+    bool built = false;
+    bool initialized = false;
 
     _initialize_enclave_host();
 
@@ -663,7 +806,18 @@ oe_result_t oe_create_enclave(
     if (!enclave_path || !enclave_out ||
         ((enclave_type != OE_ENCLAVE_TYPE_SGX) &&
          (enclave_type != OE_ENCLAVE_TYPE_AUTO)) ||
-        (flags & OE_ENCLAVE_FLAG_RESERVED) || config || config_size > 0)
+        (flags & OE_ENCLAVE_FLAG_RESERVED))
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Check the optional creation settings */
+    if (config)
+    {
+        if (config_size != sizeof(oe_enclave_config_t))
+            OE_RAISE(OE_INVALID_PARAMETER);
+
+        enclave_config = *(const oe_enclave_config_t*)config;
+    }
+    else if (config_size > 0)
         OE_RAISE(OE_INVALID_PARAMETER);
 
     /* Allocate and zero-fill the enclave structure */
@@ -703,6 +857,10 @@ oe_result_t oe_create_enclave(
 
     /* Build the enclave */
     OE_CHECK(oe_sgx_build_enclave(&context, enclave_path, NULL, enclave));
+    built = true;
+
+    /* Check the worker counts before any worker starts */
+    OE_CHECK(_check_worker_counts(enclave, &enclave_config));
 
     /* Push the new created enclave to the global list. */
     if (oe_push_enclave_instance(enclave) != 0)
@@ -749,12 +907,30 @@ oe_result_t oe_create_enclave(
     enclave->ocalls = (const oe_ocall_func_t*)ocall_table;
     enclave->num_ocalls = ocall_table_size;
 
+    /* Record calls from the start, including those made during init */
+    if (enclave_config.collect_call_statistics)
+        OE_CHECK(oe_create_call_statistics(&enclave->call_statistics));
+
     /* Invoke enclave initialization. */
     OE_CHECK(_initialize_enclave(enclave));
+    initialized = true;
 
     /* Setup logging configuration */
     oe_log_enclave_init(enclave);
 
+    /* Start the switchless call workers once the enclave is initialized */
+    if (enclave_config.max_enclave_workers > 0 ||
+        enclave_config.max_host_workers > 0)
+        OE_CHECK(oe_start_switchless_manager(
+            enclave,
+            enclave_config.max_enclave_workers,
+            enclave_config.max_host_workers));
+
+    /* The parallel workers count the TCSs taken by switchless workers */
+    if (enclave_config.num_parallel_workers > 0)
+        OE_CHECK(oe_start_parallel_workers(
+            enclave, enclave_config.num_parallel_workers));
+
     *enclave_out = enclave;
     result = OE_OK;
 
@@ -762,7 +938,29 @@ done:
 
     if (result != OE_OK && enclave)
     {
-        free(enclave);
+        bool stopped = true;
+
+        if (initialized)
+        {
+            if ((stopped = _stop_enclave_threads(enclave) == OE_OK))
+                oe_ecall(enclave, OE_ECALL_DESTRUCTOR, 0, NULL);
+        }
+        else if (built)
+        {
+            /* Global constructors may have created threads */
+            stopped = oe_sgx_wait_for_enclave_threads(enclave) == OE_OK;
+        }
+
+        /* Threads that still run inside the enclave keep it mapped */
+        if (!stopped)
+            OE_TRACE_ERROR("enclave threads did not exit, enclave leaked\n");
+        else if (built)
+            _release_enclave(enclave);
+        else
+        {
+            oe_free_call_statistics(enclave->call_statistics);
+            free(enclave);
+        }
     }
 
     oe_sgx_cleanup_load_context(&context);
@@ -778,55 +976,12 @@ oe_result_t oe_terminate_enclave(oe_enclave_t* enclave)
     if (!enclave || enclave->magic != ENCLAVE_MAGIC)
         OE_RAISE(OE_INVALID_PARAMETER);
 
+    OE_CHECK(_stop_enclave_threads(enclave));
+
     /* Call the enclave destructor */
     OE_CHECK(oe_ecall(enclave, OE_ECALL_DESTRUCTOR, 0, NULL));
 
-    if (enclave->debug_enclave)
-    {
-        oe_debug_notify_enclave_terminated(enclave->debug_enclave);
-        free(enclave->debug_enclave->tcs_array);
-        free(enclave->debug_enclave);
-    }
-
-    /* Once the enclave destructor has been invoked, the enclave memory
-     * and data structures are freed on a best effort basis from here on */
-
-    /* Remove this enclave from the global list. */
-    oe_remove_enclave_instance(enclave);
-
-    /* Clear the magic number */
-    enclave->magic = 0;
-
-    oe_mutex_lock(&enclave->lock);
-    {
-        /* Unmap the enclave memory region.
-         * Track failures reported by the platform, but do not exit early */
-        result = oe_sgx_delete_enclave(enclave);
-
-#if defined(_WIN32)
-
-        /* Release Windows events created during enclave creation */
-        for (size_t i = 0; i < enclave->num_bindings; i++)
-        {
-            ThreadBinding* binding = &enclave->bindings[i];
-            CloseHandle(binding->event.handle);
-        }
-
-#endif
-
-        /* Free the path name of the enclave image file */
-        free(enclave->path);
-    }
-    /* Release and destroy the mutex object */
-    oe_mutex_unlock(&enclave->lock);
-    oe_mutex_destroy(&enclave->lock);
-
-    /* Clear the contents of the enclave structure */
-
-    memset(enclave, 0, sizeof(oe_enclave_t));
-
-    /* Free the enclave structure */
-    free(enclave);
+    result = _release_enclave(enclave);
 
 done:
     return result;
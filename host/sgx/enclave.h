@@ -124,6 +124,24 @@ struct _oe_enclave
 
     /* Meta-data needed by debugrt  */
     oe_debug_enclave_t* debug_enclave;
+
+    /* Switchless call worker threads (NULL if switchless calls are off) */
+    struct _oe_switchless_call_manager* switchless_manager;
+
+    /* Bit i is set while bindings[i] is assigned to a host thread */
+    volatile uint64_t busy_bindings;
+
+    /* Per-function call statistics (NULL unless collection is enabled) */
+    struct _oe_call_statistics_table* call_statistics;
+
+    /* Threads of oe_call_enclave_function_async() (NULL until first used) */
+    struct _oe_async_call_pool* async_call_pool;
+
+    /* Host threads donated to oe_parallel_for() (NULL if there are none) */
+    struct _oe_parallel_workers* parallel_workers;
+
+    /* Host threads spawned for oe_thread_create() that have not exited */
+    volatile uint64_t num_enclave_threads;
 };
 
 // Static asserts for consistency with
@@ -146,4 +164,7 @@ OE_STATIC_ASSERT(
 /* Get the event for the given TCS */
 EnclaveEvent* GetEnclaveEvent(oe_enclave_t* enclave, uint64_t tcs);
 
+/* Wait for the threads spawned for oe_thread_create() to exit */
+oe_result_t oe_sgx_wait_for_enclave_threads(oe_enclave_t* enclave);
+
 #endif /* _OE_HOST_ENCLAVE_H */
@@ -5,6 +5,7 @@
 #include <stdio.h>
 
 #if defined(__linux__)
+#include <errno.h>
 #include <linux/futex.h>
 #include <stdlib.h>
 #include <sys/syscall.h>
@@ -103,6 +104,103 @@ void oe_thread_wake_wait_ocall(
 #endif
 }
 
+/* Like HandleThreadWait(), but gives up at the deadline (in nanoseconds
+ * since the Epoch). Returns OE_TIMEDOUT if the thread was not woken. */
+static oe_result_t _handle_thread_timed_wait(
+    oe_enclave_t* enclave,
+    uint64_t tcs,
+    uint64_t deadline)
+{
+    EnclaveEvent* event = GetEnclaveEvent(enclave, tcs);
+    assert(event);
+
+#if defined(__linux__)
+
+    if (__sync_fetch_and_add(&event->value, (uint32_t)-1) == 0)
+    {
+        const struct timespec ts = {
+            .tv_sec = (time_t)(deadline / 1000000000),
+            .tv_nsec = (long)(deadline % 1000000000),
+        };
+
+        do
+        {
+            /* FUTEX_WAIT_BITSET takes an absolute timeout, so spurious wakes
+             * do not extend the wait */
+            if (syscall(
+                    __NR_futex,
+                    &event->value,
+                    FUTEX_WAIT_BITSET_PRIVATE | FUTEX_CLOCK_REALTIME,
+                    -1,
+                    &ts,
+                    NULL,
+                    FUTEX_BITSET_MATCH_ANY) == -1 &&
+                errno == ETIMEDOUT)
+            {
+                /* Withdraw the wait, unless a wake raced with the timeout,
+                 * in which case it has set event->value back to zero */
+                if (__sync_bool_compare_and_swap(
+                        &event->value, (uint32_t)-1, 0))
+                    return OE_TIMEDOUT;
+            }
+        } while (event->value == (uint32_t)-1);
+    }
+
+#elif defined(_WIN32)
+
+    FILETIME ft;
+    uint64_t now;
+    DWORD msec = 0;
+
+    /* FILETIME counts 100-nanosecond intervals since 1601-01-01 */
+    GetSystemTimePreciseAsFileTime(&ft);
+    now = ((((uint64_t)ft.dwHighDateTime << 32) | ft.dwLowDateTime) -
+           116444736000000000ULL) *
+          100;
+
+    if (deadline > now)
+    {
+        const uint64_t remaining = (deadline - now + 999999) / 1000000;
+        msec = remaining < INFINITE ? (DWORD)remaining : INFINITE - 1;
+    }
+
+    /* A wake that races with the timeout leaves the event set, which makes
+     * the next wait return early; waiters recheck their condition. */
+    if (WaitForSingleObject(event->handle, msec) == WAIT_TIMEOUT)
+        return OE_TIMEDOUT;
+
+#endif
+
+    return OE_OK;
+}
+
+oe_result_t oe_thread_timedwait_ocall(
+    oe_enclave_t* enclave,
+    uint64_t waiter_tcs,
+    uint64_t self_tcs,
+    uint64_t deadline)
+{
+    if (waiter_tcs)
+        HandleThreadWake(enclave, waiter_tcs);
+
+    return _handle_thread_timed_wait(enclave, self_tcs, deadline);
+}
+
+void oe_thread_wake_multiple_ocall(
+    oe_enclave_t* enclave,
+    const uint64_t* tcs,
+    size_t num_tcs)
+{
+    if (!tcs)
+        return;
+
+    for (size_t i = 0; i < num_tcs; i++)
+    {
+        if (tcs[i])
+            HandleThreadWake(enclave, tcs[i]);
+    }
+}
+
 oe_result_t oe_get_quote_ocall(
     const sgx_report_t* sgx_report,
     void* quote,
@@ -0,0 +1,222 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "parallel.h"
+
+#if defined(__linux__)
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include <stdlib.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trace.h>
+#include "enclave.h"
+#include "sgx_u.h"
+#include "switchless.h"
+
+/*
+**==============================================================================
+**
+** oe_parallel_workers_t:
+**
+**     Host threads donated to the enclave's parallel runtime. Each thread
+**     stays in oe_sgx_parallel_worker_ecall(), where it runs the tasks of
+**     oe_parallel_for() and oe_task_spawn() and parks inside the enclave
+**     while there are none, until oe_sgx_stop_parallel_workers_ecall().
+**
+**==============================================================================
+*/
+
+#if defined(__linux__)
+typedef pthread_t oe_parallel_thread_t;
+#elif defined(_WIN32)
+typedef HANDLE oe_parallel_thread_t;
+#endif
+
+struct _oe_parallel_workers
+{
+    oe_parallel_thread_t* threads;
+    size_t num_threads;
+};
+
+static void _parallel_worker(oe_enclave_t* enclave)
+{
+    oe_result_t result;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    /* Blocks until the workers are stopped */
+    result = oe_sgx_parallel_worker_ecall(enclave, &retval);
+
+    if (result == OE_OK)
+        result = retval;
+
+    if (result != OE_OK)
+        OE_TRACE_ERROR("parallel worker exited: %s\n", oe_result_str(result));
+}
+
+#if defined(__linux__)
+static void* _parallel_worker_thread(void* arg)
+{
+    _parallel_worker((oe_enclave_t*)arg);
+    return NULL;
+}
+#elif defined(_WIN32)
+static DWORD WINAPI _parallel_worker_thread(LPVOID arg)
+{
+    _parallel_worker((oe_enclave_t*)arg);
+    return 0;
+}
+#endif
+
+static oe_result_t _create_thread(
+    oe_parallel_thread_t* thread,
+    oe_enclave_t* enclave)
+{
+#if defined(__linux__)
+    if (pthread_create(thread, NULL, _parallel_worker_thread, enclave) != 0)
+        return OE_FAILURE;
+#elif defined(_WIN32)
+    *thread = CreateThread(NULL, 0, _parallel_worker_thread, enclave, 0, NULL);
+    if (!*thread)
+        return OE_FAILURE;
+#endif
+
+    return OE_OK;
+}
+
+static void _join_thread(oe_parallel_thread_t thread)
+{
+#if defined(__linux__)
+    pthread_join(thread, NULL);
+#elif defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#endif
+}
+
+static void _stop_workers(
+    oe_enclave_t* enclave,
+    oe_parallel_workers_t* workers)
+{
+    oe_result_t retval = OE_UNEXPECTED;
+
+    if (!workers->num_threads)
+        return;
+
+    /* Runs on the TCS that is kept free of workers */
+    if (oe_sgx_stop_parallel_workers_ecall(enclave, &retval) != OE_OK ||
+        retval != OE_OK)
+        OE_TRACE_ERROR("failed to stop the parallel workers\n");
+
+    for (size_t i = 0; i < workers->num_threads; i++)
+        _join_thread(workers->threads[i]);
+
+    workers->num_threads = 0;
+}
+
+static void _free_workers(oe_parallel_workers_t* workers)
+{
+    free(workers->threads);
+    free(workers);
+}
+
+/*
+**==============================================================================
+**
+** oe_start_parallel_workers()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_start_parallel_workers(oe_enclave_t* enclave, size_t num_workers)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_parallel_workers_t* workers = NULL;
+    size_t num_reserved = 0;
+
+    if (!enclave || enclave->parallel_workers || !num_workers)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    if (enclave->switchless_manager)
+        num_reserved = enclave->switchless_manager->num_enclave_workers;
+
+    /* Keep at least one TCS available for regular ECALLs, which also stop
+     * the workers */
+    if (num_workers + num_reserved >= enclave->num_bindings)
+        OE_RAISE_MSG(
+            OE_INVALID_PARAMETER,
+            "%zu parallel workers requested, but only %zu of the enclave's "
+            "%zu TCS are not taken by switchless workers\n",
+            num_workers,
+            enclave->num_bindings - num_reserved,
+            enclave->num_bindings);
+
+    if (!(workers = (oe_parallel_workers_t*)calloc(1, sizeof(*workers))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    workers->threads = (oe_parallel_thread_t*)calloc(
+        num_workers, sizeof(oe_parallel_thread_t));
+
+    if (!workers->threads)
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    while (workers->num_threads < num_workers)
+    {
+        OE_CHECK(
+            _create_thread(&workers->threads[workers->num_threads], enclave));
+        workers->num_threads++;
+    }
+
+    enclave->parallel_workers = workers;
+    workers = NULL;
+    result = OE_OK;
+
+done:
+
+    if (workers)
+    {
+        _stop_workers(enclave, workers);
+        _free_workers(workers);
+    }
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_stop_parallel_workers()
+**
+**==============================================================================
+*/
+
+void oe_stop_parallel_workers(oe_enclave_t* enclave)
+{
+    oe_parallel_workers_t* workers;
+
+    if (!enclave || !(workers = enclave->parallel_workers))
+        return;
+
+    _stop_workers(enclave, workers);
+    _free_workers(workers);
+
+    enclave->parallel_workers = NULL;
+}
+
+/*
+**==============================================================================
+**
+** oe_get_num_parallel_workers()
+**
+**==============================================================================
+*/
+
+size_t oe_get_num_parallel_workers(oe_enclave_t* enclave)
+{
+    if (!enclave || !enclave->parallel_workers)
+        return 0;
+
+    return enclave->parallel_workers->num_threads;
+}
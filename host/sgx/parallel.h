@@ -0,0 +1,24 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_PARALLEL_H
+#define _OE_HOST_SGX_PARALLEL_H
+
+#include <openenclave/host.h>
+
+typedef struct _oe_parallel_workers oe_parallel_workers_t;
+
+/* Donate host threads to the parallel runtime of the enclave. Each worker
+ * occupies a TCS for the lifetime of the enclave. */
+oe_result_t oe_start_parallel_workers(
+    oe_enclave_t* enclave,
+    size_t num_workers);
+
+/* Stop the workers so that their TCSs are released. Called before the
+ * enclave destructor runs. */
+void oe_stop_parallel_workers(oe_enclave_t* enclave);
+
+/* The number of TCSs held by the workers */
+size_t oe_get_num_parallel_workers(oe_enclave_t* enclave);
+
+#endif /* _OE_HOST_SGX_PARALLEL_H */
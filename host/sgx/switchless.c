@@ -0,0 +1,512 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "switchless.h"
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#pragma comment(lib, "Synchronization.lib")
+#endif
+
+#include <stdlib.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/internal/trace.h>
+#include <openenclave/internal/utils.h>
+#include "enclave.h"
+#include "sgx_u.h"
+
+/*
+**==============================================================================
+**
+** Platform helpers
+**
+**==============================================================================
+*/
+
+static void _cpu_relax(void)
+{
+#if defined(__GNUC__)
+    OE_CPU_RELAX();
+#elif defined(_MSC_VER)
+    YieldProcessor();
+#endif
+}
+
+static void _yield(void)
+{
+#if defined(__linux__)
+    sched_yield();
+#elif defined(_WIN32)
+    SwitchToThread();
+#endif
+}
+
+static void _wait_on_address(volatile uint32_t* address, uint32_t value)
+{
+#if defined(__linux__)
+    syscall(
+        __NR_futex, address, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#elif defined(_WIN32)
+    WaitOnAddress(address, &value, sizeof(value), INFINITE);
+#endif
+}
+
+static void _wake_address(volatile uint32_t* address)
+{
+#if defined(__linux__)
+    syscall(__NR_futex, address, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#elif defined(_WIN32)
+    WakeByAddressSingle((PVOID)address);
+#endif
+}
+
+/*
+**==============================================================================
+**
+** Enclave workers
+**
+**==============================================================================
+*/
+
+static void _enclave_worker(oe_enclave_worker_context_t* context)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+
+    /* Blocks until the worker is stopped (or the enclave aborts) */
+    result = oe_sgx_switchless_enclave_worker_thread_ecall(
+        context->enclave, &retval, context);
+
+    if (result == OE_OK)
+        result = retval;
+
+    if (result != OE_OK)
+        OE_TRACE_ERROR(
+            "switchless enclave worker exited: %s\n", oe_result_str(result));
+
+    /* Let callers still waiting on this worker fall back to regular ECALLs */
+    oe_atomic_store_u32(&context->is_stopping, 1);
+}
+
+static void _host_worker(oe_host_worker_context_t* context)
+{
+    size_t idle_spins = 0;
+
+    while (!oe_atomic_load_u32(&context->is_stopping))
+    {
+        oe_call_host_function_args_t* args =
+            (oe_call_host_function_args_t*)oe_atomic_load_ptr(
+                (void* volatile*)&context->call_arg);
+
+        if (args)
+        {
+            /* Failures are reported to the enclave through args->result */
+            oe_handle_call_host_function((uint64_t)args, context->enclave);
+
+            /* Complete the handshake with the enclave */
+            oe_atomic_store_ptr((void* volatile*)&context->call_arg, NULL);
+            idle_spins = 0;
+        }
+        else if (++idle_spins < OE_SWITCHLESS_WORKER_SPIN_COUNT)
+        {
+            _cpu_relax();
+        }
+        else
+        {
+            /* Same protocol as a sleeping enclave worker. The enclave wakes
+             * this worker with oe_sgx_wake_switchless_worker_ocall(). */
+            oe_atomic_store_u32(&context->is_sleeping, 1);
+
+            for (;;)
+            {
+                oe_atomic_store_u32(&context->event, 0);
+
+                if (oe_atomic_load_ptr((void* volatile*)&context->call_arg) ||
+                    oe_atomic_load_u32(&context->is_stopping))
+                    break;
+
+                _wait_on_address(&context->event, 0);
+            }
+
+            oe_atomic_store_u32(&context->is_sleeping, 0);
+            idle_spins = 0;
+        }
+    }
+}
+
+#if defined(__linux__)
+typedef void* (*oe_switchless_thread_start_t)(void*);
+
+static void* _enclave_worker_thread(void* arg)
+{
+    _enclave_worker((oe_enclave_worker_context_t*)arg);
+    return NULL;
+}
+
+static void* _host_worker_thread(void* arg)
+{
+    _host_worker((oe_host_worker_context_t*)arg);
+    return NULL;
+}
+#elif defined(_WIN32)
+typedef LPTHREAD_START_ROUTINE oe_switchless_thread_start_t;
+
+static DWORD WINAPI _enclave_worker_thread(LPVOID arg)
+{
+    _enclave_worker((oe_enclave_worker_context_t*)arg);
+    return 0;
+}
+
+static DWORD WINAPI _host_worker_thread(LPVOID arg)
+{
+    _host_worker((oe_host_worker_context_t*)arg);
+    return 0;
+}
+#endif
+
+static oe_result_t _create_thread(
+    oe_switchless_thread_t* thread,
+    oe_switchless_thread_start_t start_routine,
+    void* arg)
+{
+#if defined(__linux__)
+    if (pthread_create(thread, NULL, start_routine, arg) != 0)
+        return OE_FAILURE;
+#elif defined(_WIN32)
+    *thread = CreateThread(NULL, 0, start_routine, arg, 0, NULL);
+    if (!*thread)
+        return OE_FAILURE;
+#endif
+
+    return OE_OK;
+}
+
+static void _join_thread(oe_switchless_thread_t thread)
+{
+#if defined(__linux__)
+    pthread_join(thread, NULL);
+#elif defined(_WIN32)
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#endif
+}
+
+static void _wake_enclave_worker(oe_enclave_worker_context_t* context)
+{
+    /* Pairs with the sleeping worker storing is_sleeping before it checks its
+     * slot, so either it sees the new call or we see it sleeping. */
+    if (oe_atomic_load_u32(&context->is_sleeping))
+    {
+        oe_atomic_store_u32(&context->event, 1);
+        _wake_address(&context->event);
+    }
+}
+
+void oe_sgx_sleep_switchless_worker_ocall(oe_enclave_worker_context_t* context)
+{
+    if (!context)
+        return;
+
+    oe_atomic_store_u32(&context->is_sleeping, 1);
+
+    for (;;)
+    {
+        /* Reset the event before looking for work so that a wake issued
+         * after the check below is not lost. */
+        oe_atomic_store_u32(&context->event, 0);
+
+        if (oe_atomic_load_ptr((void* volatile*)&context->call_arg) ||
+            oe_atomic_load_u32(&context->is_stopping))
+            break;
+
+        _wait_on_address(&context->event, 0);
+    }
+
+    oe_atomic_store_u32(&context->is_sleeping, 0);
+}
+
+void oe_sgx_wake_switchless_worker_ocall(oe_host_worker_context_t* context)
+{
+    if (!context)
+        return;
+
+    oe_atomic_store_u32(&context->event, 1);
+    _wake_address(&context->event);
+}
+
+/* Ask a worker to exit and wake it if it is sleeping */
+static void _signal_stop(
+    volatile uint32_t* is_stopping,
+    volatile uint32_t* event)
+{
+    oe_atomic_store_u32(is_stopping, 1);
+    oe_atomic_store_u32(event, 1);
+    _wake_address(event);
+}
+
+static void _stop_enclave_workers(oe_switchless_call_manager_t* manager)
+{
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+    {
+        oe_enclave_worker_context_t* context =
+            &manager->enclave_worker_contexts[i];
+
+        _signal_stop(&context->is_stopping, &context->event);
+    }
+
+    for (size_t i = 0; i < manager->num_enclave_workers; i++)
+        _join_thread(manager->enclave_worker_threads[i]);
+
+    manager->num_enclave_workers = 0;
+}
+
+static void _stop_host_workers(oe_switchless_call_manager_t* manager)
+{
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+    {
+        oe_host_worker_context_t* context = &manager->host_worker_contexts[i];
+
+        _signal_stop(&context->is_stopping, &context->event);
+    }
+
+    for (size_t i = 0; i < manager->num_host_workers; i++)
+        _join_thread(manager->host_worker_threads[i]);
+
+    manager->num_host_workers = 0;
+}
+
+static void _free_manager(oe_switchless_call_manager_t* manager)
+{
+    free(manager->enclave_worker_contexts);
+    free(manager->enclave_worker_threads);
+    free(manager->host_worker_contexts);
+    free(manager->host_worker_threads);
+    free(manager);
+}
+
+/*
+**==============================================================================
+**
+** oe_start_switchless_manager()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_start_switchless_manager(
+    oe_enclave_t* enclave,
+    size_t num_enclave_workers,
+    size_t num_host_workers)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    oe_result_t retval = OE_UNEXPECTED;
+    oe_switchless_call_manager_t* manager = NULL;
+
+    if (!enclave || enclave->switchless_manager)
+        OE_RAISE(OE_INVALID_PARAMETER);
+
+    /* Each enclave worker permanently occupies a TCS. Keep at least one TCS
+     * available for regular ECALLs. */
+    if (num_enclave_workers >= enclave->num_bindings)
+        OE_RAISE_MSG(
+            OE_INVALID_PARAMETER,
+            "%zu switchless enclave workers requested, but the enclave only "
+            "has %zu TCS\n",
+            num_enclave_workers,
+            enclave->num_bindings);
+
+    if (!(manager = (oe_switchless_call_manager_t*)calloc(1, sizeof(*manager))))
+        OE_RAISE(OE_OUT_OF_MEMORY);
+
+    if (num_enclave_workers)
+    {
+        manager->enclave_worker_contexts = (oe_enclave_worker_context_t*)calloc(
+            num_enclave_workers, sizeof(oe_enclave_worker_context_t));
+        manager->enclave_worker_threads = (oe_switchless_thread_t*)calloc(
+            num_enclave_workers, sizeof(oe_switchless_thread_t));
+
+        if (!manager->enclave_worker_contexts ||
+            !manager->enclave_worker_threads)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    if (num_host_workers)
+    {
+        manager->host_worker_contexts = (oe_host_worker_context_t*)calloc(
+            num_host_workers, sizeof(oe_host_worker_context_t));
+        manager->host_worker_threads = (oe_switchless_thread_t*)calloc(
+            num_host_workers, sizeof(oe_switchless_thread_t));
+
+        if (!manager->host_worker_contexts || !manager->host_worker_threads)
+            OE_RAISE(OE_OUT_OF_MEMORY);
+    }
+
+    /* Start the host workers first so that switchless OCALLs made by the
+     * first switchless ECALLs can be serviced */
+    while (manager->num_host_workers < num_host_workers)
+    {
+        size_t i = manager->num_host_workers;
+
+        manager->host_worker_contexts[i].enclave = enclave;
+
+        OE_CHECK(_create_thread(
+            &manager->host_worker_threads[i],
+            _host_worker_thread,
+            &manager->host_worker_contexts[i]));
+
+        manager->num_host_workers++;
+    }
+
+    if (num_host_workers)
+    {
+        OE_CHECK(oe_sgx_init_switchless_host_workers_ecall(
+            enclave,
+            &retval,
+            manager->host_worker_contexts,
+            num_host_workers));
+        OE_CHECK(retval);
+    }
+
+    while (manager->num_enclave_workers < num_enclave_workers)
+    {
+        size_t i = manager->num_enclave_workers;
+
+        manager->enclave_worker_contexts[i].enclave = enclave;
+
+        OE_CHECK(_create_thread(
+            &manager->enclave_worker_threads[i],
+            _enclave_worker_thread,
+            &manager->enclave_worker_contexts[i]));
+
+        manager->num_enclave_workers++;
+    }
+
+    enclave->switchless_manager = manager;
+    manager = NULL;
+    result = OE_OK;
+
+done:
+
+    if (manager)
+    {
+        /* Stop any workers that did start. If the enclave already knows the
+         * host workers, their stopped contexts make it fall back to regular
+         * OCALLs, so the contexts are leaked rather than freed. */
+        _stop_enclave_workers(manager);
+        _stop_host_workers(manager);
+
+        if (retval == OE_OK)
+        {
+            manager->host_worker_contexts = NULL;
+            manager->num_host_workers = 0;
+        }
+
+        _free_manager(manager);
+    }
+
+    return result;
+}
+
+/*
+**==============================================================================
+**
+** oe_stop_switchless_enclave_workers()
+**
+**==============================================================================
+*/
+
+void oe_stop_switchless_enclave_workers(oe_enclave_t* enclave)
+{
+    if (enclave && enclave->switchless_manager)
+        _stop_enclave_workers(enclave->switchless_manager);
+}
+
+/*
+**==============================================================================
+**
+** oe_stop_switchless_manager()
+**
+**==============================================================================
+*/
+
+void oe_stop_switchless_manager(oe_enclave_t* enclave)
+{
+    oe_switchless_call_manager_t* manager;
+
+    if (!enclave || !(manager = enclave->switchless_manager))
+        return;
+
+    _stop_enclave_workers(manager);
+    _stop_host_workers(manager);
+    _free_manager(manager);
+
+    enclave->switchless_manager = NULL;
+}
+
+/*
+**==============================================================================
+**
+** oe_post_switchless_ecall()
+**
+**==============================================================================
+*/
+
+oe_result_t oe_post_switchless_ecall(
+    oe_switchless_call_manager_t* manager,
+    oe_call_enclave_function_args_t* args)
+{
+    oe_enclave_worker_context_t* context = NULL;
+    size_t num_workers;
+    uint64_t start;
+
+    if (!manager || !(num_workers = manager->num_enclave_workers))
+        return OE_BUSY;
+
+    /* Spread callers over the workers, then try each worker at most once */
+    start = oe_atomic_increment(&manager->next_enclave_worker);
+
+    for (size_t i = 0; i < num_workers; i++)
+    {
+        oe_enclave_worker_context_t* candidate =
+            &manager->enclave_worker_contexts[(start + i) % num_workers];
+
+        if (candidate->call_arg == NULL &&
+            !oe_atomic_load_u32(&candidate->is_stopping) &&
+            oe_atomic_compare_and_swap_ptr(
+                (void* volatile*)&candidate->call_arg, NULL, args))
+        {
+            context = candidate;
+            break;
+        }
+    }
+
+    if (!context)
+        return OE_BUSY;
+
+    _wake_enclave_worker(context);
+
+    /* The worker clears its slot once the call has completed */
+    for (uint64_t spins = 0;
+         oe_atomic_load_ptr((void* volatile*)&context->call_arg) == args;
+         spins++)
+    {
+        /* The worker exited without picking up the call */
+        if (oe_atomic_load_u32(&context->is_stopping) &&
+            oe_atomic_compare_and_swap_ptr(
+                (void* volatile*)&context->call_arg, args, NULL))
+            return OE_BUSY;
+
+        if (spins < OE_SWITCHLESS_WORKER_SPIN_COUNT)
+            _cpu_relax();
+        else
+            _yield();
+    }
+
+    return OE_OK;
+}
@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOST_SGX_SWITCHLESS_H
+#define _OE_HOST_SGX_SWITCHLESS_H
+
+#include <openenclave/internal/switchless.h>
+
+#if defined(__linux__)
+#include <pthread.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+#if defined(__linux__)
+typedef pthread_t oe_switchless_thread_t;
+#elif defined(_WIN32)
+typedef HANDLE oe_switchless_thread_t;
+#endif
+
+/*
+**==============================================================================
+**
+** oe_switchless_call_manager_t:
+**
+**     Host-side bookkeeping for the switchless worker threads of an enclave.
+**     The worker contexts are shared with the enclave; the thread handles
+**     are only known to the host.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_switchless_call_manager
+{
+    /* Enclave workers (host threads parked inside the enclave) */
+    oe_enclave_worker_context_t* enclave_worker_contexts;
+    oe_switchless_thread_t* enclave_worker_threads;
+    size_t num_enclave_workers;
+
+    /* Index of the worker that the next switchless ECALL tries first */
+    volatile uint64_t next_enclave_worker;
+
+    /* Host workers (host threads that service switchless OCALLs) */
+    oe_host_worker_context_t* host_worker_contexts;
+    oe_switchless_thread_t* host_worker_threads;
+    size_t num_host_workers;
+} oe_switchless_call_manager_t;
+
+/* Start the switchless worker threads for the given enclave */
+oe_result_t oe_start_switchless_manager(
+    oe_enclave_t* enclave,
+    size_t num_enclave_workers,
+    size_t num_host_workers);
+
+/* Stop the enclave workers so that their TCSs are released. Called before the
+ * enclave destructor runs. */
+void oe_stop_switchless_enclave_workers(oe_enclave_t* enclave);
+
+/* Stop all switchless worker threads and release the manager. Called after
+ * the enclave destructor, which may still make switchless OCALLs. */
+void oe_stop_switchless_manager(oe_enclave_t* enclave);
+
+/* Hand the ECALL to an idle enclave worker and wait for it to complete.
+ * Returns OE_BUSY if no worker accepted the call, in which case the caller
+ * falls back to a regular ECALL. */
+oe_result_t oe_post_switchless_ecall(
+    oe_switchless_call_manager_t* manager,
+    oe_call_enclave_function_args_t* args);
+
+/* Dispatch the oe_call_host_function_args_t at the given address to its
+ * OCALL. Used by regular OCALLs and by the switchless host workers. */
+oe_result_t oe_handle_call_host_function(uint64_t arg, oe_enclave_t* enclave);
+
+#endif /* _OE_HOST_SGX_SWITCHLESS_H */
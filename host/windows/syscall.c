@@ -208,6 +208,63 @@ oe_off_t oe_syscall_lseek_ocall(oe_host_fd_t fd, oe_off_t offset, int whence)
     PANIC;
 }
 
+ssize_t oe_syscall_pread_ocall(
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+ssize_t oe_syscall_pwrite_ocall(
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+ssize_t oe_syscall_preadv_ocall(
+    oe_host_fd_t fd,
+    void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+ssize_t oe_syscall_pwritev_ocall(
+    oe_host_fd_t fd,
+    const void* iov_buf,
+    int iovcnt,
+    size_t iov_buf_size,
+    oe_off_t offset)
+{
+    PANIC;
+}
+
+ssize_t oe_syscall_sendfile_ocall(
+    oe_host_fd_t out_fd,
+    oe_host_fd_t in_fd,
+    oe_off_t offset,
+    size_t count)
+{
+    PANIC;
+}
+
+int oe_syscall_fsync_ocall(oe_host_fd_t fd)
+{
+    return _commit((int)fd);
+}
+
+int oe_syscall_fdatasync_ocall(oe_host_fd_t fd)
+{
+    return _commit((int)fd);
+}
+
 int oe_syscall_close_ocall(oe_host_fd_t fd)
 {
     return _close(fd);
@@ -249,7 +306,10 @@ uint64_t oe_syscall_opendir_ocall(const char* pathname)
     PANIC;
 }
 
-int oe_syscall_readdir_ocall(uint64_t dirp, struct oe_dirent* entry)
+ssize_t oe_syscall_readdir_batch_ocall(
+    uint64_t dirp,
+    struct oe_dirent* entries,
+    size_t count)
 {
     PANIC;
 }
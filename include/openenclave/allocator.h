@@ -0,0 +1,103 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/**
+ * @file allocator.h
+ *
+ * This file defines the interface between the enclave runtime and the
+ * allocator that backs malloc(), free() and the related functions.
+ *
+ * By default, the runtime uses its built-in allocator (dlmalloc). An enclave
+ * replaces it by defining **all** of the functions below; the definitions
+ * linked into the enclave take precedence over the defaults, which are weak
+ * symbols of oecore. Defining only some of them is not supported.
+ *
+ * A replacement allocator obtains its memory either from the heap range that
+ * is passed to oe_allocator_init() or by calling oe_sbrk(), but not both.
+ * The functions must be thread-safe, must not call malloc() or any other
+ * function that allocates, and must not make OCALLs.
+ *
+ * Apart from the built-in allocator, the runtime does not call oe_sbrk(): it
+ * obtains its own memory, including the entries of functions registered with
+ * atexit(), through the functions below.
+ *
+ * The debug allocator (**USE_DEBUG_MALLOC**) and the heap profiler
+ * (**USE_HEAP_PROFILER**) keep working on top of a replacement allocator.
+ * Statistics that describe the internals of the built-in allocator are not
+ * available once it is replaced: oe_get_heap_stats() and
+ * oe_get_malloc_stats() return OE_UNSUPPORTED.
+ */
+#ifndef _OE_ALLOCATOR_H
+#define _OE_ALLOCATOR_H
+
+#ifdef _OE_HOST_H
+#error "allocator.h must not be included in host code."
+#endif
+
+#include "bits/defs.h"
+#include "bits/types.h"
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Initialize the allocator.
+ *
+ * Called once, before global constructors run and before any other
+ * function of the allocator is called.
+ *
+ * @param heap_start_address The first byte of the heap of the enclave.
+ * @param heap_end_address The byte past the end of the heap of the enclave.
+ */
+void oe_allocator_init(void* heap_start_address, void* heap_end_address);
+
+/**
+ * Release the resources of the allocator.
+ *
+ * Called once, when the enclave is terminated, after all finalization
+ * functions have run. No function of the allocator is called afterwards.
+ */
+void oe_allocator_cleanup(void);
+
+/**
+ * Allocate **size** bytes, with the semantics of malloc().
+ */
+void* oe_allocator_malloc(size_t size);
+
+/**
+ * Release a block, with the semantics of free().
+ */
+void oe_allocator_free(void* ptr);
+
+/**
+ * Allocate a zero-filled array, with the semantics of calloc().
+ */
+void* oe_allocator_calloc(size_t nmemb, size_t size);
+
+/**
+ * Resize a block, with the semantics of realloc().
+ */
+void* oe_allocator_realloc(void* ptr, size_t size);
+
+/**
+ * Allocate an aligned block, with the semantics of memalign().
+ */
+void* oe_allocator_memalign(size_t alignment, size_t size);
+
+/**
+ * Allocate an aligned block, with the semantics of posix_memalign().
+ */
+int oe_allocator_posix_memalign(
+    void** memptr,
+    size_t alignment,
+    size_t size);
+
+/**
+ * Move the end of the part of the heap handed out to the allocator by
+ * **increment** bytes (negative to give memory back) and return the previous
+ * end, or (void*)-1 when the heap is exhausted.
+ */
+void* oe_sbrk(intptr_t increment);
+
+OE_EXTERNC_END
+
+#endif /* _OE_ALLOCATOR_H */
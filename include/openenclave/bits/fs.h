@@ -25,6 +25,12 @@ OE_EXTERNC_BEGIN
  */
 #define OE_HOST_FILE_SYSTEM "oe_host_file_system"
 
+/**
+ * Name of the file system that keeps its files in enclave memory (passed to
+ * **mount()** as the **filesystemtype** parameter).
+ */
+#define OE_RAM_FILE_SYSTEM "oe_ram_file_system"
+
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_FS_H */
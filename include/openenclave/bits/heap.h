@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/**
+ * @file heap.h
+ *
+ * This file defines the heap statistics of an enclave, which can be obtained
+ * inside the enclave with oe_get_heap_stats() and from the host with
+ * oe_get_enclave_heap_stats().
+ */
+
+#ifndef _OE_BITS_HEAP_H
+#define _OE_BITS_HEAP_H
+
+#include "defs.h"
+#include "types.h"
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Number of buckets in oe_heap_stats_t.free_chunk_histogram.
+ */
+#define OE_HEAP_STATS_NUM_BUCKETS 32
+
+/**
+ * Statistics of the enclave heap.
+ *
+ * The heap is a fixed region of **heap_size** bytes (set by the
+ * **num_heap_pages** enclave property). The allocator grows into it with
+ * oe_sbrk(); **peak_sbrk_bytes** is therefore the part of the region the
+ * enclave has needed so far.
+ */
+typedef struct _oe_heap_stats
+{
+    /** Size of the heap region of the enclave */
+    uint64_t heap_size;
+
+    /** Bytes of the heap region currently obtained by the allocator */
+    uint64_t sbrk_bytes;
+
+    /** Highest value **sbrk_bytes** has reached */
+    uint64_t peak_sbrk_bytes;
+
+    /** Bytes currently managed by the allocator (same as sbrk_bytes unless
+     * memory was trimmed) */
+    uint64_t system_bytes;
+
+    /** Highest value **system_bytes** has reached */
+    uint64_t peak_system_bytes;
+
+    /** Bytes in allocated blocks, including allocator overhead */
+    uint64_t in_use_bytes;
+
+    /** Bytes in free blocks, including the top chunk */
+    uint64_t free_bytes;
+
+    /** Size of the top chunk, the free space at the end of the heap that
+     * is not fragmented by allocated blocks */
+    uint64_t top_chunk_bytes;
+
+    /** Number of free chunks, excluding the top chunk */
+    uint64_t num_free_chunks;
+
+    /** Size of the largest free chunk, excluding the top chunk */
+    uint64_t largest_free_chunk_bytes;
+
+    /** Number of free chunks (excluding the top chunk) by size: bucket i
+     * counts the chunks of 2^i to 2^(i+1) - 1 usable bytes */
+    uint64_t free_chunk_histogram[OE_HEAP_STATS_NUM_BUCKETS];
+} oe_heap_stats_t;
+
+OE_EXTERNC_END
+
+#endif /* _OE_BITS_HEAP_H */
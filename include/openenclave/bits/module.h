@@ -74,6 +74,19 @@ oe_result_t oe_load_module_host_resolver(void);
  * @retval OE_FAILURE Module failed to load.
  */
 oe_result_t oe_load_module_host_epoll(void);
+
+/**
+ * Load the RAM file system module.
+ *
+ * This function loads the RAM file system module, which keeps files in
+ * enclave memory. Each mount of this file system (see **OE_RAM_FILE_SYSTEM**)
+ * starts empty, and its files are lost when it is unmounted.
+ *
+ * @retval OE_OK The module was successfully loaded.
+ * @retval OE_FAILURE Module failed to load.
+ * @retval OE_OUT_OF_MEMORY Insufficient memory to load the module.
+ */
+oe_result_t oe_load_module_ram_file_system(void);
 OE_EXTERNC_END
 
 #endif /* _OE_BITS_MODULE_H */
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/**
+ * @file parallel.h
+ *
+ * This file defines the parallel runtime of an enclave: task groups and
+ * oe_parallel_for().
+ *
+ * Tasks run on host threads donated to the enclave when it is created (see
+ * oe_enclave_config_t.num_parallel_workers), and on the threads that wait
+ * for them. Each worker has a deque of tasks: it runs the newest task of
+ * its own deque first and steals the oldest task of another deque when its
+ * own is empty. Tasks spawned by threads that are not workers go to a
+ * shared queue. Idle workers park inside the enclave.
+ *
+ * Without workers, or once they are stopped, the waiting threads run all
+ * the tasks themselves, so the functions below always complete.
+ */
+
+#ifndef _OE_BITS_PARALLEL_H
+#define _OE_BITS_PARALLEL_H
+
+#include "defs.h"
+#include "result.h"
+#include "types.h"
+
+OE_EXTERNC_BEGIN
+
+/**
+ * A group of tasks that can be waited for together.
+ */
+typedef struct _oe_task_group
+{
+    uint64_t __impl[2]; /**< Internal private implementation */
+} oe_task_group_t;
+
+/**
+ * @cond DEV
+ */
+#define OE_TASK_GROUP_INITIALIZER \
+    {                             \
+        {                         \
+            0                     \
+        }                         \
+    }
+/**
+ * @endcond
+ */
+
+/**
+ * Initialize a task group.
+ *
+ * @param group Initialize this task group.
+ *
+ * @return OE_OK the operation was successful
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ *
+ */
+oe_result_t oe_task_group_init(oe_task_group_t* group);
+
+/**
+ * Run a function as a task of the given group.
+ *
+ * The task may run on any worker, or on a thread that waits for a task
+ * group. It runs on the calling thread before this function returns if it
+ * cannot be queued.
+ *
+ * @param group Add the task to this task group.
+ * @param func The function that the task calls.
+ * @param arg The argument passed to **func**.
+ *
+ * @return OE_OK the task was queued or has run
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ * @return OE_OUT_OF_MEMORY insufficient memory exists to queue the task
+ *
+ */
+oe_result_t oe_task_spawn(
+    oe_task_group_t* group,
+    void (*func)(void* arg),
+    void* arg);
+
+/**
+ * Wait for all the tasks of a group to finish.
+ *
+ * While it waits, the calling thread runs queued tasks of any group.
+ * Tasks may spawn tasks into the group that is being waited for.
+ *
+ * @param group Wait for the tasks of this group.
+ *
+ * @return OE_OK the tasks have finished
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ *
+ */
+oe_result_t oe_task_group_wait(oe_task_group_t* group);
+
+/**
+ * Call **body** for the subranges of [**begin**, **end**) in parallel.
+ *
+ * The range is split into chunks of **grain** indices (the last one may be
+ * shorter), and **body(chunk_begin, chunk_end, arg)** is called once for
+ * each chunk, in no particular order, before this function returns.
+ *
+ * @param begin The first index of the range.
+ * @param end The index past the last index of the range.
+ * @param grain The number of indices per chunk, or zero to let the runtime
+ *        choose it from the number of workers.
+ * @param body The function called for each chunk.
+ * @param arg The argument passed to **body**.
+ *
+ * @return OE_OK all the chunks have been processed
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ * @return OE_OUT_OF_MEMORY insufficient memory exists to split the range
+ *
+ */
+oe_result_t oe_parallel_for(
+    size_t begin,
+    size_t end,
+    size_t grain,
+    void (*body)(size_t begin, size_t end, void* arg),
+    void* arg);
+
+OE_EXTERNC_END
+
+#endif /* _OE_BITS_PARALLEL_H */
@@ -64,7 +64,7 @@ typedef struct _oe_pthread_rwlockattr
 
 typedef struct _oe_pthread_rwlock
 {
-    uint64_t __private[5];
+    uint64_t __private[6];
 } oe_pthread_rwlock_t;
 
 oe_pthread_t oe_pthread_self(void);
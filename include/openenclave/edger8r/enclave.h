@@ -112,6 +112,101 @@ oe_result_t oe_switchless_call_host_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * The maximum number of host function calls in an OCALL batch.
+ */
+#define OE_OCALL_BATCH_MAX_CALLS 16
+
+/**
+ * A batch of host function calls that is submitted with a single OCALL.
+ *
+ * A batch is initialized with oe_ocall_batch_begin(), filled with
+ * oe_ocall_batch_add() and run with oe_ocall_batch_submit(). After the
+ * batch has been submitted, the result and the number of bytes written by
+ * each call are available in the calls array. Batches are only supported
+ * in SGX enclaves; elsewhere these functions return OE_UNSUPPORTED.
+ */
+typedef struct _oe_ocall_batch
+{
+    /** The number of calls added to the batch */
+    size_t num_calls;
+
+    /** The calls, in the order they were added */
+    struct
+    {
+        size_t function_id;
+        const void* input_buffer;
+        size_t input_buffer_size;
+        void* output_buffer;
+        size_t output_buffer_size;
+
+        /** Number of bytes written in the output buffer by the host */
+        size_t output_bytes_written;
+
+        /** Result of dispatching this call on the host */
+        oe_result_t result;
+    } calls[OE_OCALL_BATCH_MAX_CALLS];
+} oe_ocall_batch_t;
+
+/**
+ * Start a new batch of host function calls.
+ *
+ * @param batch The batch to initialize.
+ *
+ * @return OE_OK the batch was initialized.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ */
+oe_result_t oe_ocall_batch_begin(oe_ocall_batch_t* batch);
+
+/**
+ * Queue a host function call in a batch.
+ *
+ * The arguments are the same as for oe_call_host_function(). The input and
+ * output buffers must be in host memory (for example obtained with
+ * oe_allocate_ocall_buffer()) and remain valid until the batch is submitted.
+ * The calls in a batch must be independent of each other: the host runs
+ * them in order but the enclave sees none of the outputs until all of them
+ * have completed.
+ *
+ * @param batch The batch to add the call to.
+ * @param function_id The id of the host function that will be called.
+ * @param input_buffer Buffer containing inputs data.
+ * @param input_buffer_size Size of the input data buffer.
+ * @param output_buffer Buffer where the outputs of the host function are
+ * written to.
+ * @param output_buffer_size Size of the output buffer.
+ *
+ * @return OE_OK the call was added to the batch.
+ * @return OE_INVALID_PARAMETER a parameter is invalid, or a buffer is not in
+ * host memory.
+ * @return OE_OUT_OF_BOUNDS the batch already has OE_OCALL_BATCH_MAX_CALLS
+ * calls.
+ */
+oe_result_t oe_ocall_batch_add(
+    oe_ocall_batch_t* batch,
+    size_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size);
+
+/**
+ * Run all the calls of a batch with a single transition to the host.
+ *
+ * As with oe_call_host_function(), the return value only indicates whether
+ * the batch reached the host. The outcome of each call is returned in its
+ * result field and, on success, its output_bytes_written field. A call
+ * whose byte count exceeds its output buffer reports OE_UNEXPECTED.
+ *
+ * @param batch The batch to submit.
+ *
+ * @return OE_OK the batch was run by the host.
+ * @return OE_INVALID_PARAMETER a parameter is invalid.
+ * @return OE_OUT_OF_MEMORY the call arguments could not be allocated.
+ * @return OE_FAILURE the OCALL failed.
+ */
+oe_result_t oe_ocall_batch_submit(oe_ocall_batch_t* batch);
+
 /**
  * Allocate a buffer of given size for doing an ocall.
  *
@@ -78,6 +78,86 @@ oe_result_t oe_switchless_call_enclave_function(
     size_t output_buffer_size,
     size_t* output_bytes_written);
 
+/**
+ * Handle of an ECALL started with oe_call_enclave_function_async().
+ */
+typedef struct _oe_call_handle oe_call_handle_t;
+
+/**
+ * Function invoked when an ECALL started with
+ * oe_call_enclave_function_async() completes.
+ *
+ * It runs on an internal host thread and must not block for long, since the
+ * thread is needed to run further asynchronous ECALLs.
+ *
+ * @param result The result that oe_call_enclave_function() would have
+ * returned.
+ * @param output_bytes_written Number of bytes written in the output buffer.
+ * @param context The **completion_context** passed when starting the call.
+ */
+typedef void (*oe_call_completion_t)(
+    oe_result_t result,
+    size_t output_bytes_written,
+    void* context);
+
+/**
+ * Perform a high-level enclave function call (ECALL) asynchronously.
+ *
+ * The call is queued and run by one of the enclave's internal host threads.
+ * There is one such thread per TCS available to the host, so the number of
+ * ECALLs in flight is bounded by the enclave's TCS count rather than by the
+ * number of threads of the caller. Calls are started in the order in which
+ * they are queued.
+ *
+ * Completion is reported through **completion**, through **handle**, or
+ * both. When **handle** is requested, the caller must pass it to
+ * oe_wait_enclave_function_async() exactly once, before the enclave is
+ * terminated. The input and output buffers must remain valid until the call
+ * has completed.
+ *
+ * @param enclave The enclave to call.
+ * @param function_id The id of the enclave function that will be called.
+ * @param input_buffer Buffer containing inputs data.
+ * @param input_buffer_size Size of the input data buffer.
+ * @param output_buffer Buffer where the outputs of the enclave function are
+ * written to.
+ * @param output_buffer_size Size of the output buffer.
+ * @param completion Optional function to invoke when the call completes.
+ * @param completion_context Argument passed to **completion**.
+ * @param handle Optional pointer that receives the handle of the call.
+ *
+ * @return OE_OK the call was queued.
+ * @return OE_INVALID_PARAMETER a parameter is invalid, or neither
+ * **completion** nor **handle** was given.
+ * @return OE_OUT_OF_MEMORY the call could not be queued.
+ * @return OE_UNSUPPORTED asynchronous calls are not supported for this
+ * enclave type.
+ */
+oe_result_t oe_call_enclave_function_async(
+    oe_enclave_t* enclave,
+    uint32_t function_id,
+    const void* input_buffer,
+    size_t input_buffer_size,
+    void* output_buffer,
+    size_t output_buffer_size,
+    oe_call_completion_t completion,
+    void* completion_context,
+    oe_call_handle_t** handle);
+
+/**
+ * Wait for an ECALL started with oe_call_enclave_function_async() to
+ * complete, and release its handle.
+ *
+ * @param handle The handle of the call.
+ * @param output_bytes_written Optional pointer that receives the number of
+ * bytes written in the output buffer.
+ *
+ * @return The result that oe_call_enclave_function() would have returned.
+ */
+oe_result_t oe_wait_enclave_function_async(
+    oe_call_handle_t* handle,
+    size_t* output_bytes_written);
+
 OE_EXTERNC_END
 
 #endif // _OE_EDGER8R_HOST_H
@@ -17,7 +17,9 @@
 #include "bits/defs.h"
 #include "bits/exception.h"
 #include "bits/fs.h"
+#include "bits/heap.h"
 #include "bits/module.h"
+#include "bits/parallel.h"
 #include "bits/properties.h"
 #include "bits/report.h"
 #include "bits/result.h"
@@ -199,6 +201,73 @@ void oe_host_free(void* ptr);
  */
 char* oe_host_strndup(const char* str, size_t n);
 
+/**
+ * Check whether the host is terminating the enclave.
+ *
+ * oe_terminate_enclave() waits for the threads created with pthread_create()
+ * to return before the enclave destructor runs, and fails if they do not.
+ * Threads that run until they are told to stop, such as detached worker
+ * loops, should poll this function and return once it is true.
+ *
+ * @returns true once oe_terminate_enclave() waits for the threads of the
+ * enclave. It is never reset.
+ */
+bool oe_is_enclave_terminating(void);
+
+/**
+ * Get statistics of the enclave heap.
+ *
+ * This function reports how much of the enclave heap is in use, how much the
+ * allocator has ever needed, and how fragmented the free memory is. It walks
+ * the whole heap while holding the allocator lock, so it should not be called
+ * on a hot path. The host can obtain the same statistics with
+ * oe_get_enclave_heap_stats().
+ *
+ * @param stats The statistics.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **stats** is null.
+ * @returns OE_UNSUPPORTED if the enclave replaced the built-in allocator
+ * (see allocator.h).
+ */
+oe_result_t oe_get_heap_stats(oe_heap_stats_t* stats);
+
+/**
+ * Start sampling heap allocations.
+ *
+ * Roughly one in every **sample_interval** bytes allocated is recorded,
+ * together with the backtrace of the allocation. The host can then write a
+ * heap profile with oe_write_enclave_heap_profile() and analyze it with
+ * pprof, which shows both the allocations still in use and all the
+ * allocations made since profiling started. The profile reveals the call
+ * sites and sizes of allocations to the host, so it is only available once
+ * the enclave has called this function.
+ *
+ * The profiler is part of **oecore** only when Open Enclave is built with
+ * USE_HEAP_PROFILER. Larger intervals lower the overhead; 512 KB is a
+ * reasonable choice for production.
+ *
+ * @param sample_interval The average number of bytes between samples.
+ *
+ * @returns OE_OK on success.
+ * @returns OE_INVALID_PARAMETER if **sample_interval** is zero or too large.
+ * @returns OE_OUT_OF_MEMORY if the profile could not be allocated.
+ * @returns OE_UNSUPPORTED if the profiler is not built in.
+ */
+oe_result_t oe_start_heap_profiling(size_t sample_interval);
+
+/**
+ * Stop sampling heap allocations.
+ *
+ * The profile is kept: the host can still obtain it, and the blocks already
+ * sampled are still removed from it when they are freed. Profiling can be
+ * resumed with oe_start_heap_profiling().
+ *
+ * @returns OE_OK on success.
+ * @returns OE_UNSUPPORTED if the profiler is not built in.
+ */
+oe_result_t oe_stop_heap_profiling(void);
+
 /**
  * Abort execution of the enclave.
  *
@@ -21,6 +21,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "bits/defs.h"
+#include "bits/heap.h"
 #include "bits/report.h"
 #include "bits/result.h"
 #include "bits/types.h"
@@ -54,6 +55,48 @@ OE_EXTERNC_BEGIN
  * @endcond
  */
 
+/**
+ * Enclave creation settings that can be passed as the **config** parameter of
+ * oe_create_enclave(). Zero-initialize the structure before setting the
+ * fields of interest; zero selects the default for every field.
+ */
+typedef struct _oe_enclave_config
+{
+    /**
+     * Number of host threads that stay inside the enclave to service ECALLs
+     * marked `transition_using_threads` without an EENTER/EEXIT. Each worker
+     * occupies one TCS for the lifetime of the enclave, so this must be
+     * smaller than the enclave's TCS count. When zero (the default),
+     * switchless ECALLs are performed as regular ECALLs.
+     */
+    uint32_t max_enclave_workers;
+
+    /**
+     * Number of host threads that service OCALLs marked
+     * `transition_using_threads` while the calling enclave thread spins,
+     * instead of exiting the enclave. When all of them are busy, the OCALL
+     * is performed as a regular OCALL. When zero (the default), switchless
+     * OCALLs are performed as regular OCALLs.
+     */
+    uint32_t max_host_workers;
+
+    /**
+     * When true, the host records per-function call statistics for the
+     * enclave, which can be read with oe_get_call_statistics(). Off by
+     * default, since it adds two clock reads to every call.
+     */
+    bool collect_call_statistics;
+
+    /**
+     * Number of host threads donated to the parallel runtime of the enclave,
+     * which runs the tasks of oe_parallel_for() and oe_task_spawn() on them.
+     * Each worker occupies one TCS for the lifetime of the enclave, so this
+     * plus **max_enclave_workers** must be smaller than the enclave's TCS
+     * count. When zero (the default), tasks run on the calling thread.
+     */
+    uint32_t num_parallel_workers;
+} oe_enclave_config_t;
+
 /**
  * Type of each function in an ocall-table.
  */
@@ -83,10 +126,11 @@ typedef void (*oe_ocall_func_t)(
  *     - OE_ENCLAVE_FLAG_DEBUG - runs the enclave in debug mode.
  *                               DO NOT SHIP CODE with this flag
  *
- * @param config Additional enclave creation configuration data for the specific
- * enclave type. This parameter is reserved and must be NULL.
+ * @param config Optional pointer to an **oe_enclave_config_t** structure with
+ * additional enclave creation settings, or NULL to use the defaults.
  *
- * @param config_size The size of the **config** data buffer in bytes.
+ * @param config_size The size of the **config** data buffer in bytes. Must be
+ * sizeof(oe_enclave_config_t) if **config** is not NULL and zero otherwise.
  *
  * @param ocall_table Pointer to table of ocall functions generated by
  * oeedger8r.
@@ -115,13 +159,157 @@ oe_result_t oe_create_enclave(
  * involves unmapping the memory that was mapped by **oe_create_enclave()**.
  * Once this is performed, the enclave can no longer be accessed.
  *
+ * Threads created inside the enclave by pthread_create(), including
+ * detached ones, are waited for before the enclave destructor runs. Threads
+ * that run until they are told to stop should poll
+ * oe_is_enclave_terminating(), which becomes true once this function starts
+ * waiting, and return.
+ *
  * @param enclave The instance of the enclave to be terminated.
  *
  * @returns Returns OE_OK on success.
+ * @returns Returns OE_BUSY if threads created inside the enclave were still
+ * running after ten seconds. The enclave is not terminated and remains
+ * usable.
  *
  */
 oe_result_t oe_terminate_enclave(oe_enclave_t* enclave);
 
+/**
+ * Number of buckets in the latency histogram of **oe_call_statistics_t**.
+ */
+#define OE_CALL_STATISTICS_NUM_BUCKETS 32
+
+/**
+ * The kind of call described by an **oe_call_statistics_t** entry.
+ */
+typedef enum _oe_call_kind
+{
+    OE_CALL_KIND_ECALL = 1,
+    OE_CALL_KIND_OCALL = 2,
+    __OE_CALL_KIND_MAX = OE_ENUM_MAX,
+} oe_call_kind_t;
+
+/**
+ * Statistics recorded for one ECALL or OCALL function of an enclave.
+ *
+ * For ECALLs, the latency is the round trip measured by the host, including
+ * any OCALLs made by the enclave function. For OCALLs, the latency is the
+ * time spent in the host function, since the host does not see the moment
+ * the enclave exits.
+ */
+typedef struct _oe_call_statistics
+{
+    /** Whether this entry describes an ECALL or an OCALL */
+    oe_call_kind_t kind;
+
+    /** The function table (OE_UINT64_MAX for the default table) */
+    uint64_t table_id;
+
+    /** The function id within the table */
+    uint64_t function_id;
+
+    /** Number of calls made */
+    uint64_t num_calls;
+
+    /** Number of calls that did not complete successfully */
+    uint64_t num_failures;
+
+    /** Total size of the marshaled input buffers in bytes */
+    uint64_t bytes_in;
+
+    /** Total number of bytes written to the output buffers */
+    uint64_t bytes_out;
+
+    /** Sum of the latencies in nanoseconds */
+    uint64_t total_nsec;
+
+    /**
+     * Bucket i counts the calls that took [2^i, 2^(i+1)) nanoseconds. The
+     * last bucket also counts all longer calls.
+     */
+    uint64_t latency_histogram[OE_CALL_STATISTICS_NUM_BUCKETS];
+} oe_call_statistics_t;
+
+/**
+ * Get the per-function call statistics of an enclave.
+ *
+ * Statistics are only recorded for enclaves created with
+ * **oe_enclave_config_t.collect_call_statistics** set. Counters are updated
+ * without locks, so a snapshot taken while calls are in progress may be
+ * slightly inconsistent.
+ *
+ * @param[in] enclave The enclave to get statistics for.
+ * @param[out] statistics Array that receives one entry per function called
+ * so far. May be NULL if **count** is zero.
+ * @param[in,out] count On input, the number of entries in **statistics**.
+ * On output, the number of functions with statistics.
+ *
+ * @retval OE_OK The statistics were copied.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_BUFFER_TOO_SMALL **statistics** is too small; **count** is set
+ * to the required number of entries.
+ * @retval OE_UNSUPPORTED Statistics collection is not enabled, or the
+ * enclave is not an SGX enclave.
+ */
+oe_result_t oe_get_call_statistics(
+    oe_enclave_t* enclave,
+    oe_call_statistics_t* statistics,
+    size_t* count);
+
+/**
+ * Reset the call statistics of an enclave to zero.
+ *
+ * @param[in] enclave The enclave to reset statistics for.
+ *
+ * @retval OE_OK The statistics were reset.
+ * @retval OE_INVALID_PARAMETER **enclave** is invalid.
+ * @retval OE_UNSUPPORTED Statistics collection is not enabled, or the
+ * enclave is not an SGX enclave.
+ */
+oe_result_t oe_reset_call_statistics(oe_enclave_t* enclave);
+
+/**
+ * Get statistics of the heap of an enclave.
+ *
+ * This function calls into the enclave to obtain the statistics that
+ * oe_get_heap_stats() returns there. Comparing **peak_sbrk_bytes** with
+ * **heap_size** shows how many of the enclave's **num_heap_pages** are
+ * actually needed.
+ *
+ * @param[in] enclave The enclave to query.
+ * @param[out] stats The statistics.
+ *
+ * @retval OE_OK The statistics were obtained.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_FAILURE The ECALL failed.
+ */
+oe_result_t oe_get_enclave_heap_stats(
+    oe_enclave_t* enclave,
+    oe_heap_stats_t* stats);
+
+/**
+ * Write the heap profile of an enclave to a file.
+ *
+ * The profile is collected by the enclave after it calls
+ * oe_start_heap_profiling(), and is written in the gperftools heap profile
+ * format, which pprof reads. For example:
+ *
+ *     pprof --inuse_space enclave.signed heap.prof
+ *
+ * @param[in] enclave The enclave to query.
+ * @param[in] path The path of the file to write.
+ *
+ * @retval OE_OK The profile was written.
+ * @retval OE_INVALID_PARAMETER At least one parameter is invalid.
+ * @retval OE_UNSUPPORTED The enclave is not profiling its heap.
+ * @retval OE_OUT_OF_MEMORY The profile could not be retrieved.
+ * @retval OE_FAILURE The file could not be written.
+ */
+oe_result_t oe_write_enclave_heap_profile(
+    oe_enclave_t* enclave,
+    const char* path);
+
 #if (OE_API_VERSION < 2)
 #error "Only OE_API_VERSION of 2 is supported"
 #else
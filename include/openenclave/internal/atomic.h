@@ -10,8 +10,24 @@
 #if defined(_MSC_VER)
 #pragma intrinsic(_InterlockedIncrement64)
 #pragma intrinsic(_InterlockedDecrement64)
+#pragma intrinsic(_InterlockedExchange)
+#pragma intrinsic(_InterlockedExchangePointer)
+#pragma intrinsic(_InterlockedCompareExchangePointer)
+#pragma intrinsic(_InterlockedCompareExchange64)
+#pragma intrinsic(_InterlockedExchangeAdd64)
 __int64 _InterlockedIncrement64(__int64* lpAddend);
 __int64 _InterlockedDecrement64(__int64* lpAddend);
+long _InterlockedExchange(long volatile* target, long value);
+void* _InterlockedExchangePointer(void* volatile* target, void* value);
+void* _InterlockedCompareExchangePointer(
+    void* volatile* destination,
+    void* exchange,
+    void* comparand);
+__int64 _InterlockedCompareExchange64(
+    __int64 volatile* destination,
+    __int64 exchange,
+    __int64 comparand);
+__int64 _InterlockedExchangeAdd64(__int64 volatile* addend, __int64 value);
 #endif
 
 /* Atomically increment **x** and return its new value */
@@ -38,4 +54,116 @@ OE_INLINE uint64_t oe_atomic_decrement(volatile uint64_t* x)
 #endif
 }
 
+/* Atomically set **x** to **desired** if it equals **expected**. Returns true
+ * if the swap took place. Acts as a full memory barrier. */
+OE_INLINE bool oe_atomic_compare_and_swap_ptr(
+    void* volatile* x,
+    void* expected,
+    void* desired)
+{
+#if defined(__GNUC__)
+    return __atomic_compare_exchange_n(
+        x, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return _InterlockedCompareExchangePointer(x, desired, expected) ==
+           expected;
+#else
+#error "unsupported"
+#endif
+}
+
+/* Atomically load the pointer at **x** (sequentially consistent) */
+OE_INLINE void* oe_atomic_load_ptr(void* volatile* x)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(x, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    /* Aligned reads are not reordered with older locked stores on x64 */
+    return *x;
+#else
+#error "unsupported"
+#endif
+}
+
+/* Atomically store **value** at **x**. Acts as a full memory barrier. */
+OE_INLINE void oe_atomic_store_ptr(void* volatile* x, void* value)
+{
+#if defined(__GNUC__)
+    __atomic_store_n(x, value, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    _InterlockedExchangePointer(x, value);
+#else
+#error "unsupported"
+#endif
+}
+
+/* Atomically load the 32-bit value at **x** (sequentially consistent) */
+OE_INLINE uint32_t oe_atomic_load_u32(volatile uint32_t* x)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(x, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return *x;
+#else
+#error "unsupported"
+#endif
+}
+
+/* Atomically store **value** at **x**. Acts as a full memory barrier. */
+OE_INLINE void oe_atomic_store_u32(volatile uint32_t* x, uint32_t value)
+{
+#if defined(__GNUC__)
+    __atomic_store_n(x, value, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    _InterlockedExchange((long volatile*)x, (long)value);
+#else
+#error "unsupported"
+#endif
+}
+
+/* Atomically set **x** to **desired** if it equals **expected**. Returns true
+ * if the swap took place. Acts as a full memory barrier. */
+OE_INLINE bool oe_atomic_compare_and_swap_u64(
+    volatile uint64_t* x,
+    uint64_t expected,
+    uint64_t desired)
+{
+#if defined(__GNUC__)
+    return __atomic_compare_exchange_n(
+        x, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return (uint64_t)_InterlockedCompareExchange64(
+               (__int64 volatile*)x, (__int64)desired, (__int64)expected) ==
+           expected;
+#else
+#error "unsupported"
+#endif
+}
+
+/* Atomically load the 64-bit value at **x** (sequentially consistent) */
+OE_INLINE uint64_t oe_atomic_load_u64(volatile uint64_t* x)
+{
+#if defined(__GNUC__)
+    return __atomic_load_n(x, __ATOMIC_SEQ_CST);
+#elif defined(_MSC_VER)
+    return *x;
+#else
+#error "unsupported"
+#endif
+}
+
+/* Atomically add **value** to **x** and return the new value */
+OE_INLINE uint64_t oe_atomic_add_u64(volatile uint64_t* x, uint64_t value)
+{
+#if defined(__GNUC__)
+    return __sync_add_and_fetch(x, value);
+#elif defined(_MSC_VER)
+    return (uint64_t)_InterlockedExchangeAdd64(
+               (__int64 volatile*)x, (__int64)value) +
+           value;
+#else
+#error "unsupported"
+#endif
+}
+
 #endif /* _OE_ATOMIC_H */
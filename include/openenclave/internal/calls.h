@@ -85,6 +85,7 @@ typedef enum _oe_func
     OE_OCALL_FREE,
     OE_OCALL_SLEEP,
     OE_OCALL_GET_TIME,
+    OE_OCALL_CALL_HOST_FUNCTION_BATCH,
     /* Caution: always add new OCALL function numbers here */
     OE_OCALL_MAX, /* This value is never used */
 
@@ -240,6 +241,23 @@ typedef struct _oe_call_host_function_args
     oe_result_t result;
 } oe_call_host_function_args_t;
 
+/*
+**==============================================================================
+**
+** oe_call_host_function_batch_args_t
+**
+**     Arguments of OE_OCALL_CALL_HOST_FUNCTION_BATCH. The calls array
+**     immediately follows this header in the same host allocation.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_call_host_function_batch_args
+{
+    uint64_t num_calls;
+    oe_call_host_function_args_t* calls;
+} oe_call_host_function_batch_args_t;
+
 /*
 **==============================================================================
 **
@@ -0,0 +1,42 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_HOSTHEAP_H
+#define _OE_HOSTHEAP_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+/**
+ * Allocate a runtime-internal buffer from the host's heap.
+ *
+ * Requests of up to 2 KB are served from chunks of host memory that the
+ * enclave obtains with oe_host_malloc() and sub-allocates itself; larger
+ * requests go to oe_host_malloc(). The buffer must be released by the
+ * enclave with oe_host_small_free(). It must never be passed to the host's
+ * free() or to oe_host_free().
+ *
+ * @param size The number of bytes to be allocated.
+ *
+ * @returns The allocated memory or NULL if unable to allocate the memory.
+ *
+ */
+void* oe_host_small_malloc(size_t size);
+
+/**
+ * Release a buffer allocated with oe_host_small_malloc().
+ *
+ * @param ptr Pointer to memory to be released or null.
+ *
+ */
+void oe_host_small_free(void* ptr);
+
+/* Return the host memory chunks of the oe_host_small_malloc() sub-allocator
+ * and release its bookkeeping. Called when the enclave is destroyed. */
+void oe_host_heap_destroy(void);
+
+OE_EXTERNC_END
+
+#endif /* _OE_HOSTHEAP_H */
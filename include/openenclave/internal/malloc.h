@@ -39,11 +39,16 @@ typedef struct _oe_malloc_stats
  *
  * @param stats[output] the malloc statistics
  *
- * @return 0 success
- * @return -1 failure
+ * @return OE_OK success
+ * @return OE_UNSUPPORTED the enclave replaced the built-in allocator
+ * @return OE_UNEXPECTED failure
  */
 oe_result_t oe_get_malloc_stats(oe_malloc_stats_t* stats);
 
+/* Get the number of bytes of the heap region currently obtained with
+ * oe_sbrk(), and the highest number obtained so far */
+void oe_get_sbrk_usage(size_t* current, size_t* peak);
+
 /* Dump the list of all in-use allocations */
 void oe_debug_malloc_dump(void);
 
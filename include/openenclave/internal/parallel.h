@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_PARALLEL_H
+#define _OE_INTERNAL_PARALLEL_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/parallel.h>
+#include <openenclave/bits/result.h>
+
+#ifdef OE_BUILD_ENCLAVE
+OE_EXTERNC_BEGIN
+
+/* Run the calling thread as a worker until oe_stop_parallel_workers() */
+oe_result_t oe_run_parallel_worker(void);
+
+/* Make the workers return; new workers return at once */
+void oe_stop_parallel_workers(void);
+
+OE_EXTERNC_END
+#endif /* OE_BUILD_ENCLAVE */
+
+#endif /* _OE_INTERNAL_PARALLEL_H */
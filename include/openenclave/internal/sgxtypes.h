@@ -565,7 +565,7 @@ oe_thread_data_t* oe_get_thread_data(void);
 
 #define TD_MAGIC 0xc90afe906c5d19a3
 
-#define OE_THREAD_LOCAL_SPACE (3840)
+#define OE_THREAD_LOCAL_SPACE (3816)
 
 typedef struct _callsite Callsite;
 
@@ -597,7 +597,10 @@ typedef struct _td
     /* Return arguments from OCALL */
     uint16_t oret_func;
     uint16_t oret_result;
-    uint16_t padding[2];
+
+    /* Whether the thread spins while waiting on a mutex or condition
+     * variable (protected by the lock of that object) */
+    volatile uint32_t wait_state;
     uint64_t oret_arg;
 
     /* List of Callsite structures (most recent call is first) */
@@ -606,6 +609,14 @@ typedef struct _td
     /* Simulation mode is active if non-zero */
     uint64_t simulate;
 
+    /* Buffer reused to marshal the parameters of ECALLs on this thread. Unlike
+     * thread-local variables, it survives across ECALLs. */
+    uint8_t* ecall_buffer;
+    uint64_t ecall_buffer_size;
+
+    /* Host memory that OCALL buffers of this thread are carved from */
+    struct _oe_ocall_arena* ocall_arena;
+
     /* Reserved for thread-local variables. */
     uint8_t thread_local_data[OE_THREAD_LOCAL_SPACE];
 } td_t;
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_INTERNAL_SWITCHLESS_H
+#define _OE_INTERNAL_SWITCHLESS_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/calls.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** Switchless calls:
+**
+**     A switchless call is handed to a worker thread that is already running
+**     on the other side of the enclave boundary, avoiding the EENTER/EEXIT
+**     pair of a regular call. Each worker owns a single request slot
+**     (call_arg) that lives in host memory so that both sides can access it:
+**
+**         (1) The caller claims an idle worker by atomically swapping its
+**             args pointer into the worker's slot (NULL -> args).
+**         (2) The worker notices the non-NULL slot, dispatches the call and
+**             stores the result in the args structure.
+**         (3) The worker clears the slot (args -> NULL), which completes the
+**             handshake; the caller spins until the slot no longer holds its
+**             args pointer.
+**
+**     Idle workers spin for OE_SWITCHLESS_WORKER_SPIN_COUNT iterations and
+**     then go to sleep on the host. A caller that posts to a sleeping worker
+**     sets the worker's event and wakes it (from the enclave, this takes an
+**     OCALL).
+**
+**     Enclave workers are host threads parked inside the enclave that service
+**     switchless ECALLs. Host workers are host threads that service switchless
+**     OCALLs; their contexts are handed to the enclave once at startup.
+**
+**==============================================================================
+*/
+
+/* Number of idle iterations before a worker goes to sleep */
+#define OE_SWITCHLESS_WORKER_SPIN_COUNT 4096U
+
+/* Worker threads that run inside the enclave and service switchless ECALLs */
+typedef struct _oe_enclave_worker_context
+{
+    /* The ECALL posted to this worker (NULL when the worker is idle) */
+    oe_call_enclave_function_args_t* volatile call_arg;
+
+    /* Wait-address (futex) used to wake a sleeping worker */
+    volatile uint32_t event;
+
+    /* Non-zero while the worker is sleeping on the host */
+    volatile uint32_t is_sleeping;
+
+    /* Non-zero when the worker has been asked to exit the enclave */
+    volatile uint32_t is_stopping;
+
+    /* The enclave this worker belongs to (only used by the host) */
+    oe_enclave_t* enclave;
+} oe_enclave_worker_context_t;
+
+/* Worker threads that run on the host and service switchless OCALLs */
+typedef struct _oe_host_worker_context
+{
+    /* The OCALL posted to this worker (NULL when the worker is idle) */
+    oe_call_host_function_args_t* volatile call_arg;
+
+    /* Wait-address (futex) used to wake a sleeping worker */
+    volatile uint32_t event;
+
+    /* Non-zero while the worker is sleeping */
+    volatile uint32_t is_sleeping;
+
+    /* Non-zero when the worker has been asked to exit */
+    volatile uint32_t is_stopping;
+
+    /* The enclave this worker belongs to (only used by the host) */
+    oe_enclave_t* enclave;
+} oe_host_worker_context_t;
+
+OE_EXTERNC_END
+
+#endif /* _OE_INTERNAL_SWITCHLESS_H */
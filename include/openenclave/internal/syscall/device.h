@@ -31,6 +31,9 @@ enum
 
     /* The host epoll device. */
     OE_DEVID_HOST_EPOLL,
+
+    /* The in-enclave memory file system. */
+    OE_DEVID_RAM_FILE_SYSTEM,
 };
 
 /* Device names. */
@@ -39,6 +42,7 @@ enum
 #define OE_DEVICE_NAME_SGX_FILE_SYSTEM OE_SGX_FILE_SYSTEM
 #define OE_DEVICE_NAME_HOST_SOCKET_INTERFACE "oe_host_socket_interface"
 #define OE_DEVICE_NAME_HOST_EPOLL "oe_host_epoll"
+#define OE_DEVICE_NAME_RAM_FILE_SYSTEM OE_RAM_FILE_SYSTEM
 
 typedef enum _oe_device_type
 {
@@ -75,6 +75,10 @@ OE_EXTERNC_BEGIN
 #define OE_F_OFD_SETLK     37
 #define OE_F_OFD_SETLKW    38
 
+#define OE_F_RDLCK          0
+#define OE_F_WRLCK          1
+#define OE_F_UNLCK          2
+
 // clang-format on
 
 #define OE_AT_FDCWD (-100)
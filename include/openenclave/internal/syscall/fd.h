@@ -54,6 +54,31 @@ typedef struct _oe_file_ops
 
     oe_off_t (*lseek)(oe_fd_t* file, oe_off_t offset, int whence);
 
+    /* Positional I/O: the file offset is neither used nor changed. */
+    ssize_t (*pread)(oe_fd_t* file, void* buf, size_t count, oe_off_t offset);
+
+    ssize_t (*pwrite)(
+        oe_fd_t* file,
+        const void* buf,
+        size_t count,
+        oe_off_t offset);
+
+    ssize_t (*preadv)(
+        oe_fd_t* file,
+        const struct oe_iovec* iov,
+        int iovcnt,
+        oe_off_t offset);
+
+    ssize_t (*pwritev)(
+        oe_fd_t* file,
+        const struct oe_iovec* iov,
+        int iovcnt,
+        oe_off_t offset);
+
+    int (*fsync)(oe_fd_t* file);
+
+    int (*fdatasync)(oe_fd_t* file);
+
     int (*getdents64)(oe_fd_t* file, struct oe_dirent* dirp, uint32_t count);
 } oe_file_ops_t;
 
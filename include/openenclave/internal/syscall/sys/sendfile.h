@@ -0,0 +1,17 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_SYS_SENDFILE_H
+#define _OE_SYSCALL_SYS_SENDFILE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/corelibc/bits/types.h>
+
+OE_EXTERNC_BEGIN
+
+ssize_t oe_sendfile(int out_fd, int in_fd, oe_off_t* offset, size_t count);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYSCALL_SYS_SENDFILE_H */
@@ -43,6 +43,14 @@ ssize_t oe_write(int fd, const void* buf, size_t count);
 
 oe_off_t oe_lseek(int fd, oe_off_t offset, int whence);
 
+ssize_t oe_pread(int fd, void* buf, size_t count, oe_off_t offset);
+
+ssize_t oe_pwrite(int fd, const void* buf, size_t count, oe_off_t offset);
+
+int oe_fsync(int fd);
+
+int oe_fdatasync(int fd);
+
 int oe_truncate(const char* path, oe_off_t length);
 
 int oe_truncate_d(uint64_t devid, const char* path, oe_off_t length);
@@ -52,6 +52,64 @@ oe_thread_t oe_thread_self(void);
  */
 bool oe_thread_equal(oe_thread_t thread1, oe_thread_t thread2);
 
+/**
+ * Handle of a thread created with oe_thread_create().
+ */
+typedef struct _oe_thread_handle* oe_thread_handle_t;
+
+/**
+ * Create a thread that runs inside the enclave.
+ *
+ * This function asks the host to spawn a thread, which enters the enclave
+ * on a free thread control structure (TCS) and calls
+ * **start_routine(arg)**. The TCS is reserved before this function
+ * returns and stays in use until the start routine returns.
+ *
+ * Every thread must eventually be passed to either oe_thread_join() or
+ * oe_thread_detach(), which release its handle.
+ *
+ * @param thread Set this to the handle of the new thread.
+ * @param start_routine The function that the new thread calls.
+ * @param arg The argument passed to **start_routine**.
+ *
+ * @return OE_OK the thread was created
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ * @return OE_OUT_OF_THREADS all the TCSs of the enclave are in use
+ * @return OE_OUT_OF_MEMORY insufficient memory exists to create the thread
+ * @return OE_UNSUPPORTED the enclave cannot create threads
+ *
+ */
+oe_result_t oe_thread_create(
+    oe_thread_handle_t* thread,
+    void* (*start_routine)(void*),
+    void* arg);
+
+/**
+ * Wait for a thread to finish and release its handle.
+ *
+ * @param thread The handle of a thread that was not detached.
+ * @param retval If non-null, set this to the value returned by the start
+ *        routine of the thread.
+ *
+ * @return OE_OK the thread finished
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ *
+ */
+oe_result_t oe_thread_join(oe_thread_handle_t thread, void** retval);
+
+/**
+ * Release the handle of a thread without waiting for it to finish.
+ *
+ * The resources of the thread are released when it finishes.
+ *
+ * @param thread The handle of a thread that was not detached.
+ *
+ * @return OE_OK the operation was successful
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ *
+ */
+oe_result_t oe_thread_detach(oe_thread_handle_t thread);
+
 typedef uint32_t oe_once_t;
 
 /**
@@ -81,6 +139,13 @@ typedef uint32_t oe_once_t;
         }                     \
     }
 
+#define OE_BIASED_RWLOCK_INITIALIZER \
+    {                                \
+        {                            \
+            0                        \
+        }                            \
+    }
+
 #define OE_THREADKEY_INITIALIZER 0
 
 /**
@@ -211,8 +276,9 @@ oe_result_t oe_mutex_init(oe_mutex_t* mutex);
  *
  * This function acquires a lock on a mutex.
  *
- * For enclaves, oe_mutex_lock() performs an OCALL to wait for the mutex to
- * be signaled.
+ * For enclaves, oe_mutex_lock() first spins for a short time, tuned to how
+ * long the mutex has recently been held, and then performs an OCALL to wait
+ * for the mutex to be signaled.
  *
  * @param mutex Acquire a lock on this mutex.
  *
@@ -245,7 +311,7 @@ oe_result_t oe_mutex_trylock(oe_mutex_t* mutex);
  * oe_mutex_lock() or oe_mutex_trylock().
  *
  * In enclaves, this function performs an OCALL, where it wakes the next
- * thread waiting on a mutex.
+ * thread waiting on a mutex, unless that thread is still spinning.
  *
  * @param mutex Release the lock on this mutex.
  *
@@ -309,8 +375,8 @@ oe_result_t oe_cond_init(oe_cond_t* cond);
  * and unlocks the mutex. When the thread is signaled by oe_cond_signal(), the
  * waiting thread acquires the mutex and returns.
  *
- * In enclaves, this function performs an OCALL, where the thread waits to be
- * signaled.
+ * In enclaves, the thread first spins for a short, adaptively tuned time,
+ * and then performs an OCALL, where it waits to be signaled.
  *
  * @param cond Wait on this condition variable.
  * @param mutex This mutex must be locked by the caller.
@@ -322,6 +388,32 @@ oe_result_t oe_cond_init(oe_cond_t* cond);
  */
 oe_result_t oe_cond_wait(oe_cond_t* cond, oe_mutex_t* mutex);
 
+/**
+ * Wait on a condition variable until it is signaled or a deadline passes.
+ *
+ * This function behaves like oe_cond_wait(), except that it stops waiting
+ * once the host clock (CLOCK_REALTIME) reaches **deadline**. The mutex is
+ * locked again before this function returns, whatever the outcome.
+ *
+ * The deadline is enforced by the untrusted host, which may end the wait
+ * early or late; callers check their condition again in either case.
+ *
+ * @param cond Wait on this condition variable.
+ * @param mutex This mutex must be locked by the caller.
+ * @param deadline The time at which the wait ends, in nanoseconds since the
+ *        Epoch.
+ *
+ * @return OE_OK the thread was signaled
+ * @return OE_TIMEDOUT the deadline passed before the thread was signaled
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ * @return OE_BUSY the mutex is not locked by the calling thread.
+ *
+ */
+oe_result_t oe_cond_timedwait(
+    oe_cond_t* cond,
+    oe_mutex_t* mutex,
+    uint64_t deadline);
+
 /**
  * Signal a thread waiting on a condition variable.
  *
@@ -332,7 +424,7 @@ oe_result_t oe_cond_wait(oe_cond_t* cond, oe_mutex_t* mutex);
  * causing it to return from oe_cond_wait().
  *
  * In enclaves, this function performs an OCALL, where it wakes the next
- * waiting thread.
+ * waiting thread, unless that thread is still spinning.
  *
  * @param cond Signal this condition variable.
  *
@@ -350,7 +442,7 @@ oe_result_t oe_cond_signal(oe_cond_t* cond);
  * them on a first-come first-served (FCFS) queue, where they wait to be
  * signaled. oe_cond_broadcast() wakes up all threads on the queue, causing
  * them to return from oe_cond_wait(). In enclaves, this function performs
- * an OCALL, where it wakes all waiting threads.
+ * an OCALL, where it wakes all waiting threads that are not spinning.
  *
  * @param cond The condition variable to be signaled.
  *
@@ -559,6 +651,81 @@ oe_result_t oe_rwlock_trywrlock(oe_rwlock_t* rw_lock);
  */
 oe_result_t oe_rwlock_destroy(oe_rwlock_t* rw_lock);
 
+/**
+ * Reader-biased readers-writer lock representation.
+ */
+typedef struct _oe_biased_rwlock
+{
+    uint64_t __impl[6]; /**< Internal private implementation */
+} oe_biased_rwlock_t;
+
+/**
+ * Initialize a reader-biased readers-writer lock.
+ *
+ * A reader-biased lock has the semantics of oe_rwlock_t but is meant for
+ * data that is read far more often than it is written. While no writer has
+ * recently acquired it, readers do not write to the lock at all: each thread
+ * publishes the locks it reads in a table of per-thread slots, so concurrent
+ * readers do not contend on a shared cache line. In exchange, a writer
+ * revokes the bias and waits for the readers in the slots of all threads,
+ * and reads go through the underlying oe_rwlock_t until enough of them have
+ * happened since the last write to restore the bias.
+ *
+ * Reader-biased locks can also be initialized statically as follows.
+ *
+ *     oe_biased_rwlock_t rw_lock = OE_BIASED_RWLOCK_INITIALIZER;
+ *
+ * @param rw_lock Initialize this readers-writer lock.
+ *
+ * @return OE_OK the operation was successful
+ * @return OE_INVALID_PARAMETER one or more parameters is invalid
+ */
+oe_result_t oe_biased_rwlock_init(oe_biased_rwlock_t* rw_lock);
+
+/**
+ * Acquire a read lock on a reader-biased readers-writer lock.
+ *
+ * Same as oe_rwlock_rdlock().
+ */
+oe_result_t oe_biased_rwlock_rdlock(oe_biased_rwlock_t* rw_lock);
+
+/**
+ * Try to acquire a read lock on a reader-biased readers-writer lock.
+ *
+ * Same as oe_rwlock_tryrdlock().
+ */
+oe_result_t oe_biased_rwlock_tryrdlock(oe_biased_rwlock_t* rw_lock);
+
+/**
+ * Acquire a write lock on a reader-biased readers-writer lock.
+ *
+ * Same as oe_rwlock_wrlock(). If readers hold the lock through their
+ * per-thread slots, this function spins until they release it.
+ */
+oe_result_t oe_biased_rwlock_wrlock(oe_biased_rwlock_t* rw_lock);
+
+/**
+ * Try to acquire a write lock on a reader-biased readers-writer lock.
+ *
+ * Same as oe_rwlock_trywrlock(). Revokes the bias of the lock even when it
+ * fails.
+ */
+oe_result_t oe_biased_rwlock_trywrlock(oe_biased_rwlock_t* rw_lock);
+
+/**
+ * Release a read or write lock on a reader-biased readers-writer lock.
+ *
+ * Same as oe_rwlock_unlock().
+ */
+oe_result_t oe_biased_rwlock_unlock(oe_biased_rwlock_t* rw_lock);
+
+/**
+ * Destroy a reader-biased readers-writer lock.
+ *
+ * Same as oe_rwlock_destroy().
+ */
+oe_result_t oe_biased_rwlock_destroy(oe_biased_rwlock_t* rw_lock);
+
 typedef uint32_t oe_thread_key_t;
 
 /**
@@ -1,13 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <openenclave/corelibc/errno.h>
 #include <openenclave/corelibc/pthread.h>
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
 #include <openenclave/internal/defs.h>
 #include <openenclave/internal/pthreadhooks.h>
 #include <openenclave/internal/sgxtypes.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/utils.h>
 #include <pthread.h>
 
 #ifdef pthread_equal
@@ -27,7 +31,6 @@
 #include <openenclave/corelibc/bits/pthread_key.h>
 #include <openenclave/corelibc/bits/pthread_mutex.h>
 #include <openenclave/corelibc/bits/pthread_once.h>
-#include <openenclave/corelibc/bits/pthread_rwlock.h>
 #include <openenclave/corelibc/bits/pthread_spin.h>
 #if defined(__UNDEF_OE_NEED_STDC_NAMES)
 #undef OE_NEED_STDC_NAMES
@@ -46,12 +49,135 @@ OE_STATIC_ASSERT(sizeof(pthread_once_t) == sizeof(oe_once_t));
 OE_STATIC_ASSERT(sizeof(pthread_spinlock_t) == sizeof(oe_spinlock_t));
 OE_STATIC_ASSERT(sizeof(pthread_mutex_t) >= sizeof(oe_mutex_t));
 OE_STATIC_ASSERT(sizeof(pthread_cond_t) >= sizeof(oe_cond_t));
-OE_STATIC_ASSERT(sizeof(pthread_rwlock_t) >= sizeof(oe_rwlock_t));
+OE_STATIC_ASSERT(sizeof(pthread_rwlock_t) >= sizeof(oe_biased_rwlock_t));
 
 static __thread struct __pthread _pthread_self = {.locale = C_LOCALE};
 
+/*
+**==============================================================================
+**
+** Threads created by the default pthread_create()
+**
+**     Without registered hooks, pthread_create() runs the thread on a TCS of
+**     its own through oe_thread_create(). The pthread_t is a record that
+**     starts with the struct __pthread of the thread, so pthread_self() in
+**     the thread returns the same value as pthread_create() did. The record
+**     is released when both the thread and pthread_join() or
+**     pthread_detach() are done with it.
+**
+**     Records that are neither joined nor detached are kept in a list, so
+**     that pthread_join() and pthread_detach() recognize the threads that
+**     pthread_create() did not create (such as the threads of ECALLs) and
+**     the threads that were already joined or detached.
+**
+**==============================================================================
+*/
+
+typedef struct _pthread_record
+{
+    /* Must be first */
+    struct __pthread base;
+
+    oe_thread_handle_t handle;
+    void* (*start_routine)(void*);
+    void* arg;
+
+    /* Held by the thread and by its pthread_t until joined or detached */
+    uint64_t refs;
+
+    /* In _records until joined or detached */
+    struct _pthread_record* prev;
+    struct _pthread_record* next;
+} pthread_record_t;
+
+static pthread_record_t* _records;
+static oe_spinlock_t _records_lock = OE_SPINLOCK_INITIALIZER;
+
+/* Record of the calling thread, if it was created by pthread_create() */
+static __thread pthread_record_t* _pthread_record;
+
+static void _release_record(pthread_record_t* record)
+{
+    if (oe_atomic_decrement(&record->refs) == 0)
+        oe_free(record);
+}
+
+static void _add_record(pthread_record_t* record)
+{
+    oe_spin_lock(&_records_lock);
+    {
+        record->prev = NULL;
+        record->next = _records;
+
+        if (_records)
+            _records->prev = record;
+
+        _records = record;
+    }
+    oe_spin_unlock(&_records_lock);
+}
+
+/* Remove the record of the thread from the list, so that the caller alone
+ * joins or detaches it. Returns NULL if there is no such record. */
+static pthread_record_t* _take_record(pthread_t thread)
+{
+    pthread_record_t* record;
+
+    oe_spin_lock(&_records_lock);
+    {
+        for (record = _records; record; record = record->next)
+        {
+            if (&record->base == thread)
+                break;
+        }
+
+        if (record)
+        {
+            if (record->prev)
+                record->prev->next = record->next;
+            else
+                _records = record->next;
+
+            if (record->next)
+                record->next->prev = record->prev;
+        }
+    }
+    oe_spin_unlock(&_records_lock);
+
+    return record;
+}
+
+/* The record is listed before oe_thread_create() returns the handle, so a
+ * thread that joins or detaches it at once waits for the handle */
+static oe_thread_handle_t _get_handle(pthread_record_t* record)
+{
+    void* handle;
+
+    while (!(handle = oe_atomic_load_ptr((void* volatile*)&record->handle)))
+        OE_CPU_RELAX();
+
+    return (oe_thread_handle_t)handle;
+}
+
+static void* _pthread_start(void* arg)
+{
+    pthread_record_t* record = (pthread_record_t*)arg;
+    void* retval;
+
+    _pthread_record = record;
+    retval = record->start_routine(record->arg);
+    _pthread_record = NULL;
+
+    _release_record(record);
+
+    return retval;
+}
+
 pthread_t __pthread_self()
 {
+    if (_pthread_record)
+        return &_pthread_record->base;
+
     return &_pthread_self;
 }
 
@@ -70,33 +196,154 @@ int pthread_create(
     void* (*start_routine)(void*),
     void* arg)
 {
-    if (!_pthread_hooks || !_pthread_hooks->create)
+    pthread_record_t* record;
+    oe_thread_handle_t handle;
+    oe_result_t result;
+
+    if (_pthread_hooks && _pthread_hooks->create)
+        return _pthread_hooks->create(thread, attr, start_routine, arg);
+
+    if (!thread || !start_routine)
+        return OE_EINVAL;
+
+    if (!(record = oe_calloc(1, sizeof(*record))))
+        return OE_EAGAIN;
+
+    record->base.locale = C_LOCALE;
+    record->start_routine = start_routine;
+    record->arg = arg;
+    record->refs = 2;
+    *thread = &record->base;
+
+    /* Before the thread starts, as it may join or detach itself at once */
+    _add_record(record);
+
+    if ((result = oe_thread_create(&handle, _pthread_start, record)) != OE_OK)
     {
-        oe_assert("pthread_create(): panic" == NULL);
-        return -1;
+        /* The thread never ran, so the record is still listed */
+        _take_record(&record->base);
+        oe_free(record);
+
+        /* Includes OE_OUT_OF_THREADS, when all TCSs are in use */
+        return result == OE_INVALID_PARAMETER ? OE_EINVAL : OE_EAGAIN;
     }
 
-    return _pthread_hooks->create(thread, attr, start_routine, arg);
+    oe_atomic_store_ptr((void* volatile*)&record->handle, handle);
+
+    if (attr && attr->_a_detach)
+        pthread_detach(*thread);
+
+    return 0;
 }
 
 int pthread_join(pthread_t thread, void** retval)
 {
-    if (!_pthread_hooks || !_pthread_hooks->join)
+    pthread_record_t* record;
+
+    if (_pthread_hooks && _pthread_hooks->join)
+        return _pthread_hooks->join(thread, retval);
+
+    if (_pthread_record && thread == &_pthread_record->base)
+        return OE_EDEADLK;
+
+    if (!(record = _take_record(thread)))
+        return OE_ESRCH;
+
+    if (oe_thread_join(_get_handle(record), retval) != OE_OK)
     {
-        oe_assert("pthread_join(): panic" == NULL);
-        return -1;
+        _add_record(record);
+        return OE_EINVAL;
     }
 
-    return _pthread_hooks->join(thread, retval);
+    _release_record(record);
+
+    return 0;
 }
 
 int pthread_detach(pthread_t thread)
 {
-    if (!_pthread_hooks || !_pthread_hooks->detach)
+    pthread_record_t* record;
+
+    if (_pthread_hooks && _pthread_hooks->detach)
+        return _pthread_hooks->detach(thread);
+
+    if (!(record = _take_record(thread)))
+        return OE_ESRCH;
+
+    if (oe_thread_detach(_get_handle(record)) != OE_OK)
+    {
+        _add_record(record);
+        return OE_EINVAL;
+    }
+
+    _release_record(record);
+
+    return 0;
+}
+
+/*
+**==============================================================================
+**
+** pthread_rwlock_t
+**
+**     Backed by oe_biased_rwlock_t, like oe_pthread_rwlock_t, so that
+**     concurrent readers of read-mostly data do not contend on the lock.
+**     PTHREAD_RWLOCK_INITIALIZER (all zeros) is a valid unlocked state.
+**
+**==============================================================================
+*/
+
+static int _rwlock_errno(oe_result_t result)
+{
+    switch (result)
     {
-        oe_assert("pthread_detach(): panic" == NULL);
-        return -1;
+        case OE_OK:
+            return 0;
+        case OE_BUSY:
+            return OE_EBUSY;
+        case OE_NOT_OWNER:
+            return OE_EPERM;
+        default:
+            return OE_EINVAL;
     }
+}
+
+int pthread_rwlock_init(
+    pthread_rwlock_t* rwlock,
+    const pthread_rwlockattr_t* attr)
+{
+    OE_UNUSED(attr);
+    return _rwlock_errno(oe_biased_rwlock_init((oe_biased_rwlock_t*)rwlock));
+}
+
+int pthread_rwlock_rdlock(pthread_rwlock_t* rwlock)
+{
+    return _rwlock_errno(oe_biased_rwlock_rdlock((oe_biased_rwlock_t*)rwlock));
+}
+
+int pthread_rwlock_tryrdlock(pthread_rwlock_t* rwlock)
+{
+    return _rwlock_errno(
+        oe_biased_rwlock_tryrdlock((oe_biased_rwlock_t*)rwlock));
+}
 
-    return _pthread_hooks->detach(thread);
+int pthread_rwlock_wrlock(pthread_rwlock_t* rwlock)
+{
+    return _rwlock_errno(oe_biased_rwlock_wrlock((oe_biased_rwlock_t*)rwlock));
+}
+
+int pthread_rwlock_trywrlock(pthread_rwlock_t* rwlock)
+{
+    return _rwlock_errno(
+        oe_biased_rwlock_trywrlock((oe_biased_rwlock_t*)rwlock));
+}
+
+int pthread_rwlock_unlock(pthread_rwlock_t* rwlock)
+{
+    return _rwlock_errno(oe_biased_rwlock_unlock((oe_biased_rwlock_t*)rwlock));
+}
+
+int pthread_rwlock_destroy(pthread_rwlock_t* rwlock)
+{
+    return _rwlock_errno(oe_biased_rwlock_destroy((oe_biased_rwlock_t*)rwlock));
 }
@@ -0,0 +1,414 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/thread.h>
+
+#include "cache.h"
+#include "syscall_t.h"
+
+/* Bytes read by the first refill after an open or a seek. */
+#define MIN_READ_AHEAD 4096
+
+struct _oe_hostfs_cache
+{
+    oe_mutex_t lock;
+
+    /* The buffer, allocated on first use. */
+    uint8_t* data;
+    size_t size;
+
+    /* If dirty, data[pos, len) is to be written at the host file offset.
+     * Otherwise it is data read ahead of the caller, which ends at the host
+     * file offset. */
+    size_t pos;
+    size_t len;
+    bool dirty;
+
+    /* Bytes to read at the next refill. */
+    size_t read_ahead;
+};
+
+static size_t _min(size_t x, size_t y)
+{
+    return x < y ? x : y;
+}
+
+/* The counts returned by the host are checked here, since the cache uses
+ * them to index its buffer. */
+static ssize_t _host_read(oe_host_fd_t fd, void* buf, size_t count)
+{
+    ssize_t ret = -1;
+    ssize_t retval = -1;
+
+    if (oe_syscall_read_ocall(&retval, fd, buf, count) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval > 0 && (size_t)retval > count)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
+static ssize_t _host_write(oe_host_fd_t fd, const void* buf, size_t count)
+{
+    ssize_t ret = -1;
+    ssize_t retval = -1;
+
+    if (oe_syscall_write_ocall(&retval, fd, buf, count) != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (retval > 0 && (size_t)retval > count)
+        OE_RAISE_ERRNO(OE_EIO);
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
+static void _reset(oe_hostfs_cache_t* cache)
+{
+    cache->pos = 0;
+    cache->len = 0;
+    cache->dirty = false;
+    cache->read_ahead = _min(MIN_READ_AHEAD, cache->size);
+}
+
+/* Allocate the buffer. Without it, requests go straight to the host. */
+static bool _alloc(oe_hostfs_cache_t* cache)
+{
+    if (!cache->data && cache->size)
+        cache->data = (uint8_t*)oe_malloc(cache->size);
+
+    return cache->data != NULL;
+}
+
+/* Write back dirty data; the data read ahead, if any, is kept. */
+static int _flush(oe_hostfs_cache_t* cache, oe_host_fd_t fd)
+{
+    int ret = -1;
+
+    if (!cache->dirty)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    /* Data left by a failed flush is retried by the next one. */
+    while (cache->pos < cache->len)
+    {
+        ssize_t n = _host_write(
+            fd, cache->data + cache->pos, cache->len - cache->pos);
+
+        if (n < 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        if (n == 0)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        cache->pos += (size_t)n;
+    }
+
+    _reset(cache);
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Write back dirty data and return the data read ahead to the host, so that
+ * the host file offset is the one the caller sees. */
+static int _invalidate(oe_hostfs_cache_t* cache, oe_host_fd_t fd)
+{
+    int ret = -1;
+
+    if (_flush(cache, fd) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (cache->pos < cache->len)
+    {
+        oe_off_t offset = -(oe_off_t)(cache->len - cache->pos);
+        oe_off_t retval = -1;
+
+        if (oe_syscall_lseek_ocall(&retval, fd, offset, OE_SEEK_CUR) !=
+            OE_OK)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (retval < 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
+    _reset(cache);
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static ssize_t _read(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    uint8_t* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+    size_t n;
+
+    if (_flush(cache, fd) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Copy what was read ahead. */
+    n = _min(count, cache->len - cache->pos);
+    if (n)
+    {
+        memcpy(buf, cache->data + cache->pos, n);
+        cache->pos += n;
+    }
+
+    /* Read the rest from the host, ahead of the caller if it fits. */
+    if (n < count)
+    {
+        const size_t rest = count - n;
+        ssize_t r;
+
+        if (rest >= cache->size || !_alloc(cache))
+        {
+            if ((r = _host_read(fd, buf + n, rest)) > 0)
+                n += (size_t)r;
+        }
+        else
+        {
+            /* Neither exceeds the size of the buffer. */
+            const size_t size =
+                rest > cache->read_ahead ? rest : cache->read_ahead;
+
+            if ((r = _host_read(fd, cache->data, size)) > 0)
+            {
+                cache->pos = _min((size_t)r, rest);
+                cache->len = (size_t)r;
+                memcpy(buf + n, cache->data, cache->pos);
+                n += cache->pos;
+
+                cache->read_ahead = _min(2 * size, cache->size);
+            }
+        }
+
+        /* An error after a partial read is reported by the next read. */
+        if (r < 0 && n == 0)
+            OE_RAISE_ERRNO(oe_errno);
+    }
+
+    ret = (ssize_t)n;
+
+done:
+    return ret;
+}
+
+static ssize_t _write(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    const uint8_t* buf,
+    size_t count)
+{
+    ssize_t ret = -1;
+
+    /* Write at the offset of the caller rather than after the read-ahead. */
+    if (!cache->dirty && _invalidate(cache, fd) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (cache->len + count > cache->size && _flush(cache, fd) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (count >= cache->size || !_alloc(cache))
+    {
+        ret = _host_write(fd, buf, count);
+        goto done;
+    }
+
+    memcpy(cache->data + cache->len, buf, count);
+    cache->len += count;
+    cache->dirty = true;
+
+    ret = (ssize_t)count;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** Public functions:
+**
+**==============================================================================
+*/
+
+oe_hostfs_cache_t* oe_hostfs_cache_new(size_t size)
+{
+    oe_hostfs_cache_t* cache;
+
+    if (!(cache = (oe_hostfs_cache_t*)oe_calloc(1, sizeof(*cache))))
+        return NULL;
+
+    oe_mutex_init(&cache->lock);
+    cache->size = size;
+    _reset(cache);
+
+    return cache;
+}
+
+int oe_hostfs_cache_free(oe_hostfs_cache_t* cache, oe_host_fd_t fd)
+{
+    int ret;
+
+    oe_mutex_lock(&cache->lock);
+    ret = _flush(cache, fd);
+    oe_mutex_unlock(&cache->lock);
+
+    oe_mutex_destroy(&cache->lock);
+    oe_free(cache->data);
+    oe_free(cache);
+
+    return ret;
+}
+
+ssize_t oe_hostfs_cache_read(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count)
+{
+    ssize_t ret;
+
+    oe_mutex_lock(&cache->lock);
+    ret = _read(cache, fd, (uint8_t*)buf, count);
+    oe_mutex_unlock(&cache->lock);
+
+    return ret;
+}
+
+ssize_t oe_hostfs_cache_write(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count)
+{
+    ssize_t ret;
+
+    oe_mutex_lock(&cache->lock);
+    ret = _write(cache, fd, (const uint8_t*)buf, count);
+    oe_mutex_unlock(&cache->lock);
+
+    return ret;
+}
+
+ssize_t oe_hostfs_cache_readv(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = 0;
+    size_t total = 0;
+
+    oe_mutex_lock(&cache->lock);
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n = _read(cache, fd, iov[i].iov_base, iov[i].iov_len);
+
+        if (n < 0)
+        {
+            if (total == 0)
+                ret = -1;
+            break;
+        }
+
+        total += (size_t)n;
+
+        /* Stop at the end of the file. */
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    oe_mutex_unlock(&cache->lock);
+
+    return ret < 0 ? ret : (ssize_t)total;
+}
+
+ssize_t oe_hostfs_cache_writev(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    ssize_t ret = 0;
+    size_t total = 0;
+
+    oe_mutex_lock(&cache->lock);
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        ssize_t n = _write(cache, fd, iov[i].iov_base, iov[i].iov_len);
+
+        if (n < 0)
+        {
+            if (total == 0)
+                ret = -1;
+            break;
+        }
+
+        total += (size_t)n;
+
+        if ((size_t)n < iov[i].iov_len)
+            break;
+    }
+
+    oe_mutex_unlock(&cache->lock);
+
+    return ret < 0 ? ret : (ssize_t)total;
+}
+
+int oe_hostfs_cache_begin(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    bool invalidate)
+{
+    int ret;
+
+    oe_mutex_lock(&cache->lock);
+
+    if (invalidate)
+        ret = _invalidate(cache, fd);
+    else
+        ret = _flush(cache, fd);
+
+    if (ret != 0)
+        oe_mutex_unlock(&cache->lock);
+
+    return ret;
+}
+
+void oe_hostfs_cache_end(oe_hostfs_cache_t* cache)
+{
+    oe_mutex_unlock(&cache->lock);
+}
+
+void oe_hostfs_cache_disable(oe_hostfs_cache_t* cache)
+{
+    oe_free(cache->data);
+    cache->data = NULL;
+    cache->size = 0;
+    _reset(cache);
+}
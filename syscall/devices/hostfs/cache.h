@@ -0,0 +1,84 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H
+#define _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H
+
+#include <openenclave/bits/defs.h>
+#include <openenclave/bits/types.h>
+#include <openenclave/internal/syscall/sys/uio.h>
+#include <openenclave/internal/syscall/types.h>
+
+OE_EXTERNC_BEGIN
+
+/*
+**==============================================================================
+**
+** oe_hostfs_cache_t:
+**
+**     A buffer in front of the host file descriptor of an open hostfs file.
+**     Reads are served from the buffer, which is refilled with one OCALL
+**     that reads ahead of the caller; the read-ahead doubles with every
+**     sequential refill, up to the size of the buffer. Small writes are
+**     coalesced in the buffer and written back when it fills up, and before
+**     any operation that depends on the host file offset or contents.
+**
+**     Functions return -1 and set oe_errno on failure, like the syscalls
+**     they serve. Data written back after the write() that produced it has
+**     returned reports its errors from the next operation on the file.
+**
+**==============================================================================
+*/
+
+typedef struct _oe_hostfs_cache oe_hostfs_cache_t;
+
+/* The buffer itself is allocated on first use. */
+oe_hostfs_cache_t* oe_hostfs_cache_new(size_t size);
+
+/* Write back dirty data and release the cache. */
+int oe_hostfs_cache_free(oe_hostfs_cache_t* cache, oe_host_fd_t fd);
+
+ssize_t oe_hostfs_cache_read(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    void* buf,
+    size_t count);
+
+ssize_t oe_hostfs_cache_write(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    const void* buf,
+    size_t count);
+
+ssize_t oe_hostfs_cache_readv(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    const struct oe_iovec* iov,
+    int iovcnt);
+
+ssize_t oe_hostfs_cache_writev(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    const struct oe_iovec* iov,
+    int iovcnt);
+
+/* Lock the cache and write back dirty data, so that the host sees every
+ * write made through the cache. If invalidate is true, also drop the data
+ * read ahead, so that the host file offset is the one the caller sees and
+ * the host file may be changed. On success, the caller performs its
+ * operation on the host file and calls oe_hostfs_cache_end(). */
+int oe_hostfs_cache_begin(
+    oe_hostfs_cache_t* cache,
+    oe_host_fd_t fd,
+    bool invalidate);
+
+void oe_hostfs_cache_end(oe_hostfs_cache_t* cache);
+
+/* Stop caching, for instance once the host file offset is shared with
+ * another descriptor; later calls go straight to the host. Called between
+ * oe_hostfs_cache_begin() with invalidate set and oe_hostfs_cache_end(). */
+void oe_hostfs_cache_disable(oe_hostfs_cache_t* cache);
+
+OE_EXTERNC_END
+
+#endif /* _OE_SYSCALL_DEVICES_HOSTFS_CACHE_H */
@@ -14,6 +14,10 @@
 **     (2) Load the module by calling oe_load_module_host_file_system().
 **     (3) Use the standard C file I/O functions (e.g., open, read, write).
 **
+**     A file system mounted with "cache_size=<bytes>" as the mount data puts
+**     a cache of that size in front of each regular file it opens (see
+**     cache.h), which reads ahead and coalesces small writes.
+**
 **==============================================================================
 */
 
@@ -26,6 +30,7 @@
 #include <openenclave/internal/syscall/dirent.h>
 #include <openenclave/internal/syscall/sys/mount.h>
 #include <openenclave/corelibc/stdio.h>
+#include <openenclave/corelibc/stdlib.h>
 #include <openenclave/corelibc/string.h>
 #include <openenclave/internal/syscall/fcntl.h>
 #include <openenclave/internal/syscall/sys/ioctl.h>
@@ -35,6 +40,7 @@
 #include <openenclave/internal/hexdump.h>
 #include <openenclave/bits/safecrt.h>
 
+#include "cache.h"
 #include "syscall_t.h"
 
 #define FS_MAGIC 0x5f35f964
@@ -44,6 +50,9 @@
 /* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
 #define ACCESS_MODE_MASK 000000003
 
+/* The number of directory entries read from the host at once by readdir(). */
+#define DIR_BATCH_SIZE 32
+
 /* The host file system device. */
 typedef struct _device
 {
@@ -61,6 +70,9 @@ typedef struct _device
         unsigned long flags;
         char source[OE_PATH_MAX];
         char target[OE_PATH_MAX];
+
+        /* The size of the cache of each file, or zero for none. */
+        size_t cache_size;
     } mount;
 } device_t;
 
@@ -77,6 +89,9 @@ typedef struct _file
 
     /* The file descriptor for an open directory if non-null. */
     oe_fd_t* dir;
+
+    /* The cache in front of host_fd if non-null. */
+    oe_hostfs_cache_t* cache;
 } file_t;
 
 /* Created by opendir(), updated by readdir(), closed by closedir(). */
@@ -90,8 +105,11 @@ typedef struct _dir
     /* The directory handle obtained from the host by opendir(). */
     uint64_t host_dir;
 
-    /* The directory entry obtained from the host by readdir(). */
-    struct oe_dirent entry;
+    /* Entries read from the host but not yet returned by readdir() are
+     * entries[next] to entries[count - 1]. Allocated on first use. */
+    struct oe_dirent* entries;
+    size_t next;
+    size_t count;
 } dir_t;
 
 static oe_file_ops_t _get_file_ops(void);
@@ -106,6 +124,11 @@ static int _hostfs_closedir(oe_fd_t* desc);
 
 static struct oe_dirent* _hostfs_readdir(oe_fd_t* desc);
 
+static ssize_t _hostfs_read_entries(
+    dir_t* dir,
+    struct oe_dirent* entries,
+    size_t count);
+
 /* Return true if the file system was mounted as read-only. */
 OE_INLINE bool _is_read_only(const device_t* fs)
 {
@@ -189,6 +212,28 @@ done:
     return ret;
 }
 
+/* Parse the mount data, which may only be "cache_size=<bytes>". */
+static int _parse_mount_data(const char* data, size_t* cache_size)
+{
+    static const char option[] = "cache_size=";
+    const char* value = data + sizeof(option) - 1;
+    int ret = -1;
+    char* end = NULL;
+
+    if (oe_strncmp(data, option, sizeof(option) - 1) != 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    *cache_size = oe_strtoul(value, &end, 0);
+
+    if (end == value || *end != '\0')
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
 /* Called by oe_mount(). */
 static int _hostfs_mount(
     oe_device_t* device,
@@ -200,6 +245,7 @@ static int _hostfs_mount(
 {
     int ret = -1;
     device_t* fs = _cast_device(device);
+    size_t cache_size = 0;
 
     /* Fail if required parameters are null. */
     if (!fs || !source || !target)
@@ -213,9 +259,9 @@ static int _hostfs_mount(
     if (oe_strcmp(filesystemtype, OE_DEVICE_NAME_HOST_FILE_SYSTEM) != 0)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* The data parameter is not supported for host file systems. */
-    if (data)
-        OE_RAISE_ERRNO(OE_EINVAL);
+    /* The data parameter may only configure the cache. */
+    if (data && _parse_mount_data((const char*)data, &cache_size) != 0)
+        OE_RAISE_ERRNO(oe_errno);
 
     /* Remember whether this is a read-only mount. */
     if ((flags & OE_MS_RDONLY))
@@ -227,6 +273,8 @@ static int _hostfs_mount(
     /* Save the target parameter (checked by the umount2() function). */
     oe_strlcpy(fs->mount.target, target, sizeof(fs->mount.target));
 
+    fs->mount.cache_size = cache_size;
+
     /* Set the flag indicating that this file system is mounted. */
     fs->is_mounted = true;
 
@@ -350,6 +398,21 @@ static oe_fd_t* _hostfs_open_file(
         file->host_fd = retval;
     }
 
+    /* Cache regular files only, as other files cannot seek back over the
+     * data read ahead. Without memory for the cache, the file is simply
+     * not cached. */
+    if (fs->mount.cache_size)
+    {
+        struct oe_stat st;
+        int retval_stat = -1;
+
+        if (oe_syscall_stat_ocall(&retval_stat, host_path, &st) == OE_OK &&
+            retval_stat == 0 && OE_S_ISREG(st.st_mode))
+        {
+            file->cache = oe_hostfs_cache_new(fs->mount.cache_size);
+        }
+    }
+
     ret = &file->base;
     file = NULL;
 
@@ -427,6 +490,47 @@ static oe_fd_t* _hostfs_open(
     }
 }
 
+/* Write back the data cached for the file, so that the host sees it. */
+static int _flush_cache(file_t* file)
+{
+    int ret = -1;
+
+    if (file->cache)
+    {
+        if (oe_hostfs_cache_begin(file->cache, file->host_fd, false) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        oe_hostfs_cache_end(file->cache);
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Lock the cache of the file, if any, after dropping the data it read
+ * ahead, so that the host file offset and contents may be used. */
+static int _begin_uncached(file_t* file, bool* locked)
+{
+    int ret = -1;
+
+    *locked = false;
+
+    if (file->cache)
+    {
+        if (oe_hostfs_cache_begin(file->cache, file->host_fd, true) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        *locked = true;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
 static int _hostfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
 {
     int ret = -1;
@@ -440,6 +544,21 @@ static int _hostfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* The descriptors will share the host file offset, which the cache of
+     * this file could then no longer track. */
+    {
+        bool locked;
+
+        if (_begin_uncached(file, &locked) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        if (locked)
+        {
+            oe_hostfs_cache_disable(file->cache);
+            oe_hostfs_cache_end(file->cache);
+        }
+    }
+
     /* Create and initialize the new file structure. */
     {
         if (!(new_file = oe_calloc(1, sizeof(file_t))))
@@ -483,6 +602,12 @@ static ssize_t _hostfs_read(oe_fd_t* desc, void* buf, size_t count)
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cache)
+    {
+        ret = oe_hostfs_cache_read(file->cache, file->host_fd, buf, count);
+        goto done;
+    }
+
     /* Call the host to perform the read(). */
     if (oe_syscall_read_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -498,38 +623,59 @@ static int _hostfs_getdents64(
     unsigned int count)
 {
     int ret = -1;
-    int bytes = 0;
     file_t* file = _cast_file(desc);
-    unsigned int i;
-    unsigned int n = count / sizeof(struct oe_dirent);
+    dir_t* dir;
+    size_t i = 0;
+    size_t n = count / sizeof(struct oe_dirent);
 
     if (!file || !file->dir || !dirp)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Read the entries one-by-one. */
-    for (i = 0; i < n; i++)
+    if (!(dir = _cast_dir(file->dir)))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    while (i < n)
     {
         struct oe_dirent* ent;
 
+        /* Once the entries read ahead are used up, read the entries into
+         * the caller's buffer if it holds at least a batch. */
+        if (dir->next == dir->count && n - i >= DIR_BATCH_SIZE)
+        {
+            ssize_t r = _hostfs_read_entries(dir, dirp + i, n - i);
+
+            if (r < 0)
+            {
+                if (i == 0)
+                    OE_RAISE_ERRNO(oe_errno);
+
+                break;
+            }
+
+            i += (size_t)r;
+
+            /* A short batch ends at the end of the directory. */
+            if (i < n)
+                break;
+
+            continue;
+        }
+
         oe_errno = 0;
 
         if (!(ent = _hostfs_readdir(file->dir)))
         {
-            if (oe_errno)
-            {
+            /* Return the entries read before an error, if any. */
+            if (oe_errno && i == 0)
                 OE_RAISE_ERRNO(oe_errno);
-                goto done;
-            }
 
             break;
         }
 
-        *dirp = *ent;
-        bytes += (int)sizeof(struct oe_dirent);
-        dirp++;
+        dirp[i++] = *ent;
     }
 
-    ret = bytes;
+    ret = (int)(i * sizeof(struct oe_dirent));
 
 done:
     return ret;
@@ -544,6 +690,12 @@ static ssize_t _hostfs_write(oe_fd_t* desc, const void* buf, size_t count)
     if (!file || (count && !buf))
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cache)
+    {
+        ret = oe_hostfs_cache_write(file->cache, file->host_fd, buf, count);
+        goto done;
+    }
+
     /* Call the host. */
     if (oe_syscall_write_ocall(&ret, file->host_fd, buf, count) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -565,6 +717,12 @@ static ssize_t _hostfs_readv(
     if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cache)
+    {
+        ret = oe_hostfs_cache_readv(file->cache, file->host_fd, iov, iovcnt);
+        goto done;
+    }
+
     /* Flatten the IO vector into contiguous heap memory. */
     if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
@@ -604,6 +762,12 @@ static ssize_t _hostfs_writev(
     if (!file || !iov || iovcnt < 0 || iovcnt > OE_IOV_MAX)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (file->cache)
+    {
+        ret = oe_hostfs_cache_writev(file->cache, file->host_fd, iov, iovcnt);
+        goto done;
+    }
+
     /* Flatten the IO vector into contiguous heap memory. */
     if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
         OE_RAISE_ERRNO(OE_ENOMEM);
@@ -627,17 +791,179 @@ static oe_off_t _hostfs_lseek_file(oe_fd_t* desc, oe_off_t offset, int whence)
 {
     oe_off_t ret = -1;
     file_t* file = _cast_file(desc);
+    bool locked = false;
 
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    if (_begin_uncached(file, &locked) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
     if (oe_syscall_lseek_ocall(&ret, file->host_fd, offset, whence) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+done:
+
+    if (locked)
+        oe_hostfs_cache_end(file->cache);
+
+    return ret;
+}
+
+static ssize_t _hostfs_pread(
+    oe_fd_t* desc,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (file->dir)
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    if (_flush_cache(file) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Call the host to perform the pread(). */
+    if (oe_syscall_pread_ocall(&ret, file->host_fd, buf, count, offset) !=
+        OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
 done:
     return ret;
 }
 
+static ssize_t _hostfs_pwrite(
+    oe_fd_t* desc,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    bool locked = false;
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (file->dir)
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    /* Keep the cache from reading ahead until the host file is written. */
+    if (_begin_uncached(file, &locked) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Call the host to perform the pwrite(). */
+    if (oe_syscall_pwrite_ocall(&ret, file->host_fd, buf, count, offset) !=
+        OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+
+    if (locked)
+        oe_hostfs_cache_end(file->cache);
+
+    return ret;
+}
+
+static ssize_t _hostfs_preadv(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    void* buf = NULL;
+    size_t buf_size = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (file->dir)
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    if (_flush_cache(file) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Flatten the IO vector into contiguous heap memory. */
+    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* Call the host. */
+    if (oe_syscall_preadv_ocall(
+            &ret, file->host_fd, buf, iovcnt, buf_size, offset) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    /* Synchronize data read with IO vector. */
+    if (ret > 0)
+    {
+        if (oe_iov_sync(iov, iovcnt, buf, buf_size) != 0)
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+
+    if (buf)
+        oe_free(buf);
+
+    return ret;
+}
+
+static ssize_t _hostfs_pwritev(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    bool locked = false;
+    void* buf = NULL;
+    size_t buf_size = 0;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (file->dir)
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    /* Keep the cache from reading ahead until the host file is written. */
+    if (_begin_uncached(file, &locked) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Flatten the IO vector into contiguous heap memory. */
+    if (oe_iov_pack(iov, iovcnt, &buf, &buf_size) != 0)
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* Call the host. */
+    if (oe_syscall_pwritev_ocall(
+            &ret, file->host_fd, buf, iovcnt, buf_size, offset) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+done:
+
+    if (locked)
+        oe_hostfs_cache_end(file->cache);
+
+    if (buf)
+        oe_free(buf);
+
+    return ret;
+}
+
 /* Perform rewinddir on a dir struct. */
 static int _hostfs_rewinddir(oe_fd_t* desc)
 {
@@ -650,6 +976,10 @@ static int _hostfs_rewinddir(oe_fd_t* desc)
     if (oe_syscall_rewinddir_ocall(dir->host_dir) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Drop the entries read ahead. */
+    dir->next = 0;
+    dir->count = 0;
+
     ret = 0;
 
 done:
@@ -689,15 +1019,63 @@ done:
     return ret;
 }
 
+static int _hostfs_sync_file(oe_fd_t* desc, bool data_only)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    oe_result_t result;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Directories are not opened on the host, so they cannot be synced. */
+    if (file->dir)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_flush_cache(file) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (data_only)
+        result = oe_syscall_fdatasync_ocall(&ret, file->host_fd);
+    else
+        result = oe_syscall_fsync_ocall(&ret, file->host_fd);
+
+    if (result != OE_OK)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+done:
+    return ret;
+}
+
+static int _hostfs_fsync(oe_fd_t* desc)
+{
+    return _hostfs_sync_file(desc, false);
+}
+
+static int _hostfs_fdatasync(oe_fd_t* desc)
+{
+    return _hostfs_sync_file(desc, true);
+}
+
 static int _hostfs_close_file(oe_fd_t* desc)
 {
     int ret = -1;
     int retval = -1;
     file_t* file = _cast_file(desc);
+    int cache_errno = 0;
 
     if (!file)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    /* Write back the cache; the file is closed even if this fails. */
+    if (file->cache)
+    {
+        if (oe_hostfs_cache_free(file->cache, file->host_fd) != 0)
+            cache_errno = oe_errno;
+
+        file->cache = NULL;
+    }
+
     if (oe_syscall_close_ocall(&retval, file->host_fd) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
@@ -706,6 +1084,9 @@ static int _hostfs_close_file(oe_fd_t* desc)
 
     oe_free(file);
 
+    if (cache_errno)
+        OE_RAISE_ERRNO(cache_errno);
+
     ret = retval;
 
 done:
@@ -842,6 +1223,10 @@ static int _hostfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
             OE_RAISE_ERRNO(OE_EINVAL);
     }
 
+    /* Write back cached data, so that file locks cover it. */
+    if (_flush_cache(file) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
     if (oe_syscall_fcntl_ocall(
             &ret, file->host_fd, cmd, arg, argsize, argout) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
@@ -871,13 +1256,13 @@ static oe_fd_t* _hostfs_opendir(oe_device_t* device, const char* name)
     if (oe_syscall_opendir_ocall(&retval, host_name) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    if (retval != 0)
-    {
-        dir->base.type = OE_FD_TYPE_FILE;
-        dir->magic = DIR_MAGIC;
-        dir->base.ops.file = _get_file_ops();
-        dir->host_dir = retval;
-    }
+    if (retval == 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    dir->base.type = OE_FD_TYPE_FILE;
+    dir->magic = DIR_MAGIC;
+    dir->base.ops.file = _get_file_ops();
+    dir->host_dir = retval;
 
     ret = &dir->base;
     dir = NULL;
@@ -890,35 +1275,76 @@ done:
     return ret;
 }
 
-/* Get the next directory entry from the host. */
+/* Read up to count entries from the host; returns 0 at the end. */
+static ssize_t _hostfs_read_entries(
+    dir_t* dir,
+    struct oe_dirent* entries,
+    size_t count)
+{
+    ssize_t ret = -1;
+    ssize_t retval = -1;
+
+    if (oe_syscall_readdir_batch_ocall(
+            &retval, dir->host_dir, entries, count) != OE_OK)
+    {
+        OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if (retval < 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Check the count and the names returned by the host. */
+    if ((size_t)retval > count)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    for (ssize_t i = 0; i < retval; i++)
+    {
+        entries[i].d_reclen = sizeof(struct oe_dirent);
+        entries[i].d_name[OE_NAME_MAX] = '\0';
+    }
+
+    ret = retval;
+
+done:
+    return ret;
+}
+
+/* Get the next directory entry, reading a batch of them from the host when
+ * those read before are used up. */
 static struct oe_dirent* _hostfs_readdir(oe_fd_t* desc)
 {
     struct oe_dirent* ret = NULL;
     dir_t* dir = _cast_dir(desc);
-    int retval = -1;
 
     if (!dir)
         OE_RAISE_ERRNO(OE_EINVAL);
 
-    /* Call the host to get the next directory entry. */
-    if (oe_syscall_readdir_ocall(&retval, dir->host_dir, &dir->entry) != OE_OK)
+    if (dir->next == dir->count)
     {
-        OE_RAISE_ERRNO(OE_EINVAL);
-    }
+        ssize_t n;
 
-    /* Handle any error. */
-    if (retval == -1)
-        OE_RAISE_ERRNO(oe_errno);
+        if (!dir->entries)
+        {
+            dir->entries = oe_calloc(DIR_BATCH_SIZE, sizeof(struct oe_dirent));
 
-    /* If end of file, then return NULL. */
-    if (retval == 1)
-        goto done;
+            if (!dir->entries)
+                OE_RAISE_ERRNO(OE_ENOMEM);
+        }
 
-    /* Check for an unexpected return value (indicates a coding error). */
-    if (retval != 0)
-        OE_RAISE_ERRNO(OE_EINVAL);
+        dir->next = 0;
+        dir->count = 0;
+
+        if ((n = _hostfs_read_entries(dir, dir->entries, DIR_BATCH_SIZE)) < 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        /* If end of file, then return NULL. */
+        if (n == 0)
+            goto done;
+
+        dir->count = (size_t)n;
+    }
 
-    ret = &dir->entry;
+    ret = &dir->entries[dir->next++];
 
 done:
 
@@ -938,6 +1364,7 @@ static int _hostfs_closedir(oe_fd_t* desc)
     if (oe_syscall_closedir_ocall(&retval, dir->host_dir) != OE_OK)
         OE_RAISE_ERRNO(OE_EINVAL);
 
+    oe_free(dir->entries);
     oe_free(dir);
 
     ret = retval;
@@ -1180,11 +1607,27 @@ done:
     return ret;
 }
 
+/* The caller uses the host descriptor directly, so write back the cached
+ * data and drop the data read ahead first. */
 static oe_host_fd_t _hostfs_get_host_fd(oe_fd_t* desc)
 {
+    oe_host_fd_t ret = -1;
     file_t* file = _cast_file(desc);
+    bool locked;
 
-    return file ? file->host_fd : -1;
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_begin_uncached(file, &locked) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (locked)
+        oe_hostfs_cache_end(file->cache);
+
+    ret = file->host_fd;
+
+done:
+    return ret;
 }
 
 // clang-format off
@@ -1200,6 +1643,12 @@ static oe_file_ops_t _file_ops =
     .fd.close = _hostfs_close,
     .fd.get_host_fd = _hostfs_get_host_fd,
     .lseek = _hostfs_lseek,
+    .pread = _hostfs_pread,
+    .pwrite = _hostfs_pwrite,
+    .preadv = _hostfs_preadv,
+    .pwritev = _hostfs_pwritev,
+    .fsync = _hostfs_fsync,
+    .fdatasync = _hostfs_fdatasync,
     .getdents64 = _hostfs_getdents64,
 };
 // clang-format on
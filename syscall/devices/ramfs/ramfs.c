@@ -0,0 +1,1773 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+/*
+**==============================================================================
+**
+** ramfs:
+**
+**     This module implements a file system that keeps its files and
+**     directories in enclave memory, so that scratch files neither leave the
+**     enclave nor cost an OCALL per operation. To use this module, the
+**     enclave application must:
+**
+**     (1) Link the oeramfs library.
+**     (2) Load the module by calling oe_load_module_ram_file_system().
+**     (3) Mount the file system, e.g. mount(NULL, "/tmp", OE_RAM_FILE_SYSTEM,
+**         0, NULL), and use the standard C file I/O functions.
+**
+**     Every mount starts with an empty file system, which umount() releases.
+**     Files that are open at that point remain usable until they are closed.
+**     Timestamps, ownership and permission bits are recorded but neither
+**     maintained nor enforced. All the ramfs instances share one lock.
+**
+**==============================================================================
+*/
+
+// clang-format off
+#include <openenclave/enclave.h>
+// clang-format on
+
+#include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/thread.h>
+#include <openenclave/internal/syscall/dirent.h>
+#include <openenclave/internal/syscall/sys/mount.h>
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/corelibc/string.h>
+#include <openenclave/internal/syscall/fcntl.h>
+#include <openenclave/internal/syscall/sys/ioctl.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include <openenclave/internal/raise.h>
+#include <openenclave/bits/safecrt.h>
+
+#define FS_MAGIC 0x1a6e6f2d
+#define FILE_MAGIC 0x7c3b59e1
+
+/* Mask to extract the access mode: O_RDONLY, O_WRONLY, O_RDWR. */
+#define ACCESS_MODE_MASK 000000003
+
+/* The file status flags that fcntl(F_SETFL) may change. */
+#define SETFL_MASK (OE_O_APPEND | OE_O_NONBLOCK)
+
+/* The smallest buffer allocated for the data of a file. */
+#define MIN_CAPACITY 256
+
+/* The block size reported by stat(). */
+#define BLOCK_SIZE 4096
+
+typedef struct _entry entry_t;
+
+typedef struct _inode
+{
+    oe_ino_t ino;
+    oe_mode_t mode;
+
+    /* The number of directory entries that refer to this inode. */
+    size_t links;
+
+    /* The number of open file descriptions of this inode. */
+    size_t opens;
+
+    /* Regular files: the data, of which size bytes are valid. */
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+
+    /* Directories: the entries, and the directory that contains this one
+     * (null for the root and for removed directories). */
+    entry_t* entries;
+    struct _inode* parent;
+} inode_t;
+
+struct _entry
+{
+    entry_t* next;
+    inode_t* inode;
+    char name[OE_NAME_MAX + 1];
+};
+
+/* The RAM file system device. */
+typedef struct _device
+{
+    oe_device_t base;
+
+    /* Must be FS_MAGIC. */
+    uint32_t magic;
+
+    /* True if this file system has been mounted. */
+    bool is_mounted;
+
+    /* The parameters that were passed to the mount() function. */
+    struct
+    {
+        unsigned long flags;
+        char target[OE_PATH_MAX];
+    } mount;
+
+    /* The root directory, or null for the device that was not loaded. */
+    inode_t* root;
+} device_t;
+
+/* An open file description, shared by the duplicates of a descriptor. */
+typedef struct _description
+{
+    size_t refs;
+    inode_t* inode;
+    oe_off_t offset;
+    int flags;
+} description_t;
+
+/* Created by open() and dup(). */
+typedef struct _file
+{
+    oe_fd_t base;
+
+    /* Must be FILE_MAGIC. */
+    uint32_t magic;
+
+    /* The file descriptor flags (FD_CLOEXEC). */
+    int fd_flags;
+
+    description_t* ofd;
+} file_t;
+
+/* Guards the inodes, entries and descriptions of all the instances. */
+static oe_mutex_t _lock = OE_MUTEX_INITIALIZER;
+
+static oe_ino_t _next_ino = 1;
+
+static oe_file_ops_t _get_file_ops(void);
+
+/* Return true if the file system was mounted as read-only. */
+OE_INLINE bool _is_read_only(const device_t* fs)
+{
+    return fs->mount.flags & OE_MS_RDONLY;
+}
+
+OE_INLINE bool _is_dir(const inode_t* inode)
+{
+    return OE_S_ISDIR(inode->mode);
+}
+
+static device_t* _cast_device(const oe_device_t* device)
+{
+    device_t* ret = NULL;
+    device_t* fs = (device_t*)device;
+
+    if (fs == NULL || fs->magic != FS_MAGIC || !fs->root)
+        goto done;
+
+    ret = fs;
+
+done:
+    return ret;
+}
+
+static file_t* _cast_file(const oe_fd_t* desc)
+{
+    file_t* ret = NULL;
+    file_t* file = (file_t*)desc;
+
+    if (file == NULL || file->magic != FILE_MAGIC)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = file;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** Inodes and directory entries (called with _lock held):
+**
+**==============================================================================
+*/
+
+static inode_t* _new_inode(oe_mode_t mode)
+{
+    inode_t* inode;
+
+    if (!(inode = oe_calloc(1, sizeof(inode_t))))
+        return NULL;
+
+    inode->ino = _next_ino++;
+    inode->mode = mode;
+
+    return inode;
+}
+
+/* Free the inode once neither an entry nor a description refers to it. */
+static void _put_inode(inode_t* inode)
+{
+    if (inode->links || inode->opens)
+        return;
+
+    oe_free(inode->data);
+    oe_free(inode);
+}
+
+static entry_t* _find_entry(const inode_t* dir, const char* name)
+{
+    for (entry_t* entry = dir->entries; entry; entry = entry->next)
+    {
+        if (oe_strcmp(entry->name, name) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+/* Append an entry, so that directory offsets of other entries are kept. */
+static int _add_entry(inode_t* dir, const char* name, inode_t* inode)
+{
+    int ret = -1;
+    entry_t* entry;
+    entry_t** tail = &dir->entries;
+
+    if (!(entry = oe_calloc(1, sizeof(entry_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    oe_strlcpy(entry->name, name, sizeof(entry->name));
+    entry->inode = inode;
+
+    while (*tail)
+        tail = &(*tail)->next;
+
+    *tail = entry;
+
+    inode->links++;
+
+    if (_is_dir(inode))
+        inode->parent = dir;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static void _remove_entry(inode_t* dir, entry_t* entry)
+{
+    inode_t* inode = entry->inode;
+
+    for (entry_t** p = &dir->entries; *p; p = &(*p)->next)
+    {
+        if (*p == entry)
+        {
+            *p = entry->next;
+            break;
+        }
+    }
+
+    oe_free(entry);
+
+    if (_is_dir(inode))
+        inode->parent = NULL;
+
+    inode->links--;
+    _put_inode(inode);
+}
+
+/* Remove every entry below the root, without recursion, since the depth of
+ * the tree is only bounded by OE_PATH_MAX. */
+static void _remove_tree(inode_t* root)
+{
+    inode_t* dir = root;
+
+    while (dir)
+    {
+        entry_t* entry = dir->entries;
+
+        if (!entry)
+        {
+            dir = (dir == root) ? NULL : dir->parent;
+        }
+        else if (_is_dir(entry->inode) && entry->inode->entries)
+        {
+            /* Empty the subdirectory before removing it. */
+            dir = entry->inode;
+        }
+        else
+        {
+            _remove_entry(dir, entry);
+        }
+    }
+}
+
+/* Return the parent directory, where ".." leads to. */
+static inode_t* _dotdot(inode_t* dir)
+{
+    return dir->parent ? dir->parent : dir;
+}
+
+/*
+**==============================================================================
+**
+** Path resolution (called with _lock held):
+**
+**==============================================================================
+*/
+
+typedef struct _lookup
+{
+    /* The directory that contains the last component, or null if the path
+     * has no last component (the root, "." or ".."). */
+    inode_t* parent;
+
+    /* The last component. */
+    char name[OE_NAME_MAX + 1];
+
+    /* The entry and inode that the path refers to, or null if the last
+     * component does not exist. */
+    entry_t* entry;
+    inode_t* inode;
+} lookup_t;
+
+static int _lookup(const device_t* fs, const char* path, lookup_t* lookup)
+{
+    int ret = -1;
+    inode_t* dir = fs->root;
+    const char* p = path;
+
+    oe_memset_s(lookup, sizeof(lookup_t), 0, sizeof(lookup_t));
+    lookup->inode = fs->root;
+
+    if (*p != '/')
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    for (;;)
+    {
+        size_t len;
+
+        while (*p == '/')
+            p++;
+
+        if (!*p)
+            break;
+
+        /* A component can only follow a directory. */
+        if (!lookup->inode)
+            OE_RAISE_ERRNO(OE_ENOENT);
+
+        if (!_is_dir(lookup->inode))
+            OE_RAISE_ERRNO(OE_ENOTDIR);
+
+        dir = lookup->inode;
+
+        for (len = 0; p[len] && p[len] != '/'; len++)
+            ;
+
+        if (len > OE_NAME_MAX)
+            OE_RAISE_ERRNO(OE_ENAMETOOLONG);
+
+        if (len == 1 && p[0] == '.')
+        {
+            lookup->parent = NULL;
+            lookup->entry = NULL;
+        }
+        else if (len == 2 && p[0] == '.' && p[1] == '.')
+        {
+            lookup->parent = NULL;
+            lookup->entry = NULL;
+            lookup->inode = _dotdot(dir);
+        }
+        else
+        {
+            memcpy(lookup->name, p, len);
+            lookup->name[len] = '\0';
+            lookup->parent = dir;
+            lookup->entry = _find_entry(dir, lookup->name);
+            lookup->inode = lookup->entry ? lookup->entry->inode : NULL;
+        }
+
+        p += len;
+    }
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** File data (called with _lock held):
+**
+**==============================================================================
+*/
+
+static int _reserve(inode_t* inode, size_t size)
+{
+    int ret = -1;
+    size_t capacity = inode->capacity ? inode->capacity : MIN_CAPACITY;
+    uint8_t* data;
+
+    if (size <= inode->capacity)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    while (capacity < size)
+        capacity = (capacity <= OE_SIZE_MAX / 2) ? capacity * 2 : size;
+
+    if (!(data = oe_realloc(inode->data, capacity)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    inode->data = data;
+    inode->capacity = capacity;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _resize(inode_t* inode, size_t size)
+{
+    int ret = -1;
+
+    if (size > inode->size)
+    {
+        if (_reserve(inode, size) != 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        memset(inode->data + inode->size, 0, size - inode->size);
+    }
+    else if (size == 0)
+    {
+        oe_free(inode->data);
+        inode->data = NULL;
+        inode->capacity = 0;
+    }
+
+    inode->size = size;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static ssize_t _read_at(
+    const inode_t* inode,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    size_t n = 0;
+
+    if ((uint64_t)offset < inode->size)
+    {
+        n = inode->size - (size_t)offset;
+
+        if (n > count)
+            n = count;
+
+        memcpy(buf, inode->data + offset, n);
+    }
+
+    return (ssize_t)n;
+}
+
+static ssize_t _write_at(
+    inode_t* inode,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    size_t end;
+
+    if (count > OE_SSIZE_MAX || (uint64_t)offset > OE_SSIZE_MAX - count)
+        OE_RAISE_ERRNO(OE_EFBIG);
+
+    end = (size_t)offset + count;
+
+    if (end > inode->size && _resize(inode, end) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (count)
+        memcpy(inode->data + offset, buf, count);
+
+    ret = (ssize_t)count;
+
+done:
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** File system operations:
+**
+**==============================================================================
+*/
+
+/* Called by oe_mount(). */
+static int _ramfs_mount(
+    oe_device_t* device,
+    const char* source,
+    const char* target,
+    const char* filesystemtype,
+    unsigned long flags,
+    const void* data)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+
+    /* The source is ignored, since the files live in memory. */
+    OE_UNUSED(source);
+
+    /* Fail if required parameters are null. */
+    if (!fs || !target)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if this file system is already mounted. */
+    if (fs->is_mounted)
+        OE_RAISE_ERRNO(OE_EBUSY);
+
+    /* Cross check the file system type. */
+    if (oe_strcmp(filesystemtype, OE_DEVICE_NAME_RAM_FILE_SYSTEM) != 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* There are no mount options. */
+    if (data)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Remember whether this is a read-only mount. */
+    if ((flags & OE_MS_RDONLY))
+        fs->mount.flags = flags;
+
+    /* Save the target parameter (checked by the umount2() function). */
+    oe_strlcpy(fs->mount.target, target, sizeof(fs->mount.target));
+
+    /* Set the flag indicating that this file system is mounted. */
+    fs->is_mounted = true;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Called by oe_umount2(). */
+static int _ramfs_umount2(oe_device_t* device, const char* target, int flags)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+
+    OE_UNUSED(flags);
+
+    /* Fail if any required parameters are null. */
+    if (!fs || !target)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if this file system is not mounted. */
+    if (!fs->is_mounted)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Cross check target parameter with the one passed to mount(). */
+    if (oe_strcmp(target, fs->mount.target) != 0)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    /* Clear the cached mount parameters. */
+    oe_memset_s(&fs->mount, sizeof(fs->mount), 0, sizeof(fs->mount));
+
+    /* Set the flag indicating that this file system is mounted. */
+    fs->is_mounted = false;
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+/* Called by oe_mount() to make a copy of this device, with an empty root. */
+static int _ramfs_clone(oe_device_t* device, oe_device_t** new_device)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    device_t* new_fs = NULL;
+    inode_t* root = NULL;
+
+    if (!fs || !new_device)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(new_fs = oe_calloc(1, sizeof(device_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    oe_mutex_lock(&_lock);
+    root = _new_inode(OE_S_IFDIR | 0755);
+    oe_mutex_unlock(&_lock);
+
+    if (!root)
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    /* The device holds the root. */
+    root->links = 1;
+
+    *new_fs = *fs;
+    new_fs->root = root;
+    *new_device = &new_fs->base;
+    new_fs = NULL;
+
+    ret = 0;
+
+done:
+
+    if (new_fs)
+        oe_free(new_fs);
+
+    return ret;
+}
+
+/* Called by oe_umount() to release this device and its files. */
+static int _ramfs_release(oe_device_t* device)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+
+    if (!fs)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    {
+        _remove_tree(fs->root);
+        fs->root->links--;
+        _put_inode(fs->root);
+    }
+    oe_mutex_unlock(&_lock);
+
+    oe_free(fs);
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static oe_fd_t* _ramfs_open(
+    oe_device_t* device,
+    const char* pathname,
+    int flags,
+    oe_mode_t mode)
+{
+    oe_fd_t* ret = NULL;
+    device_t* fs = _cast_device(device);
+    const int access = flags & ACCESS_MODE_MASK;
+    file_t* file = NULL;
+    description_t* ofd = NULL;
+    lookup_t lookup;
+    inode_t* inode;
+    bool locked = false;
+
+    /* Fail if any required parameters are null. */
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs) && access != OE_O_RDONLY)
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    if (!(file = oe_calloc(1, sizeof(file_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (!(ofd = oe_calloc(1, sizeof(description_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, pathname, &lookup) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if ((inode = lookup.inode))
+    {
+        if ((flags & OE_O_CREAT) && (flags & OE_O_EXCL))
+            OE_RAISE_ERRNO(OE_EEXIST);
+
+        if (_is_dir(inode) && access != OE_O_RDONLY)
+            OE_RAISE_ERRNO(OE_EISDIR);
+
+        if (!_is_dir(inode) && (flags & OE_O_DIRECTORY))
+            OE_RAISE_ERRNO(OE_ENOTDIR);
+
+        if (!_is_dir(inode) && (flags & OE_O_TRUNC) && access != OE_O_RDONLY)
+            _resize(inode, 0);
+    }
+    else
+    {
+        if (!(flags & OE_O_CREAT) || (flags & OE_O_DIRECTORY))
+            OE_RAISE_ERRNO(OE_ENOENT);
+
+        if (_is_read_only(fs))
+            OE_RAISE_ERRNO(OE_EPERM);
+
+        if (!(inode = _new_inode(OE_S_IFREG | (mode & 07777))))
+            OE_RAISE_ERRNO(OE_ENOMEM);
+
+        if (_add_entry(lookup.parent, lookup.name, inode) != 0)
+        {
+            _put_inode(inode);
+            OE_RAISE_ERRNO(oe_errno);
+        }
+    }
+
+    inode->opens++;
+
+    ofd->refs = 1;
+    ofd->inode = inode;
+    ofd->flags = flags;
+
+    file->base.type = OE_FD_TYPE_FILE;
+    file->base.ops.file = _get_file_ops();
+    file->magic = FILE_MAGIC;
+    file->ofd = ofd;
+
+    ret = &file->base;
+    file = NULL;
+    ofd = NULL;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    if (ofd)
+        oe_free(ofd);
+
+    if (file)
+        oe_free(file);
+
+    return ret;
+}
+
+static int _ramfs_stat(
+    oe_device_t* device,
+    const char* pathname,
+    struct oe_stat* buf)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    lookup_t lookup;
+    const inode_t* inode;
+    bool locked = false;
+
+    if (buf)
+        oe_memset_s(buf, sizeof(*buf), 0, sizeof(*buf));
+
+    if (!fs || !pathname || !buf)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, pathname, &lookup) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!(inode = lookup.inode))
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    buf->st_dev = OE_DEVID_RAM_FILE_SYSTEM;
+    buf->st_ino = inode->ino;
+    buf->st_mode = inode->mode;
+    buf->st_blksize = BLOCK_SIZE;
+
+    if (_is_dir(inode))
+    {
+        /* Count "." and the ".." of every subdirectory. */
+        buf->st_nlink = inode->links + 1;
+
+        for (const entry_t* e = inode->entries; e; e = e->next)
+        {
+            if (_is_dir(e->inode))
+                buf->st_nlink++;
+        }
+    }
+    else
+    {
+        buf->st_nlink = inode->links;
+        buf->st_size = (oe_off_t)inode->size;
+        buf->st_blocks = (oe_blkcnt_t)((inode->capacity + 511) / 512);
+    }
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_access(oe_device_t* device, const char* pathname, int mode)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    const uint32_t MASK = (OE_R_OK | OE_W_OK | OE_X_OK);
+    lookup_t lookup;
+    bool locked = false;
+
+    if (!fs || !pathname || ((uint32_t)mode & ~MASK))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, pathname, &lookup) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!lookup.inode)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    if ((mode & OE_W_OK) && _is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EROFS);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_link(
+    oe_device_t* device,
+    const char* oldpath,
+    const char* newpath)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    lookup_t old;
+    lookup_t new;
+    bool locked = false;
+
+    if (!fs || !oldpath || !newpath)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, oldpath, &old) != 0 || _lookup(fs, newpath, &new) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!old.inode)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    if (_is_dir(old.inode))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    if (new.inode)
+        OE_RAISE_ERRNO(OE_EEXIST);
+
+    if (_add_entry(new.parent, new.name, old.inode) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_unlink(oe_device_t* device, const char* pathname)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    lookup_t lookup;
+    bool locked = false;
+
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, pathname, &lookup) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!lookup.inode)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    if (_is_dir(lookup.inode))
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    _remove_entry(lookup.parent, lookup.entry);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_rename(
+    oe_device_t* device,
+    const char* oldpath,
+    const char* newpath)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    lookup_t old;
+    lookup_t new;
+    inode_t* inode;
+    bool locked = false;
+
+    if (!fs || !oldpath || !newpath)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, oldpath, &old) != 0 || _lookup(fs, newpath, &new) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!(inode = old.inode))
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    /* The root, "." and ".." cannot be renamed or replaced. */
+    if (!old.parent || !new.parent)
+        OE_RAISE_ERRNO(OE_EBUSY);
+
+    /* Nothing to do if both paths refer to the same file. */
+    if (new.inode == inode)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    /* A directory cannot be moved below itself. */
+    if (_is_dir(inode))
+    {
+        for (inode_t* p = new.parent; p; p = p->parent)
+        {
+            if (p == inode)
+                OE_RAISE_ERRNO(OE_EINVAL);
+        }
+    }
+
+    /* An existing file is replaced by one of the same kind. */
+    if (new.inode)
+    {
+        if (_is_dir(inode) && !_is_dir(new.inode))
+            OE_RAISE_ERRNO(OE_ENOTDIR);
+
+        if (!_is_dir(inode) && _is_dir(new.inode))
+            OE_RAISE_ERRNO(OE_EISDIR);
+
+        if (new.inode->entries)
+            OE_RAISE_ERRNO(OE_ENOTEMPTY);
+    }
+
+    /* Add the new entry first, so that failing leaves the tree unchanged. */
+    if (_add_entry(new.parent, new.name, inode) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    _remove_entry(old.parent, old.entry);
+
+    /* The old entry of a directory cleared its parent. */
+    if (_is_dir(inode))
+        inode->parent = new.parent;
+
+    if (new.entry)
+        _remove_entry(new.parent, new.entry);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_truncate(
+    oe_device_t* device,
+    const char* path,
+    oe_off_t length)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    lookup_t lookup;
+    bool locked = false;
+
+    if (!fs || !path || length < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    if ((uint64_t)length > OE_SSIZE_MAX)
+        OE_RAISE_ERRNO(OE_EFBIG);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, path, &lookup) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!lookup.inode)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    if (_is_dir(lookup.inode))
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    if (_resize(lookup.inode, (size_t)length) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_mkdir(
+    oe_device_t* device,
+    const char* pathname,
+    oe_mode_t mode)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    lookup_t lookup;
+    inode_t* inode;
+    bool locked = false;
+
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, pathname, &lookup) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (lookup.inode)
+        OE_RAISE_ERRNO(OE_EEXIST);
+
+    if (!(inode = _new_inode(OE_S_IFDIR | (mode & 07777))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    if (_add_entry(lookup.parent, lookup.name, inode) != 0)
+    {
+        _put_inode(inode);
+        OE_RAISE_ERRNO(oe_errno);
+    }
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_rmdir(oe_device_t* device, const char* pathname)
+{
+    int ret = -1;
+    device_t* fs = _cast_device(device);
+    lookup_t lookup;
+    bool locked = false;
+
+    if (!fs || !pathname)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* Fail if attempting to write to a read-only file system. */
+    if (_is_read_only(fs))
+        OE_RAISE_ERRNO(OE_EPERM);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+
+    if (_lookup(fs, pathname, &lookup) != 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!lookup.inode)
+        OE_RAISE_ERRNO(OE_ENOENT);
+
+    if (!_is_dir(lookup.inode))
+        OE_RAISE_ERRNO(OE_ENOTDIR);
+
+    /* The root, "." and ".." cannot be removed. */
+    if (!lookup.parent)
+        OE_RAISE_ERRNO(OE_EBUSY);
+
+    if (lookup.inode->entries)
+        OE_RAISE_ERRNO(OE_ENOTEMPTY);
+
+    _remove_entry(lookup.parent, lookup.entry);
+
+    ret = 0;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+/*
+**==============================================================================
+**
+** File operations:
+**
+**==============================================================================
+*/
+
+OE_INLINE bool _can_read(const description_t* ofd)
+{
+    return (ofd->flags & ACCESS_MODE_MASK) != OE_O_WRONLY;
+}
+
+OE_INLINE bool _can_write(const description_t* ofd)
+{
+    return (ofd->flags & ACCESS_MODE_MASK) != OE_O_RDONLY;
+}
+
+static ssize_t _ramfs_read(oe_fd_t* desc, void* buf, size_t count)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    description_t* ofd;
+    bool locked = false;
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+    ofd = file->ofd;
+
+    if (_is_dir(ofd->inode))
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    if (!_can_read(ofd))
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    ret = _read_at(ofd->inode, buf, count, ofd->offset);
+    ofd->offset += ret;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static ssize_t _ramfs_write(oe_fd_t* desc, const void* buf, size_t count)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    description_t* ofd;
+    bool locked = false;
+
+    if (!file || (count && !buf))
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+    ofd = file->ofd;
+
+    if (!_can_write(ofd))
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    if ((ofd->flags & OE_O_APPEND))
+        ofd->offset = (oe_off_t)ofd->inode->size;
+
+    if ((ret = _write_at(ofd->inode, buf, count, ofd->offset)) < 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    ofd->offset += ret;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+/* Read into or write from an IO vector at the given offset. */
+static ssize_t _transfer_iov(
+    description_t* ofd,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset,
+    bool write)
+{
+    ssize_t ret = -1;
+    size_t total = 0;
+
+    for (int i = 0; i < iovcnt; i++)
+    {
+        const size_t len = iov[i].iov_len;
+        ssize_t n;
+
+        if (len && !iov[i].iov_base)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (len > OE_SSIZE_MAX - total)
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        if (write)
+            n = _write_at(ofd->inode, iov[i].iov_base, len, offset);
+        else
+            n = _read_at(ofd->inode, iov[i].iov_base, len, offset);
+
+        /* Report the bytes transferred before a failed write. */
+        if (n < 0)
+        {
+            if (total)
+                break;
+
+            OE_RAISE_ERRNO(oe_errno);
+        }
+
+        total += (size_t)n;
+        offset += n;
+
+        /* Stop at the end of the file. */
+        if ((size_t)n < len)
+            break;
+    }
+
+    ret = (ssize_t)total;
+
+done:
+    return ret;
+}
+
+static ssize_t _ramfs_rw_iov(
+    oe_fd_t* desc,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    const oe_off_t* offset,
+    bool write)
+{
+    ssize_t ret = -1;
+    file_t* file = _cast_file(desc);
+    description_t* ofd;
+    oe_off_t pos;
+    bool locked = false;
+
+    if (!file || (!iov && iovcnt) || iovcnt < 0 || iovcnt > OE_IOV_MAX)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+    ofd = file->ofd;
+
+    if (_is_dir(ofd->inode))
+        OE_RAISE_ERRNO(OE_EISDIR);
+
+    if (!(write ? _can_write(ofd) : _can_read(ofd)))
+        OE_RAISE_ERRNO(OE_EBADF);
+
+    /* Appending writes go to the end of the file, even positional ones. */
+    if (write && (ofd->flags & OE_O_APPEND))
+        pos = (oe_off_t)ofd->inode->size;
+    else
+        pos = offset ? *offset : ofd->offset;
+
+    if ((ret = _transfer_iov(ofd, iov, iovcnt, pos, write)) < 0)
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (!offset)
+        ofd->offset = pos + ret;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static ssize_t _ramfs_readv(
+    oe_fd_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    return _ramfs_rw_iov(file, iov, iovcnt, NULL, false);
+}
+
+static ssize_t _ramfs_writev(
+    oe_fd_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt)
+{
+    return _ramfs_rw_iov(file, iov, iovcnt, NULL, true);
+}
+
+static ssize_t _ramfs_pread(
+    oe_fd_t* file,
+    void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    struct oe_iovec iov = {buf, count};
+
+    return _ramfs_rw_iov(file, &iov, 1, &offset, false);
+}
+
+static ssize_t _ramfs_pwrite(
+    oe_fd_t* file,
+    const void* buf,
+    size_t count,
+    oe_off_t offset)
+{
+    struct oe_iovec iov = {(void*)buf, count};
+
+    return _ramfs_rw_iov(file, &iov, 1, &offset, true);
+}
+
+static ssize_t _ramfs_preadv(
+    oe_fd_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    return _ramfs_rw_iov(file, iov, iovcnt, &offset, false);
+}
+
+static ssize_t _ramfs_pwritev(
+    oe_fd_t* file,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    return _ramfs_rw_iov(file, iov, iovcnt, &offset, true);
+}
+
+static oe_off_t _ramfs_lseek(oe_fd_t* desc, oe_off_t offset, int whence)
+{
+    oe_off_t ret = -1;
+    file_t* file = _cast_file(desc);
+    description_t* ofd;
+    oe_off_t base;
+    bool locked = false;
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+    ofd = file->ofd;
+
+    switch (whence)
+    {
+        case OE_SEEK_SET:
+            base = 0;
+            break;
+        case OE_SEEK_CUR:
+            base = ofd->offset;
+            break;
+        case OE_SEEK_END:
+            base = (oe_off_t)ofd->inode->size;
+            break;
+        default:
+            OE_RAISE_ERRNO(OE_EINVAL);
+    }
+
+    if (offset < -base || offset > OE_SSIZE_MAX - base)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* The offset of a directory is the index of its next entry. */
+    ofd->offset = base + offset;
+    ret = ofd->offset;
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+/* Called by oe_getdents64() to handle the getdents64 system call. */
+static int _ramfs_getdents64(
+    oe_fd_t* desc,
+    struct oe_dirent* dirp,
+    uint32_t count)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    description_t* ofd;
+    const size_t n = count / sizeof(struct oe_dirent);
+    size_t i = 0;
+    bool locked = false;
+
+    if (!file || !dirp)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    locked = true;
+    ofd = file->ofd;
+
+    if (!_is_dir(ofd->inode))
+        OE_RAISE_ERRNO(OE_ENOTDIR);
+
+    /* Entries 0 and 1 are "." and "..", followed by the directory entries,
+     * of which the first to return is found by skipping over the others. */
+    {
+        inode_t* dir = ofd->inode;
+        const entry_t* entry = dir->entries;
+        oe_off_t index = ofd->offset;
+
+        for (oe_off_t skip = 2; skip < index && entry; skip++)
+            entry = entry->next;
+
+        while (i < n)
+        {
+            struct oe_dirent* ent = &dirp[i];
+            const inode_t* inode;
+            const char* name;
+
+            if (index == 0)
+            {
+                inode = dir;
+                name = ".";
+            }
+            else if (index == 1)
+            {
+                inode = _dotdot(dir);
+                name = "..";
+            }
+            else if (entry)
+            {
+                inode = entry->inode;
+                name = entry->name;
+                entry = entry->next;
+            }
+            else
+            {
+                break;
+            }
+
+            oe_memset_s(ent, sizeof(*ent), 0, sizeof(*ent));
+            ent->d_ino = inode->ino;
+            ent->d_off = ++index;
+            ent->d_reclen = sizeof(struct oe_dirent);
+            ent->d_type = _is_dir(inode) ? OE_DT_DIR : OE_DT_REG;
+            oe_strlcpy(ent->d_name, name, sizeof(ent->d_name));
+            i++;
+        }
+
+        /* The buffer cannot hold the next entry. */
+        if (n == 0 && (index < 2 || entry))
+            OE_RAISE_ERRNO(OE_EINVAL);
+
+        ofd->offset = index;
+    }
+
+    ret = (int)(i * sizeof(struct oe_dirent));
+
+done:
+
+    if (locked)
+        oe_mutex_unlock(&_lock);
+
+    return ret;
+}
+
+static int _ramfs_dup(oe_fd_t* desc, oe_fd_t** new_file_out)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+    file_t* new_file = NULL;
+
+    if (new_file_out)
+        *new_file_out = NULL;
+
+    /* Check parameters. */
+    if (!file || !new_file_out)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (!(new_file = oe_calloc(1, sizeof(file_t))))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    new_file->base.type = OE_FD_TYPE_FILE;
+    new_file->base.ops.file = _get_file_ops();
+    new_file->magic = FILE_MAGIC;
+
+    /* The duplicate shares the file offset and status flags. */
+    oe_mutex_lock(&_lock);
+    {
+        new_file->ofd = file->ofd;
+        new_file->ofd->refs++;
+    }
+    oe_mutex_unlock(&_lock);
+
+    *new_file_out = &new_file->base;
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _ramfs_ioctl(oe_fd_t* desc, unsigned long request, uint64_t arg)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    OE_UNUSED(request);
+    OE_UNUSED(arg);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    /* RAM files are not terminal devices, which MUSL checks for with the
+     * TIOCGWINSZ request. */
+    OE_RAISE_ERRNO(OE_ENOTTY);
+
+done:
+    return ret;
+}
+
+static int _ramfs_fcntl(oe_fd_t* desc, int cmd, uint64_t arg)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+
+    switch (cmd)
+    {
+        case OE_F_GETFD:
+            ret = file->fd_flags;
+            break;
+
+        case OE_F_SETFD:
+            file->fd_flags = (int)arg;
+            ret = 0;
+            break;
+
+        case OE_F_GETFL:
+            ret = file->ofd->flags;
+            break;
+
+        case OE_F_SETFL:
+            file->ofd->flags &= ~SETFL_MASK;
+            file->ofd->flags |= (int)arg & SETFL_MASK;
+            ret = 0;
+            break;
+
+        /* The files belong to this process, which no lock of its own can
+         * conflict with. */
+        case OE_F_GETLK64:
+        case OE_F_OFD_GETLK:
+        {
+            struct oe_flock* lock = (struct oe_flock*)arg;
+
+            if (lock)
+            {
+                lock->l_type = OE_F_UNLCK;
+                ret = 0;
+            }
+            else
+            {
+                oe_errno = OE_EFAULT;
+            }
+            break;
+        }
+
+        case OE_F_SETLKW64:
+        case OE_F_SETLK64:
+        case OE_F_OFD_SETLK:
+        case OE_F_OFD_SETLKW:
+            ret = 0;
+            break;
+
+        default:
+            oe_errno = OE_EINVAL;
+            break;
+    }
+
+    oe_mutex_unlock(&_lock);
+
+done:
+    return ret;
+}
+
+static int _ramfs_sync(oe_fd_t* desc)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    /* There is no backing store to write to. */
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static int _ramfs_close(oe_fd_t* desc)
+{
+    int ret = -1;
+    file_t* file = _cast_file(desc);
+
+    if (!file)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    oe_mutex_lock(&_lock);
+    {
+        description_t* ofd = file->ofd;
+
+        /* Release the inode with the last duplicate. */
+        if (--ofd->refs == 0)
+        {
+            ofd->inode->opens--;
+            _put_inode(ofd->inode);
+            oe_free(ofd);
+        }
+    }
+    oe_mutex_unlock(&_lock);
+
+    oe_free(file);
+    ret = 0;
+
+done:
+    return ret;
+}
+
+static oe_host_fd_t _ramfs_get_host_fd(oe_fd_t* file)
+{
+    OE_UNUSED(file);
+
+    return -1;
+}
+
+// clang-format off
+static oe_file_ops_t _file_ops =
+{
+    .fd.read = _ramfs_read,
+    .fd.write = _ramfs_write,
+    .fd.readv = _ramfs_readv,
+    .fd.writev = _ramfs_writev,
+    .fd.dup = _ramfs_dup,
+    .fd.ioctl = _ramfs_ioctl,
+    .fd.fcntl = _ramfs_fcntl,
+    .fd.close = _ramfs_close,
+    .fd.get_host_fd = _ramfs_get_host_fd,
+    .lseek = _ramfs_lseek,
+    .pread = _ramfs_pread,
+    .pwrite = _ramfs_pwrite,
+    .preadv = _ramfs_preadv,
+    .pwritev = _ramfs_pwritev,
+    .fsync = _ramfs_sync,
+    .fdatasync = _ramfs_sync,
+    .getdents64 = _ramfs_getdents64,
+};
+// clang-format on
+
+static oe_file_ops_t _get_file_ops(void)
+{
+    return _file_ops;
+};
+
+// clang-format off
+static device_t _ramfs =
+{
+    .base.type = OE_DEVICE_TYPE_FILE_SYSTEM,
+    .base.name = OE_DEVICE_NAME_RAM_FILE_SYSTEM,
+    .base.ops.fs =
+    {
+        .base.release = _ramfs_release,
+        .clone = _ramfs_clone,
+        .mount = _ramfs_mount,
+        .umount2 = _ramfs_umount2,
+        .open = _ramfs_open,
+        .stat = _ramfs_stat,
+        .access = _ramfs_access,
+        .link = _ramfs_link,
+        .unlink = _ramfs_unlink,
+        .rename = _ramfs_rename,
+        .truncate = _ramfs_truncate,
+        .mkdir = _ramfs_mkdir,
+        .rmdir = _ramfs_rmdir,
+    },
+    .magic = FS_MAGIC,
+};
+// clang-format on
+
+oe_result_t oe_load_module_ram_file_system(void)
+{
+    oe_result_t result = OE_UNEXPECTED;
+    static oe_spinlock_t _load_lock = OE_SPINLOCK_INITIALIZER;
+    static bool _loaded = false;
+
+    oe_spin_lock(&_load_lock);
+
+    if (!_loaded)
+    {
+        /* The loaded device has a root of its own, which is used when the
+         * device is selected with oe_set_thread_devid(). */
+        if (!_ramfs.root)
+        {
+            oe_mutex_lock(&_lock);
+            _ramfs.root = _new_inode(OE_S_IFDIR | 0755);
+            oe_mutex_unlock(&_lock);
+
+            if (!_ramfs.root)
+                OE_RAISE(OE_OUT_OF_MEMORY);
+
+            _ramfs.root->links = 1;
+        }
+
+        if (oe_device_table_set(OE_DEVID_RAM_FILE_SYSTEM, &_ramfs.base) != 0)
+        {
+            /* Do not propagate errno to caller. */
+            oe_errno = 0;
+            OE_RAISE(OE_FAILURE);
+        }
+
+        _loaded = true;
+    }
+
+    result = OE_OK;
+
+done:
+    oe_spin_unlock(&_load_lock);
+
+    return result;
+}
@@ -166,6 +166,12 @@ static void _assert_fd(oe_fd_t* desc)
         case OE_FD_TYPE_FILE:
         {
             oe_assert(desc->ops.file.lseek);
+            oe_assert(desc->ops.file.pread);
+            oe_assert(desc->ops.file.pwrite);
+            oe_assert(desc->ops.file.preadv);
+            oe_assert(desc->ops.file.pwritev);
+            oe_assert(desc->ops.file.fsync);
+            oe_assert(desc->ops.file.fdatasync);
             oe_assert(desc->ops.file.getdents64);
             break;
         }
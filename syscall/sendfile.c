@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+
+#include <openenclave/corelibc/stdlib.h>
+#include <openenclave/internal/syscall/fdtable.h>
+#include <openenclave/internal/syscall/raise.h>
+#include <openenclave/internal/syscall/sys/sendfile.h>
+#include <openenclave/internal/syscall/unistd.h>
+#include "syscall_t.h"
+
+/* Size of the buffer used when the data has to pass through the enclave. */
+#define COPY_BUFFER_SIZE (64 * 1024)
+
+/* Copy through enclave memory, for descriptors without a host descriptor.
+ * Data read but not written is given back to the file offset of in. */
+static ssize_t _copy(oe_fd_t* out, oe_fd_t* in, oe_off_t* offset, size_t count)
+{
+    ssize_t ret = -1;
+    const size_t size = count < COPY_BUFFER_SIZE ? count : COPY_BUFFER_SIZE;
+    uint8_t* buf = NULL;
+    size_t total = 0;
+
+    if (count == 0)
+    {
+        ret = 0;
+        goto done;
+    }
+
+    if (!(buf = oe_malloc(size)))
+        OE_RAISE_ERRNO(OE_ENOMEM);
+
+    while (total < count)
+    {
+        const size_t n = count - total < size ? count - total : size;
+        ssize_t r;
+        ssize_t w;
+
+        if (offset)
+            r = in->ops.file.pread(in, buf, n, *offset + (oe_off_t)total);
+        else
+            r = in->ops.fd.read(in, buf, n);
+
+        if (r < 0 && total == 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        /* Stop at the end of the file; a later error is reported by the
+         * next call. */
+        if (r <= 0)
+            break;
+
+        w = out->ops.fd.write(out, buf, (size_t)r);
+
+        if (w > 0)
+            total += (size_t)w;
+
+        if (w < r)
+        {
+            const int err = oe_errno;
+
+            if (!offset)
+            {
+                const oe_off_t unwritten = r - (w > 0 ? w : 0);
+                in->ops.file.lseek(in, -unwritten, OE_SEEK_CUR);
+            }
+
+            if (w < 0 && total == 0)
+                OE_RAISE_ERRNO(err);
+
+            break;
+        }
+    }
+
+    if (offset)
+        *offset += (oe_off_t)total;
+
+    ret = (ssize_t)total;
+
+done:
+
+    if (buf)
+        oe_free(buf);
+
+    return ret;
+}
+
+ssize_t oe_sendfile(int out_fd, int in_fd, oe_off_t* offset, size_t count)
+{
+    ssize_t ret = -1;
+    oe_fd_t* out;
+    oe_fd_t* in;
+    oe_host_fd_t out_host_fd;
+    oe_host_fd_t in_host_fd;
+
+    if (!(out = oe_fdtable_get(out_fd, OE_FD_TYPE_ANY)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    /* Like Linux, only files may be read from. */
+    if (!(in = oe_fdtable_get(in_fd, OE_FD_TYPE_FILE)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (offset && *offset < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    if (count > OE_SSIZE_MAX)
+        count = OE_SSIZE_MAX;
+
+    /* If both have host descriptors, the data does not enter the enclave. */
+    if ((out_host_fd = out->ops.fd.get_host_fd(out)) >= 0 &&
+        (in_host_fd = in->ops.fd.get_host_fd(in)) >= 0)
+    {
+        ssize_t retval = -1;
+
+        if (oe_syscall_sendfile_ocall(
+                &retval,
+                out_host_fd,
+                in_host_fd,
+                offset ? *offset : -1,
+                count) != OE_OK)
+        {
+            OE_RAISE_ERRNO(OE_EINVAL);
+        }
+
+        if (retval < 0)
+            OE_RAISE_ERRNO(oe_errno);
+
+        if ((size_t)retval > count)
+            OE_RAISE_ERRNO(OE_EIO);
+
+        if (offset)
+            *offset += (oe_off_t)retval;
+
+        ret = retval;
+        goto done;
+    }
+
+    ret = _copy(out, in, offset, count);
+
+done:
+    return ret;
+}
@@ -17,6 +17,7 @@
 #include <openenclave/internal/syscall/sys/mount.h>
 #include <openenclave/internal/syscall/sys/poll.h>
 #include <openenclave/internal/syscall/sys/select.h>
+#include <openenclave/internal/syscall/sys/sendfile.h>
 #include <openenclave/internal/syscall/sys/socket.h>
 #include <openenclave/internal/syscall/sys/stat.h>
 #include <openenclave/internal/syscall/sys/syscall.h>
@@ -112,6 +113,70 @@ static long _syscall(
             ret = oe_lseek(fd, off, whence);
             goto done;
         }
+        case OE_SYS_pread64:
+        {
+            int fd = (int)arg1;
+            void* buf = (void*)arg2;
+            size_t count = (size_t)arg3;
+            oe_off_t offset = (oe_off_t)arg4;
+
+            ret = oe_pread(fd, buf, count, offset);
+            goto done;
+        }
+        case OE_SYS_pwrite64:
+        {
+            int fd = (int)arg1;
+            const void* buf = (const void*)arg2;
+            size_t count = (size_t)arg3;
+            oe_off_t offset = (oe_off_t)arg4;
+
+            ret = oe_pwrite(fd, buf, count, offset);
+            goto done;
+        }
+        case OE_SYS_sendfile:
+        {
+            int out_fd = (int)arg1;
+            int in_fd = (int)arg2;
+            oe_off_t* offset = (oe_off_t*)arg3;
+            size_t count = (size_t)arg4;
+
+            ret = oe_sendfile(out_fd, in_fd, offset, count);
+            goto done;
+        }
+        case OE_SYS_preadv:
+        {
+            int fd = (int)arg1;
+            const struct oe_iovec* iov = (const struct oe_iovec*)arg2;
+            int iovcnt = (int)arg3;
+            oe_off_t offset = (oe_off_t)arg4; /* Low word; 64-bit only */
+
+            ret = oe_preadv(fd, iov, iovcnt, offset);
+            goto done;
+        }
+        case OE_SYS_pwritev:
+        {
+            int fd = (int)arg1;
+            const struct oe_iovec* iov = (const struct oe_iovec*)arg2;
+            int iovcnt = (int)arg3;
+            oe_off_t offset = (oe_off_t)arg4; /* Low word; 64-bit only */
+
+            ret = oe_pwritev(fd, iov, iovcnt, offset);
+            goto done;
+        }
+        case OE_SYS_fsync:
+        {
+            int fd = (int)arg1;
+
+            ret = oe_fsync(fd);
+            goto done;
+        }
+        case OE_SYS_fdatasync:
+        {
+            int fd = (int)arg1;
+
+            ret = oe_fdatasync(fd);
+            goto done;
+        }
         case OE_SYS_readv:
         {
             int fd = (int)arg1;
@@ -501,6 +501,119 @@ done:
     return ret;
 }
 
+/* Get the file of a positional I/O call; other descriptors cannot seek. */
+static oe_fd_t* _get_seekable_file(int fd, oe_off_t offset)
+{
+    oe_fd_t* ret = NULL;
+    oe_fd_t* desc;
+
+    if (!(desc = oe_fdtable_get(fd, OE_FD_TYPE_ANY)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    if (desc->type != OE_FD_TYPE_FILE)
+        OE_RAISE_ERRNO(OE_ESPIPE);
+
+    if (offset < 0)
+        OE_RAISE_ERRNO(OE_EINVAL);
+
+    ret = desc;
+
+done:
+    return ret;
+}
+
+ssize_t oe_pread(int fd, void* buf, size_t count, oe_off_t offset)
+{
+    ssize_t ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = _get_seekable_file(fd, offset)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = file->ops.file.pread(file, buf, count, offset);
+
+done:
+    return ret;
+}
+
+ssize_t oe_pwrite(int fd, const void* buf, size_t count, oe_off_t offset)
+{
+    ssize_t ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = _get_seekable_file(fd, offset)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = file->ops.file.pwrite(file, buf, count, offset);
+
+done:
+    return ret;
+}
+
+ssize_t oe_preadv(
+    int fd,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = _get_seekable_file(fd, offset)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = file->ops.file.preadv(file, iov, iovcnt, offset);
+
+done:
+    return ret;
+}
+
+ssize_t oe_pwritev(
+    int fd,
+    const struct oe_iovec* iov,
+    int iovcnt,
+    oe_off_t offset)
+{
+    ssize_t ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = _get_seekable_file(fd, offset)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = file->ops.file.pwritev(file, iov, iovcnt, offset);
+
+done:
+    return ret;
+}
+
+int oe_fsync(int fd)
+{
+    int ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = file->ops.file.fsync(file);
+
+done:
+    return ret;
+}
+
+int oe_fdatasync(int fd)
+{
+    int ret = -1;
+    oe_fd_t* file;
+
+    if (!(file = oe_fdtable_get(fd, OE_FD_TYPE_FILE)))
+        OE_RAISE_ERRNO(oe_errno);
+
+    ret = file->ops.file.fdatasync(file);
+
+done:
+    return ret;
+}
+
 ssize_t oe_readv(int fd, const struct oe_iovec* iov, int iovcnt)
 {
     ssize_t ret = -1;
@@ -0,0 +1,131 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/edger8r/host.h>
+#include <openenclave/host.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "async_ecall_u.h"
+
+#define NUM_CALLS 256
+
+/* The marshaled arguments of enc_square(), padded as edger8r does */
+#define ARGS_SIZE                                                       \
+    ((sizeof(enc_square_args_t) + OE_EDGER8R_BUFFER_ALIGNMENT - 1) / \
+     OE_EDGER8R_BUFFER_ALIGNMENT * OE_EDGER8R_BUFFER_ALIGNMENT)
+
+typedef struct _call
+{
+    uint8_t buffer[2 * ARGS_SIZE];
+    oe_call_handle_t* handle;
+    uint64_t value;
+} call_t;
+
+static call_t _calls[NUM_CALLS];
+static volatile uint64_t _num_completions;
+
+static void _check_output(call_t* call, size_t output_bytes_written)
+{
+    enc_square_args_t* out = (enc_square_args_t*)(call->buffer + ARGS_SIZE);
+
+    OE_TEST(output_bytes_written == ARGS_SIZE);
+    OE_TEST(out->_result == OE_OK);
+    OE_TEST(out->_retval == call->value * call->value);
+}
+
+static void _completion(
+    oe_result_t result,
+    size_t output_bytes_written,
+    void* context)
+{
+    OE_TEST(result == OE_OK);
+    _check_output((call_t*)context, output_bytes_written);
+    oe_atomic_increment(&_num_completions);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_t* enclave = NULL;
+    uint64_t expected_completions = 0;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if ((result = oe_create_async_ecall_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    /* A call must report its completion somehow */
+    OE_TEST(
+        oe_call_enclave_function_async(
+            enclave,
+            async_ecall_fcn_id_enc_square,
+            _calls[0].buffer,
+            ARGS_SIZE,
+            _calls[0].buffer + ARGS_SIZE,
+            ARGS_SIZE,
+            NULL,
+            NULL,
+            NULL) == OE_INVALID_PARAMETER);
+
+    /* Every third call is waited for; the others only use the callback */
+    for (size_t i = 0; i < NUM_CALLS; i++)
+    {
+        call_t* call = &_calls[i];
+        const bool wait = (i % 3) == 0;
+        const bool callback = !wait || (i % 2) == 0;
+
+        memset(call->buffer, 0, sizeof(call->buffer));
+        call->value = i;
+        ((enc_square_args_t*)call->buffer)->value = i;
+
+        if (callback)
+            expected_completions++;
+
+        OE_TEST(
+            oe_call_enclave_function_async(
+                enclave,
+                async_ecall_fcn_id_enc_square,
+                call->buffer,
+                ARGS_SIZE,
+                call->buffer + ARGS_SIZE,
+                ARGS_SIZE,
+                callback ? _completion : NULL,
+                call,
+                wait ? &call->handle : NULL) == OE_OK);
+    }
+
+    for (size_t i = 0; i < NUM_CALLS; i++)
+    {
+        call_t* call = &_calls[i];
+        size_t output_bytes_written = 0;
+
+        if (!call->handle)
+            continue;
+
+        OE_TEST(
+            oe_wait_enclave_function_async(
+                call->handle, &output_bytes_written) == OE_OK);
+        _check_output(call, output_bytes_written);
+    }
+
+    /* Termination runs the calls that are still queued */
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    OE_TEST(_num_completions == expected_completions);
+
+    printf("=== passed all tests (async_ecall)\n");
+
+    return 0;
+}
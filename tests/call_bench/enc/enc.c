@@ -0,0 +1,63 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include <stdlib.h>
+#include <string.h>
+#include "call_bench_t.h"
+
+void enc_empty(void)
+{
+}
+
+void enc_empty_switchless(void)
+{
+}
+
+void enc_payload(const uint8_t* buffer, size_t size)
+{
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+}
+
+void enc_nested(void)
+{
+    OE_TEST(host_nested() == OE_OK);
+}
+
+void enc_run_ocalls(size_t slot, size_t iterations)
+{
+    for (size_t i = 0; i < iterations; i++)
+        OE_TEST(host_empty(slot) == OE_OK);
+}
+
+void enc_run_switchless_ocalls(size_t slot, size_t iterations)
+{
+    for (size_t i = 0; i < iterations; i++)
+        OE_TEST(host_empty_switchless(slot) == OE_OK);
+}
+
+void enc_run_payload_ocalls(size_t slot, size_t iterations, size_t size)
+{
+    uint8_t* buffer = NULL;
+
+    if (size)
+    {
+        OE_TEST((buffer = (uint8_t*)malloc(size)) != NULL);
+        memset(buffer, 0xAB, size);
+    }
+
+    for (size_t i = 0; i < iterations; i++)
+        OE_TEST(host_payload(slot, buffer, size) == OE_OK);
+
+    free(buffer);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    8192, /* HeapPageCount (room for several 1 MB payloads in flight) */
+    64,   /* StackPageCount */
+    20);  /* TCSCount (16 host threads + 2 switchless workers + spare) */
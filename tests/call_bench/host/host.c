@@ -0,0 +1,421 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "call_bench_u.h"
+
+/*
+**==============================================================================
+**
+** ECALL/OCALL transition micro-benchmark.
+**
+**     Measures the latency of each kind of call for 1, 2, 4, ... host
+**     threads and prints p50/p99 latency and throughput as JSON:
+**
+**         {
+**           "simulate": true,
+**           "iterations": 1000,
+**           "results": [
+**             { "name": "ecall", "threads": 1, "payload": 0,
+**               "samples": 1000, "p50_ns": 1234, "p99_ns": 2345,
+**               "calls_per_sec": 800000.0 },
+**             ...
+**           ]
+**         }
+**
+**     ECALL latencies are measured around each call. The enclave cannot
+**     read a clock, so OCALL latencies are the interval between successive
+**     arrivals of back-to-back OCALLs on the host, i.e. one full round trip.
+**
+**==============================================================================
+*/
+
+#define MAX_THREADS 16 /* Bounded by the enclave's TCS count */
+#define NUM_ENCLAVE_WORKERS 2
+#define NUM_HOST_WORKERS 2
+#define LARGE_PAYLOAD (64 * 1024)
+
+typedef enum _bench_kind
+{
+    BENCH_ECALL,
+    BENCH_ECALL_SWITCHLESS,
+    BENCH_ECALL_PAYLOAD,
+    BENCH_NESTED,
+    BENCH_OCALL,
+    BENCH_OCALL_SWITCHLESS,
+    BENCH_OCALL_PAYLOAD,
+} bench_kind_t;
+
+typedef struct _bench
+{
+    const char* name;
+    bench_kind_t kind;
+    bool has_payload;
+} bench_t;
+
+static const bench_t _benches[] = {
+    {"ecall", BENCH_ECALL, false},
+    {"ecall_switchless", BENCH_ECALL_SWITCHLESS, false},
+    {"ecall_payload", BENCH_ECALL_PAYLOAD, true},
+    {"nested_ecall_in_ocall", BENCH_NESTED, false},
+    {"ocall", BENCH_OCALL, false},
+    {"ocall_switchless", BENCH_OCALL_SWITCHLESS, false},
+    {"ocall_payload", BENCH_OCALL_PAYLOAD, true},
+};
+
+static const size_t _payload_sizes[] =
+    {0, 64, 1024, 16 * 1024, 256 * 1024, 1024 * 1024};
+
+typedef struct _thread_context
+{
+    oe_enclave_t* enclave;
+    const bench_t* bench;
+    size_t slot;
+    size_t iterations;
+    size_t payload_size;
+    uint8_t* payload;
+    uint64_t* samples;
+    size_t num_samples;
+    uint64_t last_arrival;
+} thread_context_t;
+
+static oe_enclave_t* _enclave;
+
+/* Contexts of the running benchmark threads, indexed by slot. Switchless
+ * OCALLs run on host worker threads, so thread-locals cannot be used. */
+static thread_context_t* _contexts[MAX_THREADS];
+
+static uint64_t _now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void _record_arrival(size_t slot)
+{
+    const uint64_t now = _now();
+    thread_context_t* context;
+
+    OE_TEST(slot < MAX_THREADS && (context = _contexts[slot]));
+
+    if (context->last_arrival)
+        context->samples[context->num_samples++] = now - context->last_arrival;
+
+    context->last_arrival = now;
+}
+
+void host_empty(size_t slot)
+{
+    _record_arrival(slot);
+}
+
+void host_empty_switchless(size_t slot)
+{
+    _record_arrival(slot);
+}
+
+void host_payload(size_t slot, const uint8_t* buffer, size_t size)
+{
+    OE_UNUSED(buffer);
+    OE_UNUSED(size);
+    _record_arrival(slot);
+}
+
+void host_nested(void)
+{
+    OE_TEST(enc_empty(_enclave) == OE_OK);
+}
+
+static void _time_ecall(thread_context_t* context, size_t i)
+{
+    oe_enclave_t* enclave = context->enclave;
+    const uint64_t start = _now();
+
+    switch (context->bench->kind)
+    {
+        case BENCH_ECALL:
+            OE_TEST(enc_empty(enclave) == OE_OK);
+            break;
+        case BENCH_ECALL_SWITCHLESS:
+            OE_TEST(enc_empty_switchless(enclave) == OE_OK);
+            break;
+        case BENCH_ECALL_PAYLOAD:
+            OE_TEST(
+                enc_payload(
+                    enclave, context->payload, context->payload_size) ==
+                OE_OK);
+            break;
+        case BENCH_NESTED:
+            OE_TEST(enc_nested(enclave) == OE_OK);
+            break;
+        default:
+            OE_TEST("unexpected benchmark" == NULL);
+    }
+
+    /* Calls before the first sample slot are warm-up */
+    if (i < context->iterations)
+        context->samples[context->num_samples++] = _now() - start;
+}
+
+static void* _bench_thread(void* arg)
+{
+    thread_context_t* context = (thread_context_t*)arg;
+    oe_enclave_t* enclave = context->enclave;
+    const size_t slot = context->slot;
+    const size_t iterations = context->iterations;
+
+    switch (context->bench->kind)
+    {
+        case BENCH_OCALL:
+            /* One extra OCALL since the first arrival has no predecessor */
+            OE_TEST(enc_run_ocalls(enclave, slot, iterations + 1) == OE_OK);
+            break;
+        case BENCH_OCALL_SWITCHLESS:
+            OE_TEST(
+                enc_run_switchless_ocalls(enclave, slot, iterations + 1) ==
+                OE_OK);
+            break;
+        case BENCH_OCALL_PAYLOAD:
+            OE_TEST(
+                enc_run_payload_ocalls(
+                    enclave,
+                    slot,
+                    iterations + 1,
+                    context->payload_size) == OE_OK);
+            break;
+        default:
+        {
+            /* A few untimed calls first to warm up caches and TCS hints */
+            for (size_t i = iterations; i < iterations + 8; i++)
+                _time_ecall(context, i);
+
+            for (size_t i = 0; i < iterations; i++)
+                _time_ecall(context, i);
+        }
+    }
+
+    return NULL;
+}
+
+static int _compare_u64(const void* a, const void* b)
+{
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static void _run_bench(
+    FILE* out,
+    bool* first,
+    oe_enclave_t* enclave,
+    const bench_t* bench,
+    size_t num_threads,
+    size_t iterations,
+    size_t payload_size)
+{
+    thread_context_t contexts[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    uint64_t* samples;
+    size_t num_samples = 0;
+    uint64_t start;
+    uint64_t elapsed;
+
+    /* Large copies dominate; fewer iterations keep the sweep short */
+    if (payload_size >= LARGE_PAYLOAD && iterations > 64)
+        iterations /= 16;
+
+    OE_TEST((samples = calloc(num_threads * iterations, sizeof(uint64_t))));
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        thread_context_t* context = &contexts[i];
+
+        memset(context, 0, sizeof(*context));
+        context->enclave = enclave;
+        context->bench = bench;
+        context->slot = i;
+        context->iterations = iterations;
+        context->payload_size = payload_size;
+        context->samples = samples + i * iterations;
+        _contexts[i] = context;
+
+        if (bench->kind == BENCH_ECALL_PAYLOAD && payload_size)
+        {
+            OE_TEST((context->payload = malloc(payload_size)));
+            memset(context->payload, 0xAB, payload_size);
+        }
+    }
+
+    start = _now();
+
+    for (size_t i = 0; i < num_threads; i++)
+        OE_TEST(
+            pthread_create(&threads[i], NULL, _bench_thread, &contexts[i]) ==
+            0);
+
+    for (size_t i = 0; i < num_threads; i++)
+        pthread_join(threads[i], NULL);
+
+    elapsed = _now() - start;
+
+    /* Gather the samples of all threads at the front of the array */
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        memmove(
+            samples + num_samples,
+            contexts[i].samples,
+            contexts[i].num_samples * sizeof(uint64_t));
+        num_samples += contexts[i].num_samples;
+        free(contexts[i].payload);
+        _contexts[i] = NULL;
+    }
+
+    OE_TEST(num_samples == num_threads * iterations);
+    qsort(samples, num_samples, sizeof(uint64_t), _compare_u64);
+
+    fprintf(
+        out,
+        "%s    { \"name\": \"%s\", \"threads\": %zu, \"payload\": %zu, "
+        "\"samples\": %zu, \"p50_ns\": %llu, \"p99_ns\": %llu, "
+        "\"calls_per_sec\": %.1f }",
+        *first ? "" : ",\n",
+        bench->name,
+        num_threads,
+        payload_size,
+        num_samples,
+        (unsigned long long)samples[num_samples / 2],
+        (unsigned long long)samples[num_samples * 99 / 100],
+        (double)num_samples * 1e9 / (double)(elapsed ? elapsed : 1));
+    fflush(out);
+
+    *first = false;
+    free(samples);
+}
+
+static size_t _parse_size(const char* str)
+{
+    char* end = NULL;
+    unsigned long long value = strtoull(str, &end, 10);
+
+    if (!end || *end || value == 0)
+    {
+        fprintf(stderr, "invalid number: %s\n", str);
+        exit(1);
+    }
+
+    return (size_t)value;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_result_t result;
+    oe_enclave_config_t config = {0};
+    size_t iterations = 10000;
+    size_t max_threads = 4;
+    const char* output_path = NULL;
+    FILE* out = stdout;
+    bool first = true;
+
+    if (argc < 2 || argc % 2 != 0)
+    {
+        fprintf(
+            stderr,
+            "Usage: %s ENCLAVE_PATH [--iterations N] [--max-threads N] "
+            "[--output FILE]\n",
+            argv[0]);
+        return 1;
+    }
+
+    for (int i = 2; i < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--iterations") == 0)
+            iterations = _parse_size(argv[i + 1]);
+        else if (strcmp(argv[i], "--max-threads") == 0)
+            max_threads = _parse_size(argv[i + 1]);
+        else if (strcmp(argv[i], "--output") == 0)
+            output_path = argv[i + 1];
+        else
+        {
+            fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (max_threads > MAX_THREADS)
+        max_threads = MAX_THREADS;
+
+    if (output_path && !(out = fopen(output_path, "w")))
+    {
+        fprintf(stderr, "cannot open %s\n", output_path);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    config.max_enclave_workers = NUM_ENCLAVE_WORKERS;
+    config.max_host_workers = NUM_HOST_WORKERS;
+
+    if ((result = oe_create_call_bench_enclave(
+             argv[1],
+             OE_ENCLAVE_TYPE_SGX,
+             flags,
+             &config,
+             sizeof(config),
+             &_enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    fprintf(
+        out,
+        "{\n  \"simulate\": %s,\n  \"iterations\": %zu,\n  \"results\": [\n",
+        (flags & OE_ENCLAVE_FLAG_SIMULATE) ? "true" : "false",
+        iterations);
+
+    for (size_t b = 0; b < OE_COUNTOF(_benches); b++)
+    {
+        const bench_t* bench = &_benches[b];
+
+        for (size_t threads = 1; threads <= max_threads; threads *= 2)
+        {
+            if (!bench->has_payload)
+            {
+                _run_bench(
+                    out, &first, _enclave, bench, threads, iterations, 0);
+                continue;
+            }
+
+            for (size_t s = 0; s < OE_COUNTOF(_payload_sizes); s++)
+            {
+                _run_bench(
+                    out,
+                    &first,
+                    _enclave,
+                    bench,
+                    threads,
+                    iterations,
+                    _payload_sizes[s]);
+            }
+        }
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout)
+        fclose(out);
+
+    result = oe_terminate_enclave(_enclave);
+    OE_TEST(result == OE_OK);
+
+    fprintf(stderr, "=== passed all tests (call_bench)\n");
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/allocator.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/thread.h>
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+#include "allocator.h"
+
+/*
+**==============================================================================
+**
+** A minimal replacement allocator:
+**
+**     Blocks are powers of two carved out of the heap range passed to
+**     oe_allocator_init() with a bump pointer, and recycled through one free
+**     list per size. A header just before each block records where the
+**     underlying block starts and its size class, so aligned blocks can be
+**     freed like any other.
+**
+**==============================================================================
+*/
+
+#define MIN_SHIFT 5
+#define NUM_CLASSES 26 /* Blocks of 32 bytes to 1 GB */
+
+typedef struct _header
+{
+    uint8_t* base;
+    size_t size_class;
+} header_t;
+
+static oe_spinlock_t _lock = OE_SPINLOCK_INITIALIZER;
+static uint8_t* _heap_next;
+static void* _free_lists[NUM_CLASSES];
+
+test_allocator_stats_t test_allocator_stats;
+
+static header_t* _header(void* ptr)
+{
+    return (header_t*)ptr - 1;
+}
+
+static size_t _class_size(size_t size_class)
+{
+    return (size_t)1 << (size_class + MIN_SHIFT);
+}
+
+/* Allocate a raw block of at least the given size */
+static uint8_t* _alloc_block(size_t size, size_t* size_class_out)
+{
+    size_t size_class = 0;
+    uint8_t* block = NULL;
+
+    while (size_class < NUM_CLASSES && _class_size(size_class) < size)
+        size_class++;
+
+    if (size_class == NUM_CLASSES)
+        return NULL;
+
+    oe_spin_lock(&_lock);
+
+    if ((block = _free_lists[size_class]))
+    {
+        _free_lists[size_class] = *(void**)block;
+    }
+    else if (
+        (size_t)((uint8_t*)test_allocator_stats.heap_end - _heap_next) >=
+        _class_size(size_class))
+    {
+        block = _heap_next;
+        _heap_next += _class_size(size_class);
+    }
+
+    oe_spin_unlock(&_lock);
+
+    *size_class_out = size_class;
+    return block;
+}
+
+void oe_allocator_init(void* heap_start_address, void* heap_end_address)
+{
+    test_allocator_stats.heap_start = heap_start_address;
+    test_allocator_stats.heap_end = heap_end_address;
+    test_allocator_stats.init_calls++;
+    _heap_next = (uint8_t*)heap_start_address;
+}
+
+void oe_allocator_cleanup(void)
+{
+    test_allocator_stats.cleanup_calls++;
+}
+
+void* oe_allocator_memalign(size_t alignment, size_t size)
+{
+    uint8_t* base;
+    uint8_t* ptr;
+    size_t size_class;
+
+    if (alignment < sizeof(header_t))
+        alignment = sizeof(header_t);
+
+    if ((alignment & (alignment - 1)) || size > _class_size(NUM_CLASSES - 1))
+        return NULL;
+
+    base = _alloc_block(size + alignment + sizeof(header_t), &size_class);
+
+    if (!base)
+        return NULL;
+
+    ptr = base + sizeof(header_t);
+    ptr += (alignment - (uintptr_t)ptr % alignment) % alignment;
+    _header(ptr)->base = base;
+    _header(ptr)->size_class = size_class;
+
+    oe_atomic_increment(&test_allocator_stats.malloc_calls);
+
+    return ptr;
+}
+
+void* oe_allocator_malloc(size_t size)
+{
+    return oe_allocator_memalign(sizeof(header_t), size);
+}
+
+void oe_allocator_free(void* ptr)
+{
+    header_t* header;
+
+    if (!ptr)
+        return;
+
+    header = _header(ptr);
+
+    oe_spin_lock(&_lock);
+    *(void**)header->base = _free_lists[header->size_class];
+    _free_lists[header->size_class] = header->base;
+    oe_spin_unlock(&_lock);
+
+    oe_atomic_increment(&test_allocator_stats.free_calls);
+}
+
+void* oe_allocator_calloc(size_t nmemb, size_t size)
+{
+    void* ptr;
+
+    if (size && nmemb > SIZE_MAX / size)
+        return NULL;
+
+    if ((ptr = oe_allocator_malloc(nmemb * size)))
+        memset(ptr, 0, nmemb * size);
+
+    return ptr;
+}
+
+void* oe_allocator_realloc(void* ptr, size_t size)
+{
+    header_t* header;
+    size_t usable;
+    void* new_ptr;
+
+    if (!ptr)
+        return oe_allocator_malloc(size);
+
+    header = _header(ptr);
+    usable = _class_size(header->size_class) -
+             (size_t)((uint8_t*)ptr - header->base);
+
+    if (size <= usable)
+        return ptr;
+
+    if (!(new_ptr = oe_allocator_malloc(size)))
+        return NULL;
+
+    memcpy(new_ptr, ptr, usable);
+    oe_allocator_free(ptr);
+
+    return new_ptr;
+}
+
+int oe_allocator_posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+    void* ptr;
+
+    if (!alignment || (alignment & (alignment - 1)) ||
+        alignment % sizeof(void*))
+        return EINVAL;
+
+    if (!(ptr = oe_allocator_memalign(alignment, size)))
+        return ENOMEM;
+
+    *memptr = ptr;
+    return 0;
+}
@@ -0,0 +1,22 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _CUSTOM_ALLOCATOR_ENC_ALLOCATOR_H
+#define _CUSTOM_ALLOCATOR_ENC_ALLOCATOR_H
+
+#include <stdint.h>
+
+/* What the replacement allocator in allocator.c has been asked to do */
+typedef struct _test_allocator_stats
+{
+    void* heap_start;
+    void* heap_end;
+    uint64_t init_calls;
+    uint64_t cleanup_calls;
+    volatile uint64_t malloc_calls;
+    volatile uint64_t free_calls;
+} test_allocator_stats_t;
+
+extern test_allocator_stats_t test_allocator_stats;
+
+#endif /* _CUSTOM_ALLOCATOR_ENC_ALLOCATOR_H */
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/globals.h>
+#include <openenclave/internal/tests.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocator.h"
+#include "custom_allocator_t.h"
+
+static void _check_in_heap(const void* ptr, size_t size)
+{
+    const uint8_t* start = (const uint8_t*)__oe_get_heap_base();
+    const uint8_t* end = (const uint8_t*)__oe_get_heap_end();
+
+    OE_TEST(ptr != NULL);
+    OE_TEST((const uint8_t*)ptr >= start);
+    OE_TEST((const uint8_t*)ptr + size <= end);
+}
+
+/* Called when the enclave terminates, after every block allocated by the
+ * tests was written, to check that the at-exit entry was not overwritten */
+static void _atexit_handler(void)
+{
+    OE_TEST(host_atexit_called() == OE_OK);
+}
+
+void enc_test_allocator(void)
+{
+    static bool _atexit_registered;
+    const uint64_t malloc_calls = test_allocator_stats.malloc_calls;
+    const uint64_t free_calls = test_allocator_stats.free_calls;
+    uint8_t* ptr;
+    void* aligned = NULL;
+    oe_heap_stats_t stats;
+
+    /* The runtime handed the whole heap to the allocator exactly once */
+    OE_TEST(test_allocator_stats.init_calls == 1);
+    OE_TEST(test_allocator_stats.cleanup_calls == 0);
+    OE_TEST(test_allocator_stats.heap_start == __oe_get_heap_base());
+    OE_TEST(test_allocator_stats.heap_end == __oe_get_heap_end());
+
+    /* The at-exit entry comes from the allocator rather than from oe_sbrk(),
+     * which would hand out the start of the heap the allocator manages */
+    if (!_atexit_registered)
+    {
+        OE_TEST(atexit(_atexit_handler) == 0);
+        OE_TEST(test_allocator_stats.malloc_calls == malloc_calls + 1);
+        _atexit_registered = true;
+    }
+
+    OE_TEST((ptr = malloc(100)));
+    _check_in_heap(ptr, 100);
+    memset(ptr, 0xAB, 100);
+
+    OE_TEST((ptr = realloc(ptr, 5000)));
+    _check_in_heap(ptr, 5000);
+    for (size_t i = 0; i < 100; i++)
+        OE_TEST(ptr[i] == 0xAB);
+    free(ptr);
+
+    OE_TEST((ptr = calloc(16, 64)));
+    _check_in_heap(ptr, 16 * 64);
+    for (size_t i = 0; i < 16 * 64; i++)
+        OE_TEST(ptr[i] == 0);
+    free(ptr);
+
+    OE_TEST((ptr = memalign(4096, 64)));
+    _check_in_heap(ptr, 64);
+    OE_TEST((uintptr_t)ptr % 4096 == 0);
+    free(ptr);
+
+    OE_TEST(posix_memalign(&aligned, 256, 1000) == 0);
+    _check_in_heap(aligned, 1000);
+    OE_TEST((uintptr_t)aligned % 256 == 0);
+    free(aligned);
+
+    OE_TEST(posix_memalign(&aligned, 24, 1000) != 0);
+
+    /* Every call above reached the replacement allocator */
+    OE_TEST(test_allocator_stats.malloc_calls - malloc_calls >= 5);
+    OE_TEST(test_allocator_stats.free_calls - free_calls >= 5);
+
+    /* The heap statistics describe the built-in allocator */
+    OE_TEST(oe_get_heap_stats(&stats) == OE_UNSUPPORTED);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    1024, /* StackPageCount */
+    2);   /* TCSCount */
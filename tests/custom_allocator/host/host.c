@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "custom_allocator_u.h"
+
+static bool _atexit_called;
+
+void host_atexit_called(void)
+{
+    _atexit_called = true;
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    oe_result_t result;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if ((result = oe_create_custom_allocator_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    /* Twice, to check that the allocator is initialized only once */
+    OE_TEST(enc_test_allocator(enclave) == OE_OK);
+    OE_TEST(enc_test_allocator(enclave) == OE_OK);
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    /* The handler registered by the enclave ran */
+    OE_TEST(_atexit_called);
+
+    printf("=== passed all tests (custom_allocator)\n");
+
+    return 0;
+}
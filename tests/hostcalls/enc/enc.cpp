@@ -3,6 +3,7 @@
 
 #include <openenclave/corelibc/string.h>
 #include <openenclave/enclave.h>
+#include <openenclave/internal/hostheap.h>
 #include <openenclave/internal/tests.h>
 #include "hostcalls_t.h"
 
@@ -71,6 +72,76 @@ void test_host_free(void_ptr in_ptr)
     oe_host_free(in_ptr);
 }
 
+#define NUM_SMALL_BLOCKS 1024
+
+static bool _check_block(const void* ptr, size_t size, uint8_t value)
+{
+    const uint8_t* p = (const uint8_t*)ptr;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        if (p[i] != value)
+            return false;
+    }
+
+    return true;
+}
+
+void test_host_small_malloc(void)
+{
+    static void* blocks[NUM_SMALL_BLOCKS];
+
+    /* Sizes from 1 byte to 4 KB cover every size class as well as requests
+     * that go to oe_host_malloc(). Enough blocks are taken to move blocks
+     * between the thread cache and the central lists and to use several
+     * spans per size class. */
+    for (size_t i = 0; i < NUM_SMALL_BLOCKS; i++)
+    {
+        const size_t size = (size_t)1 << (i % 13);
+
+        blocks[i] = oe_host_small_malloc(size);
+        OE_TEST(blocks[i] != NULL);
+        OE_TEST(oe_is_outside_enclave(blocks[i], size));
+        memset(blocks[i], (uint8_t)i, size);
+    }
+
+    /* Blocks must not overlap */
+    for (size_t i = 0; i < NUM_SMALL_BLOCKS; i++)
+        OE_TEST(_check_block(blocks[i], (size_t)1 << (i % 13), (uint8_t)i));
+
+    /* Free every other block and take the blocks again */
+    for (size_t i = 0; i < NUM_SMALL_BLOCKS; i += 2)
+        oe_host_small_free(blocks[i]);
+
+    for (size_t i = 0; i < NUM_SMALL_BLOCKS; i += 2)
+    {
+        const size_t size = (size_t)1 << (i % 13);
+
+        blocks[i] = oe_host_small_malloc(size);
+        OE_TEST(blocks[i] != NULL);
+        memset(blocks[i], (uint8_t)~i, size);
+    }
+
+    for (size_t i = 0; i < NUM_SMALL_BLOCKS; i++)
+    {
+        const uint8_t value = (i % 2) ? (uint8_t)i : (uint8_t)~i;
+
+        OE_TEST(_check_block(blocks[i], (size_t)1 << (i % 13), value));
+    }
+
+    for (size_t i = 0; i < NUM_SMALL_BLOCKS; i++)
+        oe_host_small_free(blocks[i]);
+
+    /* A freed block is reused for the next request of its size class */
+    void* ptr = oe_host_small_malloc(24);
+    OE_TEST(ptr != NULL);
+    oe_host_small_free(ptr);
+    OE_TEST(oe_host_small_malloc(32) == ptr);
+    oe_host_small_free(ptr);
+
+    oe_host_small_free(NULL);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
@@ -181,6 +181,11 @@ static void _test_host_strndup(oe_enclave_t* enclave)
     OE_TEST(test_host_free(enclave, out_str) == OE_OK);
 }
 
+static void _test_host_small_malloc(oe_enclave_t* enclave)
+{
+    OE_TEST(test_host_small_malloc(enclave) == OE_OK);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -202,6 +207,7 @@ int main(int argc, const char* argv[])
     _test_host_calloc(enclave);
     _test_host_realloc(enclave);
     _test_host_strndup(enclave);
+    _test_host_small_malloc(enclave);
 
     oe_terminate_enclave(enclave);
 
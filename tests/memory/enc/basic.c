@@ -168,3 +168,94 @@ void test_posix_memalign(void)
     /* Should fail if alignment isn't possible. */
     OE_TEST(posix_memalign(&ptr, max, 64) != 0);
 }
+
+static void _check_heap_stats(const oe_heap_stats_t* stats)
+{
+    uint64_t num_free_chunks = 0;
+
+    OE_TEST(stats->heap_size == __oe_get_heap_size());
+    OE_TEST(stats->sbrk_bytes <= stats->peak_sbrk_bytes);
+    OE_TEST(stats->peak_sbrk_bytes <= stats->heap_size);
+    OE_TEST(stats->system_bytes <= stats->peak_system_bytes);
+    OE_TEST(stats->system_bytes <= stats->sbrk_bytes);
+    OE_TEST(stats->in_use_bytes + stats->free_bytes == stats->system_bytes);
+    OE_TEST(stats->top_chunk_bytes <= stats->free_bytes);
+
+    for (size_t i = 0; i < OE_HEAP_STATS_NUM_BUCKETS; i++)
+        num_free_chunks += stats->free_chunk_histogram[i];
+
+    OE_TEST(num_free_chunks == stats->num_free_chunks);
+}
+
+void test_heap_stats(void)
+{
+    /* Larger than the blocks kept in per-thread caches, if enabled */
+    const size_t block_size = 4096;
+    void* blocks[64];
+    oe_heap_stats_t before;
+    oe_heap_stats_t after_malloc;
+    oe_heap_stats_t after_free;
+
+    OE_TEST(oe_get_heap_stats(NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_get_heap_stats(&before) == OE_OK);
+    _check_heap_stats(&before);
+
+    for (size_t i = 0; i < OE_COUNTOF(blocks); i++)
+        OE_TEST((blocks[i] = malloc(block_size)) != NULL);
+
+    OE_TEST(oe_get_heap_stats(&after_malloc) == OE_OK);
+    _check_heap_stats(&after_malloc);
+    OE_TEST(
+        after_malloc.in_use_bytes >=
+        before.in_use_bytes + OE_COUNTOF(blocks) * block_size);
+    OE_TEST(after_malloc.peak_sbrk_bytes >= before.peak_sbrk_bytes);
+
+    /* Free every other block to fragment the heap */
+    for (size_t i = 0; i < OE_COUNTOF(blocks); i += 2)
+        free(blocks[i]);
+
+    OE_TEST(oe_get_heap_stats(&after_free) == OE_OK);
+    _check_heap_stats(&after_free);
+    OE_TEST(after_free.in_use_bytes < after_malloc.in_use_bytes);
+    OE_TEST(after_free.num_free_chunks > 0);
+    OE_TEST(after_free.largest_free_chunk_bytes >= block_size);
+
+    for (size_t i = 1; i < OE_COUNTOF(blocks); i += 2)
+        free(blocks[i]);
+}
+
+#define NUM_PROFILED_BLOCKS 256
+
+static void* _profiled_blocks[NUM_PROFILED_BLOCKS];
+
+/* Start profiling and keep half of a series of allocations alive. Returns
+ * OE_UNSUPPORTED if the profiler is not built in. */
+oe_result_t start_heap_profile_test(void)
+{
+    oe_result_t result;
+
+    OE_TEST(oe_start_heap_profiling(0) != OE_OK);
+
+    if ((result = oe_start_heap_profiling(1024)) != OE_OK)
+        return result;
+
+    for (size_t i = 0; i < NUM_PROFILED_BLOCKS; i++)
+    {
+        OE_TEST((_profiled_blocks[i] = malloc(1024)) != NULL);
+
+        if (i % 2)
+        {
+            free(_profiled_blocks[i]);
+            _profiled_blocks[i] = NULL;
+        }
+    }
+
+    OE_TEST(oe_stop_heap_profiling() == OE_OK);
+    return OE_OK;
+}
+
+void stop_heap_profile_test(void)
+{
+    for (size_t i = 0; i < NUM_PROFILED_BLOCKS; i++)
+        free(_profiled_blocks[i]);
+}
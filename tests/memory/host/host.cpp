@@ -2,10 +2,12 @@
 // Licensed under the MIT License.
 
 #include <cstdio>
+#include <cstring>
 #include <thread>
 #include <vector>
 
 #include <openenclave/host.h>
+#include <openenclave/internal/defs.h>
 #include <openenclave/internal/error.h>
 #include <openenclave/internal/globals.h>
 #include <openenclave/internal/tests.h>
@@ -24,6 +26,70 @@ static void _malloc_basic_test(oe_enclave_t* enclave)
     OE_TEST(test_posix_memalign(enclave) == OE_OK);
 }
 
+static void _heap_stats_test(oe_enclave_t* enclave)
+{
+    oe_heap_stats_t stats;
+
+    OE_TEST(test_heap_stats(enclave) == OE_OK);
+
+    OE_TEST(oe_get_enclave_heap_stats(enclave, NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_get_enclave_heap_stats(enclave, &stats) == OE_OK);
+
+    /* Matches the HeapPageCount of the enclave */
+    OE_TEST(stats.heap_size == 131072 * OE_PAGE_SIZE);
+    OE_TEST(stats.peak_sbrk_bytes > 0);
+    OE_TEST(stats.peak_sbrk_bytes <= stats.heap_size);
+    OE_TEST(stats.in_use_bytes + stats.free_bytes == stats.system_bytes);
+
+    printf(
+        "heap: %llu of %llu bytes used at peak, %llu free chunks\n",
+        (unsigned long long)stats.peak_sbrk_bytes,
+        (unsigned long long)stats.heap_size,
+        (unsigned long long)stats.num_free_chunks);
+}
+
+static void _heap_profile_test(oe_enclave_t* enclave)
+{
+    const char* path = "memory_heap.prof";
+    oe_result_t result;
+    char line[256];
+    bool found_mapping = false;
+    size_t sampled_bytes = 0;
+    FILE* file;
+
+    OE_TEST(start_heap_profile_test(enclave, &result) == OE_OK);
+
+    if (result == OE_UNSUPPORTED)
+    {
+        /* The profiler is not built in */
+        OE_TEST(
+            oe_write_enclave_heap_profile(enclave, path) == OE_UNSUPPORTED);
+        return;
+    }
+
+    OE_TEST(result == OE_OK);
+    OE_TEST(oe_write_enclave_heap_profile(enclave, NULL) != OE_OK);
+    OE_TEST(oe_write_enclave_heap_profile(enclave, path) == OE_OK);
+    OE_TEST(stop_heap_profile_test(enclave) == OE_OK);
+
+    OE_TEST((file = fopen(path, "r")) != NULL);
+
+    /* About 128 KB were allocated and kept, in 1 KB blocks */
+    OE_TEST(fgets(line, sizeof(line), file) != NULL);
+    OE_TEST(sscanf(line, "heap profile: %*u: %zu", &sampled_bytes) == 1);
+    OE_TEST(sampled_bytes > 0);
+
+    while (fgets(line, sizeof(line), file))
+    {
+        if (strcmp(line, "MAPPED_LIBRARIES:\n") == 0)
+            found_mapping = true;
+    }
+
+    OE_TEST(found_mapping);
+    fclose(file);
+    remove(path);
+}
+
 static void _malloc_stress_test_single_thread(
     oe_enclave_t* enclave,
     int thread_num)
@@ -136,6 +202,12 @@ int main(int argc, const char* argv[])
     printf("===Starting basic malloc test.\n");
     _malloc_basic_test(enclave);
 
+    printf("===Starting heap statistics test.\n");
+    _heap_stats_test(enclave);
+
+    printf("===Starting heap profile test.\n");
+    _heap_profile_test(enclave);
+
     printf("===Starting malloc stress test.\n");
     _malloc_stress_test(enclave);
 
@@ -0,0 +1,99 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/corelibc/string.h>
+#include <openenclave/edger8r/enclave.h>
+#include <openenclave/enclave.h>
+#include <openenclave/internal/tests.h>
+#include "ocall_batch_t.h"
+
+/* The marshaled arguments of host_accumulate(), padded as edger8r does */
+#define ARGS_SIZE                                                          \
+    ((sizeof(host_accumulate_args_t) + OE_EDGER8R_BUFFER_ALIGNMENT - 1) / \
+     OE_EDGER8R_BUFFER_ALIGNMENT * OE_EDGER8R_BUFFER_ALIGNMENT)
+
+int enc_run_batch(size_t num_calls)
+{
+    oe_ocall_batch_t batch;
+    uint8_t* buffers[OE_OCALL_BATCH_MAX_CALLS] = {0};
+    const size_t bad_call = num_calls / 2;
+
+    OE_TEST(num_calls <= OE_OCALL_BATCH_MAX_CALLS);
+    OE_TEST(oe_ocall_batch_begin(&batch) == OE_OK);
+
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        host_accumulate_args_t* args;
+        size_t function_id = ocall_batch_fcn_id_host_accumulate;
+
+        /* Input and output halves, as laid out by the generated wrappers */
+        OE_TEST((buffers[i] = oe_allocate_ocall_buffer(2 * ARGS_SIZE)));
+        memset(buffers[i], 0, 2 * ARGS_SIZE);
+
+        args = (host_accumulate_args_t*)buffers[i];
+        args->value = i + 1;
+
+        /* One call targets a function that does not exist */
+        if (i == bad_call)
+            function_id = ocall_batch_fcn_id_host_accumulate + 1000;
+
+        OE_TEST(
+            oe_ocall_batch_add(
+                &batch,
+                function_id,
+                buffers[i],
+                ARGS_SIZE,
+                buffers[i] + ARGS_SIZE,
+                ARGS_SIZE) == OE_OK);
+    }
+
+    if (num_calls == OE_OCALL_BATCH_MAX_CALLS)
+    {
+        OE_TEST(
+            oe_ocall_batch_add(
+                &batch,
+                ocall_batch_fcn_id_host_accumulate,
+                buffers[0],
+                ARGS_SIZE,
+                buffers[0] + ARGS_SIZE,
+                ARGS_SIZE) == OE_OUT_OF_BOUNDS);
+    }
+
+    OE_TEST(oe_ocall_batch_submit(&batch) == OE_OK);
+    OE_TEST(batch.num_calls == num_calls);
+
+    /* A failed call must not prevent the others from running */
+    for (size_t i = 0; i < num_calls; i++)
+    {
+        host_accumulate_args_t* out =
+            (host_accumulate_args_t*)(buffers[i] + ARGS_SIZE);
+
+        if (i == bad_call)
+        {
+            OE_TEST(batch.calls[i].result == OE_NOT_FOUND);
+            OE_TEST(batch.calls[i].output_bytes_written == 0);
+        }
+        else
+        {
+            OE_TEST(batch.calls[i].result == OE_OK);
+            OE_TEST(batch.calls[i].output_bytes_written == ARGS_SIZE);
+            OE_TEST(out->_result == OE_OK);
+        }
+
+        oe_free_ocall_buffer(buffers[i]);
+    }
+
+    /* An empty batch does not leave the enclave */
+    OE_TEST(oe_ocall_batch_begin(&batch) == OE_OK);
+    OE_TEST(oe_ocall_batch_submit(&batch) == OE_OK);
+
+    return 0;
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    1024, /* StackPageCount */
+    1);   /* TCSCount */
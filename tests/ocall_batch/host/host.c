@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "ocall_batch_u.h"
+
+/* OE_OCALL_BATCH_MAX_CALLS, which is only defined for enclaves */
+#define MAX_BATCH_CALLS 16
+
+static uint64_t _total;
+static size_t _num_calls;
+
+void host_accumulate(uint64_t value)
+{
+    _total += value;
+    _num_calls++;
+}
+
+static void _run_batch(oe_enclave_t* enclave, size_t num_calls)
+{
+    const size_t bad_call = num_calls / 2;
+    uint64_t expected = num_calls * (num_calls + 1) / 2 - (bad_call + 1);
+    int ret = -1;
+
+    _total = 0;
+    _num_calls = 0;
+
+    OE_TEST(enc_run_batch(enclave, &ret, num_calls) == OE_OK);
+    OE_TEST(ret == 0);
+
+    /* Every call but the one with the bad function id ran, in one OCALL */
+    OE_TEST(_num_calls == num_calls - 1);
+    OE_TEST(_total == expected);
+}
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    oe_result_t result;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+
+    if ((result = oe_create_ocall_batch_enclave(
+             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    _run_batch(enclave, 1);
+    _run_batch(enclave, 5);
+    _run_batch(enclave, MAX_BATCH_CALLS);
+
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    printf("=== passed all tests (ocall_batch)\n");
+
+    return 0;
+}
@@ -0,0 +1,116 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/enclave.h>
+#include <openenclave/internal/atomic.h>
+#include <openenclave/internal/tests.h>
+#include <string.h>
+#include "parallel_t.h"
+
+#define NUM_ITEMS 100000
+
+static volatile uint64_t _visits[NUM_ITEMS];
+static volatile uint64_t _num_bodies;
+
+static void _visit(size_t begin, size_t end, void* arg)
+{
+    OE_TEST(arg == (void*)_visits);
+    OE_TEST(begin < end && end <= NUM_ITEMS);
+
+    for (size_t i = begin; i < end; i++)
+        oe_atomic_increment(&_visits[i]);
+
+    oe_atomic_increment(&_num_bodies);
+}
+
+static void _test_range(size_t begin, size_t end, size_t grain)
+{
+    memset((void*)_visits, 0, sizeof(_visits));
+    _num_bodies = 0;
+
+    OE_TEST(
+        oe_parallel_for(begin, end, grain, _visit, (void*)_visits) == OE_OK);
+
+    for (size_t i = 0; i < NUM_ITEMS; i++)
+        OE_TEST(_visits[i] == (i >= begin && i < end));
+
+    if (grain && begin < end)
+        OE_TEST(_num_bodies == (end - begin + grain - 1) / grain);
+}
+
+void enc_test_parallel_for(void)
+{
+    _test_range(0, NUM_ITEMS, 0);
+    _test_range(0, NUM_ITEMS, 1000);
+    _test_range(0, NUM_ITEMS, 7);
+    _test_range(10, NUM_ITEMS - 10, 999);
+    _test_range(5, 6, 0);
+    _test_range(0, 100, 1000);
+    _test_range(100, 100, 0);
+
+    OE_TEST(
+        oe_parallel_for(1, 0, 0, _visit, (void*)_visits) ==
+        OE_INVALID_PARAMETER);
+    OE_TEST(oe_parallel_for(0, 1, 0, NULL, NULL) == OE_INVALID_PARAMETER);
+}
+
+/* Naive Fibonacci with one task per call, so that tasks spawn tasks and
+ * threads wait for groups from within tasks */
+typedef struct _fib
+{
+    uint64_t n;
+    uint64_t result;
+} fib_t;
+
+static void _fib_task(void* arg)
+{
+    fib_t* fib = (fib_t*)arg;
+    fib_t a;
+    fib_t b;
+    oe_task_group_t group;
+
+    if (fib->n < 2)
+    {
+        fib->result = fib->n;
+        return;
+    }
+
+    a.n = fib->n - 1;
+    b.n = fib->n - 2;
+
+    OE_TEST(oe_task_group_init(&group) == OE_OK);
+    OE_TEST(oe_task_spawn(&group, _fib_task, &a) == OE_OK);
+    OE_TEST(oe_task_spawn(&group, _fib_task, &b) == OE_OK);
+    OE_TEST(oe_task_group_wait(&group) == OE_OK);
+
+    fib->result = a.result + b.result;
+}
+
+void enc_test_task_groups(void)
+{
+    oe_task_group_t group = OE_TASK_GROUP_INITIALIZER;
+    fib_t fibs[4] = {{10, 0}, {15, 0}, {18, 0}, {20, 0}};
+    const uint64_t expected[4] = {55, 610, 2584, 6765};
+
+    for (size_t i = 0; i < OE_COUNTOF(fibs); i++)
+        OE_TEST(oe_task_spawn(&group, _fib_task, &fibs[i]) == OE_OK);
+
+    OE_TEST(oe_task_group_wait(&group) == OE_OK);
+
+    for (size_t i = 0; i < OE_COUNTOF(fibs); i++)
+        OE_TEST(fibs[i].result == expected[i]);
+
+    /* Waiting for an empty group returns at once */
+    OE_TEST(oe_task_group_wait(&group) == OE_OK);
+
+    OE_TEST(oe_task_spawn(NULL, _fib_task, NULL) == OE_INVALID_PARAMETER);
+    OE_TEST(oe_task_spawn(&group, NULL, NULL) == OE_INVALID_PARAMETER);
+}
+
+OE_SET_ENCLAVE_SGX(
+    1,    /* ProductID */
+    1,    /* SecurityVersion */
+    true, /* AllowDebug */
+    1024, /* HeapPageCount */
+    64,   /* StackPageCount */
+    5);   /* TCSCount (4 parallel workers + 1 caller) */
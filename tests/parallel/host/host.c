@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <openenclave/host.h>
+#include <openenclave/internal/error.h>
+#include <openenclave/internal/tests.h>
+#include <stdio.h>
+#include "parallel_u.h"
+
+#define NUM_PARALLEL_WORKERS 4
+
+int main(int argc, const char* argv[])
+{
+    oe_enclave_t* enclave = NULL;
+    oe_result_t result;
+
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s ENCLAVE_PATH\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t flags = oe_get_create_flags();
+    oe_enclave_config_t config = {0};
+
+    /* All the TCSs except the one used by the ECALLs below */
+    config.num_parallel_workers = NUM_PARALLEL_WORKERS;
+
+    if ((result = oe_create_parallel_enclave(
+             argv[1],
+             OE_ENCLAVE_TYPE_SGX,
+             flags,
+             &config,
+             sizeof(config),
+             &enclave)) != OE_OK)
+        oe_put_err("oe_create_enclave(): result=%u", result);
+
+    OE_TEST(enc_test_parallel_for(enclave) == OE_OK);
+    OE_TEST(enc_test_task_groups(enclave) == OE_OK);
+
+    /* Stopping the workers must release their TCSs */
+    result = oe_terminate_enclave(enclave);
+    OE_TEST(result == OE_OK);
+
+    printf("=== passed all tests (parallel)\n");
+
+    return 0;
+}
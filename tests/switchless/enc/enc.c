@@ -60,10 +60,30 @@ int enc_echo(char* in, char out[100])
     return 0;
 }
 
+int enc_echo_switchless(char* in, char out[100])
+{
+    int n = 0;
+
+    if (oe_strcmp(in, "Hello World") != 0)
+    {
+        return -1;
+    }
+
+    /* Switchless OCALL made from a switchless ECALL */
+    if (host_increment_switchless(&n, 1) != OE_OK || n != 2)
+    {
+        return -1;
+    }
+
+    oe_strlcpy(out, in, 100);
+
+    return 0;
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
     true, /* AllowDebug */
     1024, /* HeapPageCount */
     1024, /* StackPageCount */
-    16);  /* TCSCount */
+    18);  /* TCSCount (16 host threads + 2 switchless workers) */
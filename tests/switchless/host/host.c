@@ -13,6 +13,9 @@
 #include "switchless_u.h"
 
 #define NUM_HOST_THREADS 16
+#define NUM_ENCLAVE_WORKERS 2
+#define NUM_HOST_WORKERS 2
+#define NUM_SWITCHLESS_ECALLS 1000
 
 int host_echo(char* in, char* out, char* str1, char* str2, char str3[100])
 {
@@ -25,6 +28,11 @@ int host_echo(char* in, char* out, char* str1, char* str2, char str3[100])
     return 0;
 }
 
+int host_increment_switchless(int n)
+{
+    return n + 1;
+}
+
 void* host_thread(void* arg)
 {
     char out[100];
@@ -42,9 +50,80 @@ void* host_thread(void* arg)
     if (strcmp("Hello World", out) != 0)
         oe_put_err("ecall failed: %s != %s\n", "Hello World", out);
 
+    for (int i = 0; i < NUM_SWITCHLESS_ECALLS; i++)
+    {
+        memset(out, 0, sizeof(out));
+
+        result = enc_echo_switchless(enclave, &return_val, "Hello World", out);
+
+        if (result != OE_OK)
+            oe_put_err("enc_echo_switchless() failed: result=%u", result);
+
+        if (return_val != 0)
+            oe_put_err("switchless ECALL failed args.result=%d", return_val);
+
+        if (strcmp("Hello World", out) != 0)
+            oe_put_err(
+                "switchless ecall failed: %s != %s\n", "Hello World", out);
+    }
+
     return NULL;
 }
 
+static void _check_call_statistics(oe_enclave_t* enclave)
+{
+    oe_call_statistics_t statistics[64];
+    size_t count = 0;
+    bool found_ecall = false;
+    bool found_ocall = false;
+
+    /* Asking for the count only reports the number of entries needed */
+    OE_TEST(
+        oe_get_call_statistics(enclave, NULL, &count) == OE_BUFFER_TOO_SMALL);
+    OE_TEST(count > 0 && count <= OE_COUNTOF(statistics));
+
+    OE_TEST(oe_get_call_statistics(enclave, statistics, &count) == OE_OK);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const oe_call_statistics_t* s = &statistics[i];
+        uint64_t histogram_total = 0;
+
+        for (size_t j = 0; j < OE_CALL_STATISTICS_NUM_BUCKETS; j++)
+            histogram_total += s->latency_histogram[j];
+
+        OE_TEST(histogram_total == s->num_calls);
+
+        if (s->table_id != OE_UINT64_MAX)
+            continue;
+
+        /* Every switchless ECALL makes one switchless OCALL */
+        if (s->kind == OE_CALL_KIND_ECALL &&
+            s->function_id == switchless_fcn_id_enc_echo_switchless)
+        {
+            OE_TEST(s->num_calls == NUM_HOST_THREADS * NUM_SWITCHLESS_ECALLS);
+            OE_TEST(s->num_failures == 0);
+            OE_TEST(s->bytes_in > 0 && s->bytes_out > 0);
+            found_ecall = true;
+        }
+
+        if (s->kind == OE_CALL_KIND_OCALL &&
+            s->function_id == switchless_fcn_id_host_increment_switchless)
+        {
+            OE_TEST(s->num_calls == NUM_HOST_THREADS * NUM_SWITCHLESS_ECALLS);
+            found_ocall = true;
+        }
+    }
+
+    OE_TEST(found_ecall && found_ocall);
+
+    OE_TEST(oe_reset_call_statistics(enclave) == OE_OK);
+    OE_TEST(oe_get_call_statistics(enclave, statistics, &count) == OE_OK);
+
+    for (size_t i = 0; i < count; i++)
+        OE_TEST(statistics[i].num_calls == 0);
+}
+
 int main(int argc, const char* argv[])
 {
     oe_enclave_t* enclave = NULL;
@@ -57,9 +136,19 @@ int main(int argc, const char* argv[])
     }
 
     const uint32_t flags = oe_get_create_flags();
+    oe_enclave_config_t config = {0};
+
+    config.max_enclave_workers = NUM_ENCLAVE_WORKERS;
+    config.max_host_workers = NUM_HOST_WORKERS;
+    config.collect_call_statistics = true;
 
     if ((result = oe_create_switchless_enclave(
-             argv[1], OE_ENCLAVE_TYPE_SGX, flags, NULL, 0, &enclave)) != OE_OK)
+             argv[1],
+             OE_ENCLAVE_TYPE_SGX,
+             flags,
+             &config,
+             sizeof(config),
+             &enclave)) != OE_OK)
         oe_put_err("oe_create_enclave(): result=%u", result);
 
     pthread_t threads[NUM_HOST_THREADS];
@@ -79,6 +168,8 @@ int main(int argc, const char* argv[])
         pthread_join(threads[i], NULL);
     }
 
+    _check_call_statistics(enclave);
+
     result = oe_terminate_enclave(enclave);
     OE_TEST(result == OE_OK);
 
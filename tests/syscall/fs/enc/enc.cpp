@@ -6,9 +6,11 @@
 #include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
 #include <openenclave/internal/syscall/device.h>
+#include <openenclave/internal/syscall/sys/sendfile.h>
 #include <openenclave/internal/syscall/unistd.h>
 #include <openenclave/internal/tests.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/mount.h>
 #include <set>
@@ -485,6 +487,332 @@ void test_zero_sized_iovs(void)
     OE_TEST(oe_readv(OE_STDIN_FILENO, &iov, 0) == 0);
 }
 
+static void test_positional_io(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    char buf[OE_PAGE_SIZE];
+    char lo[4];
+    char hi[4];
+    struct oe_iovec iov[2];
+    int fd;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    mkpath(path, tmp_dir, "positional");
+    fd = oe_open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(fd >= 0);
+
+    /* Write the alphabet backwards, one character at a time. */
+    for (size_t i = sizeof(ALPHABET); i-- > 0;)
+        OE_TEST(oe_pwrite(fd, &ALPHABET[i], 1, (oe_off_t)i) == 1);
+
+    /* The file offset was not moved. */
+    OE_TEST(oe_lseek(fd, 0, OE_SEEK_CUR) == 0);
+
+    /* Read "lmnop" */
+    OE_TEST(oe_pread(fd, buf, 5, 11) == 5);
+    OE_TEST(memcmp(buf, "lmnop", 5) == 0);
+
+    /* Read past the end of the file. */
+    OE_TEST(oe_pread(fd, buf, sizeof(buf), sizeof(ALPHABET)) == 0);
+
+    /* Overwrite "wxyz" with "WXYZ" from two buffers. */
+    memcpy(lo, "WX", 2);
+    memcpy(hi, "YZ", 2);
+    iov[0].iov_base = lo;
+    iov[0].iov_len = 2;
+    iov[1].iov_base = hi;
+    iov[1].iov_len = 2;
+    OE_TEST(oe_pwritev(fd, iov, 2, 22) == 4);
+
+    /* Read "vWXY" back into two buffers. */
+    memset(lo, 0, sizeof(lo));
+    memset(hi, 0, sizeof(hi));
+    iov[0].iov_len = 1;
+    iov[1].iov_len = 3;
+    OE_TEST(oe_preadv(fd, iov, 2, 21) == 4);
+    OE_TEST(memcmp(lo, "v", 1) == 0);
+    OE_TEST(memcmp(hi, "WXY", 3) == 0);
+
+    OE_TEST(oe_lseek(fd, 0, OE_SEEK_CUR) == 0);
+
+    /* A negative offset is rejected. */
+    OE_TEST(oe_pread(fd, buf, 1, -1) == -1);
+    OE_TEST(oe_errno == OE_EINVAL);
+
+    OE_TEST(oe_close(fd) == 0);
+
+    /* The standard streams cannot seek. */
+    OE_TEST(oe_pwrite(OE_STDOUT_FILENO, buf, 1, 0) == -1);
+    OE_TEST(oe_errno == OE_ESPIPE);
+
+    OE_TEST(umount("/") == 0);
+}
+
+static void test_cached_io(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    char buf[OE_PAGE_SIZE];
+    int fd;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    /* Only the cache size may be passed to hostfs. */
+    OE_TEST(
+        mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, "bogus") == -1);
+    OE_TEST(oe_errno == OE_EINVAL);
+
+    /* A small cache, so that writes and reads go past its end. */
+    OE_TEST(
+        mount(
+            "/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, "cache_size=16") ==
+        0);
+
+    mkpath(path, tmp_dir, "cached");
+    fd = oe_open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(fd >= 0);
+
+    /* Coalesced writes are visible to positional reads. */
+    for (size_t i = 0; i < sizeof(ALPHABET); i++)
+        OE_TEST(oe_write(fd, &ALPHABET[i], 1) == 1);
+
+    OE_TEST(oe_pread(fd, buf, sizeof(buf), 0) == sizeof(ALPHABET));
+    OE_TEST(memcmp(buf, ALPHABET, sizeof(ALPHABET)) == 0);
+
+    /* Seeking gives back the data read ahead. */
+    OE_TEST(oe_lseek(fd, 0, OE_SEEK_SET) == 0);
+    OE_TEST(oe_read(fd, buf, 5) == 5);
+    OE_TEST(memcmp(buf, "abcde", 5) == 0);
+    OE_TEST(oe_read(fd, buf, 5) == 5);
+    OE_TEST(memcmp(buf, "fghij", 5) == 0);
+    OE_TEST(oe_lseek(fd, 0, OE_SEEK_CUR) == 10);
+
+    /* Writing after a read writes at the offset of the caller. */
+    OE_TEST(oe_read(fd, buf, 1) == 1);
+    OE_TEST(oe_write(fd, "LMN", 3) == 3);
+    OE_TEST(oe_read(fd, buf, 2) == 2);
+    OE_TEST(memcmp(buf, "op", 2) == 0);
+
+    OE_TEST(oe_lseek(fd, 0, OE_SEEK_SET) == 0);
+    OE_TEST(oe_read(fd, buf, sizeof(buf)) == sizeof(ALPHABET));
+    OE_TEST(memcmp(buf, "abcdefghijkLMNopqrstuvwxyz", 26) == 0);
+
+    OE_TEST(oe_fsync(fd) == 0);
+    OE_TEST(oe_close(fd) == 0);
+
+    OE_TEST(umount("/") == 0);
+}
+
+/* List a directory with more entries than hostfs reads from the host at
+ * once, through both readdir() and a large getdents64() buffer. */
+static void test_readdir_batches(const char* tmp_dir)
+{
+    const size_t num_files = 100;
+    char dir[OE_PATH_MAX];
+    char path[OE_PATH_MAX];
+    char name[16];
+    set<string> names;
+    OE_DIR* d;
+    struct oe_dirent* ent;
+    struct oe_dirent* ents;
+    int fd;
+    int n;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    OE_TEST(mount("/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, NULL) == 0);
+
+    mkpath(dir, tmp_dir, "batches");
+    OE_TEST(oe_mkdir(dir, 0777) == 0);
+
+    for (size_t i = 0; i < num_files; i++)
+    {
+        snprintf(name, sizeof(name), "%zu", i);
+        fd = oe_open(mkpath(path, dir, name), OE_O_CREAT | OE_O_WRONLY, MODE);
+        OE_TEST(fd >= 0);
+        OE_TEST(oe_close(fd) == 0);
+    }
+
+    /* One entry at a time, twice. */
+    OE_TEST((d = oe_opendir(dir)) != NULL);
+
+    for (size_t pass = 0; pass < 2; pass++)
+    {
+        names.clear();
+
+        while ((ent = oe_readdir(d)))
+            names.insert(ent->d_name);
+
+        OE_TEST(names.size() == num_files + 2);
+        OE_TEST(names.count("0") && names.count("99"));
+
+        oe_rewinddir(d);
+    }
+
+    OE_TEST(oe_closedir(d) == 0);
+
+    /* Many entries at a time. */
+    OE_TEST((ents = (struct oe_dirent*)malloc(64 * sizeof(*ents))) != NULL);
+    fd = oe_open(dir, OE_O_RDONLY | OE_O_DIRECTORY, 0);
+    OE_TEST(fd >= 0);
+    names.clear();
+
+    while ((n = oe_getdents64((unsigned int)fd, ents, 64 * sizeof(*ents))) > 0)
+    {
+        for (size_t i = 0; i < (size_t)n / sizeof(*ents); i++)
+            names.insert(ents[i].d_name);
+    }
+
+    OE_TEST(n == 0);
+    OE_TEST(names.size() == num_files + 2);
+    OE_TEST(oe_close(fd) == 0);
+    free(ents);
+
+    for (size_t i = 0; i < num_files; i++)
+    {
+        snprintf(name, sizeof(name), "%zu", i);
+        OE_TEST(oe_unlink(mkpath(path, dir, name)) == 0);
+    }
+
+    OE_TEST(oe_rmdir(dir) == 0);
+    OE_TEST(umount("/") == 0);
+}
+
+static void test_sendfile_between(int out, int in)
+{
+    char buf[OE_PAGE_SIZE];
+    oe_off_t offset = 3;
+
+    /* At an offset, which is advanced instead of the file offset. */
+    OE_TEST(oe_sendfile(out, in, &offset, 5) == 5);
+    OE_TEST(offset == 8);
+    OE_TEST(oe_lseek(in, 0, OE_SEEK_CUR) == 0);
+
+    /* At the file offset, stopping at the end of the file. */
+    OE_TEST(oe_sendfile(out, in, NULL, sizeof(buf)) == sizeof(ALPHABET));
+    OE_TEST(oe_lseek(in, 0, OE_SEEK_CUR) == sizeof(ALPHABET));
+    OE_TEST(oe_sendfile(out, in, NULL, sizeof(buf)) == 0);
+
+    OE_TEST(oe_pread(out, buf, sizeof(buf), 0) == 5 + sizeof(ALPHABET));
+    OE_TEST(memcmp(buf, "defgh", 5) == 0);
+    OE_TEST(memcmp(buf + 5, ALPHABET, sizeof(ALPHABET)) == 0);
+}
+
+static void test_sendfile(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    int in;
+    int out;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    /* Between hostfs files, the data is copied on the host; the data
+     * written through the cache must reach the host first. */
+    OE_TEST(
+        mount(
+            "/", "/", OE_DEVICE_NAME_HOST_FILE_SYSTEM, 0, "cache_size=16") ==
+        0);
+
+    mkpath(path, tmp_dir, "sendfile.in");
+    in = oe_open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(in >= 0);
+    mkpath(path, tmp_dir, "sendfile.out");
+    out = oe_open(path, OE_O_CREAT | OE_O_TRUNC | OE_O_RDWR, MODE);
+    OE_TEST(out >= 0);
+
+    for (size_t i = 0; i < sizeof(ALPHABET); i++)
+        OE_TEST(oe_write(in, &ALPHABET[i], 1) == 1);
+
+    OE_TEST(oe_lseek(in, 0, OE_SEEK_SET) == 0);
+    test_sendfile_between(out, in);
+
+    OE_TEST(oe_close(in) == 0);
+    OE_TEST(oe_close(out) == 0);
+    OE_TEST(umount("/") == 0);
+
+    /* ramfs files have no host descriptor, so the data is copied through
+     * the enclave. */
+    mount_ram_file_system(tmp_dir);
+
+    mkpath(path, tmp_dir, "sendfile.in");
+    in = oe_open(path, OE_O_CREAT | OE_O_RDWR, MODE);
+    OE_TEST(in >= 0);
+    mkpath(path, tmp_dir, "sendfile.out");
+    out = oe_open(path, OE_O_CREAT | OE_O_RDWR, MODE);
+    OE_TEST(out >= 0);
+
+    OE_TEST(oe_pwrite(in, ALPHABET, sizeof(ALPHABET), 0) == sizeof(ALPHABET));
+    test_sendfile_between(out, in);
+
+    OE_TEST(oe_close(in) == 0);
+    OE_TEST(oe_close(out) == 0);
+    OE_TEST(umount("/") == 0);
+}
+
+static void test_ram_file_system(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+    char dir[OE_PATH_MAX];
+    char subdir[OE_PATH_MAX];
+    char buf[OE_PAGE_SIZE];
+    int fd;
+    int fd2;
+
+    printf("--- %s()\n", __FUNCTION__);
+
+    /* ramfs takes no mount data. */
+    OE_TEST(mount(NULL, "/", OE_DEVICE_NAME_RAM_FILE_SYSTEM, 0, "x") == -1);
+    OE_TEST(oe_errno == OE_EINVAL);
+
+    mount_ram_file_system(tmp_dir);
+
+    mkpath(path, tmp_dir, "ram");
+    fd = oe_open(path, OE_O_CREAT | OE_O_EXCL | OE_O_RDWR, MODE);
+    OE_TEST(fd >= 0);
+
+    /* Writing past the end of the file leaves a hole of zeros. */
+    OE_TEST(oe_pwrite(fd, "z", 1, 3) == 1);
+    OE_TEST(oe_read(fd, buf, sizeof(buf)) == 4);
+    OE_TEST(memcmp(buf, "\0\0\0z", 4) == 0);
+
+    /* Duplicates share the file offset. */
+    fd2 = oe_dup(fd);
+    OE_TEST(fd2 >= 0);
+    OE_TEST(oe_lseek(fd2, 1, OE_SEEK_SET) == 1);
+    OE_TEST(oe_lseek(fd, 0, OE_SEEK_CUR) == 1);
+    OE_TEST(oe_close(fd2) == 0);
+
+    /* Appending writes go to the end of the file. */
+    OE_TEST(oe_fcntl(fd, OE_F_SETFL, (uint64_t)OE_O_APPEND) == 0);
+    OE_TEST(oe_write(fd, "ab", 2) == 2);
+    OE_TEST(oe_pread(fd, buf, sizeof(buf), 0) == 6);
+    OE_TEST(memcmp(buf, "\0\0\0zab", 6) == 0);
+
+    /* Directories are checked like on other file systems. */
+    mkpath(dir, tmp_dir, "dir");
+    mkpath(subdir, dir, "subdir");
+    OE_TEST(oe_mkdir(dir, 0777) == 0);
+    OE_TEST(oe_mkdir(subdir, 0777) == 0);
+    OE_TEST(oe_rmdir(dir) == -1);
+    OE_TEST(oe_errno == OE_ENOTEMPTY);
+    OE_TEST(oe_rename(dir, subdir) == -1);
+    OE_TEST(oe_errno == OE_EINVAL);
+    OE_TEST(oe_unlink(dir) == -1);
+    OE_TEST(oe_errno == OE_EISDIR);
+
+    /* Unmounting releases the files, except those that are still open. */
+    OE_TEST(umount("/") == 0);
+    OE_TEST(oe_pread(fd, buf, sizeof(buf), 0) == 6);
+    OE_TEST(oe_close(fd) == 0);
+
+    mount_ram_file_system(tmp_dir);
+    OE_TEST(oe_access(path, OE_F_OK) == -1);
+    OE_TEST(oe_errno == OE_ENOENT);
+    OE_TEST(umount("/") == 0);
+}
+
 extern "C" void test_dup_case1(const char* tmp_dir)
 {
     FILE* stream;
@@ -546,6 +874,7 @@ void test_fs(const char* src_dir, const char* tmp_dir)
 #if defined(TEST_SGXFS)
     OE_TEST(oe_load_module_sgx_file_system() == OE_OK);
 #endif
+    OE_TEST(oe_load_module_ram_file_system() == OE_OK);
 
     OE_TEST(oe_mkdir_d(OE_DEVID_HOST_FILE_SYSTEM, tmp_dir, 0777) == 0);
 
@@ -607,6 +936,30 @@ void test_fs(const char* src_dir, const char* tmp_dir)
     }
 #endif
 
+    /* Test the RAMFS oe file descriptor interfaces. */
+    {
+        printf("=== testing oe-fd-ramfs:\n");
+
+        oe_fd_ramfs_file_system fs(tmp_dir);
+        test_all(fs, tmp_dir);
+    }
+
+    /* Test the RAMFS standard C descriptor interfaces. */
+    {
+        printf("=== testing fd-ramfs:\n");
+
+        fd_ramfs_file_system fs(tmp_dir);
+        test_all(fs, tmp_dir);
+    }
+
+    /* Test stream I/O ramfs functions. */
+    {
+        printf("=== testing stream I/O ramfs functions:\n");
+
+        stream_ramfs_file_system fs(tmp_dir);
+        test_all(fs, tmp_dir);
+    }
+
     /* Test oe_set_thread_devid() */
     {
         printf("=== testing oe_set_thread_devid:\n");
@@ -659,6 +1012,16 @@ void test_fs(const char* src_dir, const char* tmp_dir)
 
     test_zero_sized_iovs();
 
+    test_positional_io(tmp_dir);
+
+    test_cached_io(tmp_dir);
+
+    test_readdir_batches(tmp_dir);
+
+    test_ram_file_system(tmp_dir);
+
+    test_sendfile(tmp_dir);
+
     /* Note: these must come last since they change STDOUT and STDERR. */
     test_dup_case1(tmp_dir);
     test_dup_case2(tmp_dir);
@@ -512,4 +512,66 @@ class stream_sgxfs_file_system : public stream_file_system
 };
 #endif // TEST_SGXFS
 
+/* Mount an empty RAM file system on the root directory and create the
+ * directories of tmp_dir in it, so that the tests can use the same paths. */
+inline void mount_ram_file_system(const char* tmp_dir)
+{
+    char path[OE_PATH_MAX];
+
+    OE_TEST(oe_mount(NULL, "/", OE_DEVICE_NAME_RAM_FILE_SYSTEM, 0, NULL) == 0);
+
+    for (size_t i = 1; tmp_dir[i - 1]; i++)
+    {
+        if (tmp_dir[i] == '/' || tmp_dir[i] == '\0')
+        {
+            OE_TEST(i < sizeof(path));
+            memcpy(path, tmp_dir, i);
+            path[i] = '\0';
+            OE_TEST(oe_mkdir(path, 0777) == 0 || oe_errno == OE_EEXIST);
+        }
+    }
+}
+
+class oe_fd_ramfs_file_system : public oe_fd_file_system
+{
+  public:
+    oe_fd_ramfs_file_system(const char* tmp_dir)
+    {
+        mount_ram_file_system(tmp_dir);
+    }
+
+    ~oe_fd_ramfs_file_system()
+    {
+        OE_TEST(oe_umount("/") == 0);
+    }
+};
+
+class fd_ramfs_file_system : public fd_file_system
+{
+  public:
+    fd_ramfs_file_system(const char* tmp_dir)
+    {
+        mount_ram_file_system(tmp_dir);
+    }
+
+    ~fd_ramfs_file_system()
+    {
+        OE_TEST(oe_umount("/") == 0);
+    }
+};
+
+class stream_ramfs_file_system : public stream_file_system
+{
+  public:
+    stream_ramfs_file_system(const char* tmp_dir)
+    {
+        mount_ram_file_system(tmp_dir);
+    }
+
+    ~stream_ramfs_file_system()
+    {
+        OE_TEST(oe_umount("/") == 0);
+    }
+};
+
 #endif /* _file_system_h */
@@ -9,9 +9,12 @@
 #include <openenclave/enclave.h>
 #include <openenclave/internal/tests.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/time.h>
 #include <openenclave/internal/types.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <atomic>
 #include "thread_t.h"
 
@@ -301,6 +304,125 @@ size_t enc_tcs_used_thread_count()
     return g_tcs_used_thread_count;
 }
 
+// test_create_thread
+#ifdef _PTHREAD_ENC_
+#define OUT_OF_THREADS EAGAIN
+#else
+#define OUT_OF_THREADS OE_OUT_OF_THREADS
+#endif
+
+static oe_mutex_t create_mutex = OE_MUTEX_INITIALIZER;
+static oe_cond_t create_cond = OE_COND_INITIALIZER;
+static bool create_released = false;
+
+static void* _created_thread(void* arg)
+{
+    oe_mutex_lock(&create_mutex);
+    while (!create_released)
+        oe_cond_wait(&create_cond, &create_mutex);
+    oe_mutex_unlock(&create_mutex);
+
+    return arg;
+}
+
+// Create threads until the TCSs run out, then let them all finish
+void enc_test_create_thread(size_t num_tcs)
+{
+    oe_thread_handle_t threads[64];
+    oe_thread_handle_t extra_thread;
+    size_t num_threads = num_tcs - 1; // This ECALL holds one TCS
+
+    OE_TEST(num_threads <= OE_COUNTOF(threads));
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        OE_TEST(
+            oe_thread_create(&threads[i], _created_thread, (void*)(i + 1)) ==
+            0);
+    }
+
+    OE_TEST(
+        oe_thread_create(&extra_thread, _created_thread, NULL) ==
+        OUT_OF_THREADS);
+
+    oe_mutex_lock(&create_mutex);
+    create_released = true;
+    oe_cond_broadcast(&create_cond);
+    oe_mutex_unlock(&create_mutex);
+
+    for (size_t i = 0; i < num_threads; i++)
+    {
+        void* retval = NULL;
+
+        OE_TEST(oe_thread_join(threads[i], &retval) == 0);
+        OE_TEST(retval == (void*)(i + 1));
+    }
+}
+
+// test_detached_thread
+static void* _detached_thread(void* arg)
+{
+    // Runs until oe_terminate_enclave() tells the enclave to stop
+    while (!oe_is_enclave_terminating())
+        oe_sleep_msec(1);
+
+    return arg;
+}
+
+void enc_start_detached_thread()
+{
+    oe_thread_handle_t thread;
+
+    OE_TEST(!oe_is_enclave_terminating());
+    OE_TEST(oe_thread_create(&thread, _detached_thread, NULL) == 0);
+    OE_TEST(oe_thread_detach(thread) == 0);
+}
+
+// test_cond_timedwait
+#ifdef _PTHREAD_ENC_
+#define TIMEDOUT ETIMEDOUT
+static int _cond_timedwait(oe_cond_t* cond, oe_mutex_t* mutex, uint64_t ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(ns / 1000000000);
+    ts.tv_nsec = (long)(ns % 1000000000);
+
+    return pthread_cond_timedwait(cond, mutex, &ts);
+}
+#else
+#define TIMEDOUT OE_TIMEDOUT
+#define _cond_timedwait oe_cond_timedwait
+#endif
+
+static uint64_t _now_ms()
+{
+    struct timespec ts;
+
+    OE_TEST(clock_gettime(CLOCK_REALTIME, &ts) == 0);
+
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Wait on a condition variable that nobody signals
+void enc_test_cond_timedwait(size_t timeout_ms)
+{
+    oe_mutex_t mutex = OE_MUTEX_INITIALIZER;
+    oe_cond_t cond = OE_COND_INITIALIZER;
+    uint64_t deadline_ms = _now_ms() + timeout_ms;
+
+    oe_mutex_lock(&mutex);
+
+    // A deadline that has passed times out without blocking
+    OE_TEST(_cond_timedwait(&cond, &mutex, 0) == TIMEDOUT);
+
+    OE_TEST(_cond_timedwait(&cond, &mutex, deadline_ms * 1000000) == TIMEDOUT);
+    OE_TEST(_now_ms() >= deadline_ms);
+
+    // The mutex is held again after the timeout
+    OE_TEST(oe_mutex_unlock(&mutex) == 0);
+}
+
 OE_SET_ENCLAVE_SGX(
     1,    /* ProductID */
     1,    /* SecurityVersion */
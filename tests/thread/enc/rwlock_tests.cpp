@@ -7,11 +7,14 @@
 
 #include <openenclave/enclave.h>
 #include <openenclave/internal/print.h>
+#include <openenclave/internal/tests.h>
 #include <openenclave/internal/thread.h>
+#include <openenclave/internal/time.h>
 #include <openenclave/internal/types.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <atomic>
 #include "../rwlock_tests.h"
 #include "thread_t.h"
 
@@ -163,3 +166,48 @@ void enc_rw_results(
     *max_writers = g_max_writers;
     *readers_and_writers = g_readers_and_writers;
 }
+
+// test_recursive_rdlock
+static oe_biased_rwlock_t biased_lock = OE_BIASED_RWLOCK_INITIALIZER;
+static std::atomic<bool> g_writer_waiting(false);
+static std::atomic<bool> g_writer_locked(false);
+
+static void* _pending_writer(void* arg)
+{
+    g_writer_waiting = true;
+    OE_TEST(oe_biased_rwlock_wrlock(&biased_lock) == 0);
+    g_writer_locked = true;
+    OE_TEST(oe_biased_rwlock_unlock(&biased_lock) == 0);
+
+    return arg;
+}
+
+// A reader can read-lock the lock again while a writer waits for it
+void enc_test_recursive_rdlock()
+{
+    oe_thread_handle_t writer;
+
+    // Enough reads for the lock to become biased towards readers
+    for (size_t i = 0; i < 1000; i++)
+    {
+        OE_TEST(oe_biased_rwlock_rdlock(&biased_lock) == 0);
+        OE_TEST(oe_biased_rwlock_unlock(&biased_lock) == 0);
+    }
+
+    OE_TEST(oe_biased_rwlock_rdlock(&biased_lock) == 0);
+    OE_TEST(oe_thread_create(&writer, _pending_writer, NULL) == 0);
+
+    // Give the writer time to revoke the bias and wait for this reader
+    while (!g_writer_waiting)
+        ;
+    oe_sleep_msec(100);
+
+    OE_TEST(oe_biased_rwlock_rdlock(&biased_lock) == 0);
+    OE_TEST(!g_writer_locked);
+    OE_TEST(oe_biased_rwlock_unlock(&biased_lock) == 0);
+    OE_TEST(!g_writer_locked);
+    OE_TEST(oe_biased_rwlock_unlock(&biased_lock) == 0);
+
+    OE_TEST(oe_thread_join(writer, NULL) == 0);
+    OE_TEST(g_writer_locked);
+}
@@ -24,6 +24,12 @@ static __inline pthread_mutex_t __mutex_initializer_recursive()
 typedef pthread_t oe_thread_t;
 #define oe_thread_self pthread_self
 
+typedef pthread_t oe_thread_handle_t;
+#define oe_thread_create(thread, start_routine, arg) \
+    pthread_create(thread, NULL, start_routine, arg)
+#define oe_thread_join pthread_join
+#define oe_thread_detach pthread_detach
+
 typedef pthread_mutex_t oe_mutex_t;
 #define OE_MUTEX_INITIALIZER __mutex_initializer_recursive()
 #define oe_mutex_lock pthread_mutex_lock
@@ -46,4 +52,11 @@ typedef pthread_rwlock_t oe_rwlock_t;
 #define oe_rwlock_wrlock pthread_rwlock_wrlock
 #define oe_rwlock_unlock pthread_rwlock_unlock
 
+/* pthread_rwlock_t is backed by the reader-biased lock */
+typedef pthread_rwlock_t oe_biased_rwlock_t;
+#define OE_BIASED_RWLOCK_INITIALIZER PTHREAD_RWLOCK_INITIALIZER
+#define oe_biased_rwlock_rdlock pthread_rwlock_rdlock
+#define oe_biased_rwlock_wrlock pthread_rwlock_wrlock
+#define oe_biased_rwlock_unlock pthread_rwlock_unlock
+
 #endif /* _OE_INCLUDE_THREAD_H */
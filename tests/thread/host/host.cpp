@@ -211,6 +211,8 @@ void test_thread_locking_patterns(oe_enclave_t* enclave)
 
 void test_readers_writer_lock(oe_enclave_t* enclave);
 
+void test_recursive_rdlock(oe_enclave_t* enclave);
+
 // test_tcs_exhaustion
 static std::atomic<size_t> g_tcs_out_thread_count(0);
 
@@ -286,6 +288,37 @@ size_t host_tcs_out_thread_count()
     return g_tcs_out_thread_count;
 }
 
+// Threads created inside the enclave use the TCSs that the ECALL leaves free
+void test_create_thread(oe_enclave_t* enclave)
+{
+    printf("test_create_thread Starting\n");
+
+    OE_TEST(enc_test_create_thread(enclave, enclave->num_bindings) == OE_OK);
+
+    printf("test_create_thread Complete\n");
+}
+
+// oe_terminate_enclave() tells a detached thread that never ends on its own
+// to stop, and waits for it
+void test_detached_thread(oe_enclave_t* enclave)
+{
+    printf("test_detached_thread Starting\n");
+
+    OE_TEST(enc_start_detached_thread(enclave) == OE_OK);
+
+    printf("test_detached_thread Complete\n");
+}
+
+// A timed wait that nobody signals returns once its deadline has passed
+void test_cond_timedwait(oe_enclave_t* enclave)
+{
+    printf("test_cond_timedwait Starting\n");
+
+    OE_TEST(enc_test_cond_timedwait(enclave, 50) == OE_OK);
+
+    printf("test_cond_timedwait Complete\n");
+}
+
 int main(int argc, const char* argv[])
 {
     oe_result_t result;
@@ -312,14 +345,23 @@ int main(int argc, const char* argv[])
 
     test_cond_broadcast(enclave);
 
+    test_cond_timedwait(enclave);
+
     test_thread_wake_wait(enclave);
 
     test_thread_locking_patterns(enclave);
 
     test_readers_writer_lock(enclave);
 
+    test_recursive_rdlock(enclave);
+
+    test_create_thread(enclave);
+
     test_tcs_exhaustion(enclave);
 
+    // Last, since the thread holds a TCS until the enclave is terminated
+    test_detached_thread(enclave);
+
     if ((result = oe_terminate_enclave(enclave)) != OE_OK)
     {
         oe_put_err("oe_terminate_enclave(): result=%u", result);
@@ -83,3 +83,14 @@ void test_readers_writer_lock(oe_enclave_t* enclave)
     // simultaneously active at least once.
     OE_TEST(max_readers == NUM_READER_THREADS);
 }
+
+// A reader that read-locks a lock again while a writer waits does not
+// deadlock
+void test_recursive_rdlock(oe_enclave_t* enclave)
+{
+    printf("test_recursive_rdlock Starting\n");
+
+    OE_TEST(enc_test_recursive_rdlock(enclave) == OE_OK);
+
+    printf("test_recursive_rdlock Complete\n");
+}